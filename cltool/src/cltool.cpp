@@ -30,6 +30,8 @@ int cltool_serialPortSendComManager(CMHANDLE cmHandle, int pHandle, buffer_t* bu
 
 bool cltool_setupLogger(InertialSense& inertialSenseInterface)
 {
+    inertialSenseInterface.Logger()->SetCompressionLevel(g_commandLineOptions.logCompressionLevel);
+
     // Enable logging in continuous background mode
     return inertialSenseInterface.SetLoggerEnabled (
         g_commandLineOptions.enableLogging, // enable logger
@@ -147,8 +149,10 @@ bool cltool_parseCommandLine(int argc, char* argv[])
     g_commandLineOptions.logPath = CL_DEFAULT_LOGS_DIRECTORY;
     g_commandLineOptions.logSubFolder = cISLogger::CreateCurrentTimestamp();
     g_commandLineOptions.maxLogFileSize = CL_DEFAULT_MAX_LOG_FILE_SIZE;
+    g_commandLineOptions.logCompressionLevel = 0;
     g_commandLineOptions.maxLogSpacePercent = CL_DEFAULT_MAX_LOG_SPACE_PERCENT;
     g_commandLineOptions.replaySpeed = CL_DEFAULT_REPLAY_SPEED;
+    g_commandLineOptions.replayStartTime = 0.0;
     g_commandLineOptions.bootloaderVerify = CL_DEFAULT_BOOTLOAD_VERIFY;
     g_commandLineOptions.timeoutFlushLoggerSeconds = 3;
     g_commandLineOptions.asciiMessages = "";
@@ -190,6 +194,10 @@ bool cltool_parseCommandLine(int argc, char* argv[])
             g_commandLineOptions.baseConnection = &a[6];
             enable_display_mode();
         }
+        else if (startsWith(a, "-rtcmFilter="))
+        {
+            g_commandLineOptions.rtcmFilter = &a[12];
+        }
         else if (startsWith(a, "-baud="))
         {
             g_commandLineOptions.baudRate = strtol(&a[6], NULL, 10);
@@ -374,6 +382,10 @@ bool cltool_parseCommandLine(int argc, char* argv[])
         {
             g_commandLineOptions.maxLogFileSize = (uint32_t)strtoul(&a[5], NULL, 10);
         }
+        else if (startsWith(a, "-lz="))
+        {
+            g_commandLineOptions.logCompressionLevel = atoi(&a[4]);
+        }
         else if (startsWith(a, "-log-flush-timeout="))
         {
             g_commandLineOptions.timeoutFlushLoggerSeconds = strtoul(&a[19], NULLPTR, 10);
@@ -469,6 +481,12 @@ bool cltool_parseCommandLine(int argc, char* argv[])
             g_commandLineOptions.replaySpeed = (float)atof(&a[4]);
             enable_display_mode();
         }
+        else if (startsWith(a, "-rt="))
+        {
+            g_commandLineOptions.replayDataLog = true;
+            g_commandLineOptions.replayStartTime = atof(&a[4]);
+            enable_display_mode();
+        }
         else if (startsWith(a, "-reset"))
         {
             g_commandLineOptions.softwareReset = true;
@@ -602,21 +620,19 @@ bool cltool_replayDataLog()
         return false;
     }
 
+    if (g_commandLineOptions.replayStartTime > 0.0 && !logger.Seek(g_commandLineOptions.replayStartTime))
+    {
+        cout << "No data at or after time " << g_commandLineOptions.replayStartTime << endl;
+    }
+
     cout << "Replaying log files: " << g_commandLineOptions.logPath << endl;
     p_data_buf_t *data;
-    // for (int d=0; d<logger.DeviceCount(); d++)
-    for (auto dl : logger.DeviceLogs())
+    // Data of all devices merged in time order
+    while (((data = logger.ReadNextDataByTime()) != NULL) && !g_inertialSenseDisplay.ExitProgram())
     {
-        if (logger.DeviceCount() > 1)
-        {
-            printf("Device SN%d: \n", dl->SerialNumber());
-        }
-        while (((data = logger.ReadData(dl)) != NULL) && !g_inertialSenseDisplay.ExitProgram())
-        {
-            p_data_t d = {data->hdr, data->buf};
-            g_inertialSenseDisplay.ProcessData(&d, g_commandLineOptions.replayDataLog, g_commandLineOptions.replaySpeed);
-            g_inertialSenseDisplay.PrintData();
-        }
+        p_data_t d = {data->hdr, data->buf};
+        g_inertialSenseDisplay.ProcessData(&d, g_commandLineOptions.replayDataLog, g_commandLineOptions.replaySpeed);
+        g_inertialSenseDisplay.PrintData();
     }
 
     cout << "Done replaying log files: " << g_commandLineOptions.logPath << endl;
@@ -855,14 +871,16 @@ void cltool_outputUsage()
 	cout << endlbOn;
 	cout << "OPTIONS (Logging to file, disabled by default)" << endl;
 	cout << "    -lon" << boldOff << "            Enable logging" << endlbOn;
-	cout << "    -lt=" << boldOff << "TYPE        Log type: dat (default), raw, sdat, kml or csv" << endlbOn;
+	cout << "    -lt=" << boldOff << "TYPE        Log type: dat (default), raw, sdat, kml, csv or col" << endlbOn;
 	cout << "    -lp " << boldOff << "PATH        Log data to path (default: ./" << CL_DEFAULT_LOGS_DIRECTORY << ")" << endlbOn;
 	cout << "    -lms=" << boldOff << "PERCENT    Log max space in percent of free space (default: " << CL_DEFAULT_MAX_LOG_SPACE_PERCENT << ")" << endlbOn;
 	cout << "    -lmf=" << boldOff << "BYTES      Log max file size in bytes (default: " << CL_DEFAULT_MAX_LOG_FILE_SIZE << ")" << endlbOn;
+	cout << "    -lz=" << boldOff << "LEVEL       Compress dat log chunks, 1 (fastest) to 10 (smallest), 0 for none (default)" << endlbOn;
 	cout << "    -lts=" << boldOff << "0          Log sub folder, 0 or blank for none, 1 for timestamp, else use as is" << endlbOn;
 	cout << "    -r" << boldOff << "              Replay data log from default path" << endlbOn;
 	cout << "    -rp " << boldOff << "PATH        Replay data log from PATH" << endlbOn;
 	cout << "    -rs=" << boldOff << "SPEED       Replay data log at x SPEED. SPEED=0 runs as fast as possible." << endlbOn;
+	cout << "    -rt=" << boldOff << "TIME        Replay data log starting at TIME (data timestamp in seconds)" << endlbOn;
 	cout << endlbOn;
 	cout << "OPTIONS (Read flash configuration from command line)" << endl;
 	cout << "    -flashCfg" << boldOff  <<  "                                   # List all \"keys\" and \"values\"" << endlbOn;
@@ -885,7 +903,11 @@ void cltool_outputUsage()
 	cout << "    -base=" << boldOff << "[IP]:[port]   As a Base (sever), send RTK corrections.  Examples:" << endl;
 	cout << "            -base=TCP::7777                            (IP is optional)" << endl;
 	cout << "            -base=TCP:192.168.1.43:7777" << endl;
-	cout << "            -base=SERIAL:" << EXAMPLE_PORT << ":921600" << endl;
+	cout << "            -base=TCP::7777:mount0,mount1              (NTRIP mountpoint per device, without mountpoints all clients get the first device)" << endl;
+	cout << "            -base=SERIAL:" << EXAMPLE_PORT << ":921600" << endlbOn;
+	cout << "    -rtcmFilter=" << boldOff << "[-][type][/period ms],...   Base RTCM3 messages forwarded, type is a message number, MSM1-7 or *.  Examples:" << endl;
+	cout << "            -rtcmFilter=MSM4,1005/10000,1230           (MSM4, station position every 10 s, unlisted types blocked)" << endl;
+	cout << "            -rtcmFilter=*,-MSM7,MSM4/1000              (all except MSM7, MSM4 at 1 Hz)" << endl;
 	cout << endlbOn;	
 	cout << "CLTool - " << boldOff << cltool_version() << endl;
 
@@ -940,17 +962,17 @@ bool cltool_updateFlashCfg(InertialSense& inertialSenseInterface, string flashCf
             } 
             else if (keyAndValue.size() == 2)
             {   // Set select flash config values
-                if (flashMap.find(keyAndValue[0]) == flashMap.end())
+                const data_info_t* info = cISDataMappings::GetFieldInfo(DID_FLASH_CONFIG, keyAndValue[0]);
+                if (info == NULLPTR)
                 {
                     cout << "Unrecognized DID_FLASH_CONFIG key '" << keyAndValue[0] << "' specified, ignoring." << endl;
                 }
                 else
                 {
-                    const data_info_t& info = flashMap.at(keyAndValue[0]);
                     int radix = (keyAndValue[1].compare(0, 2, "0x") == 0 ? 16 : 10);
                     int substrIndex = 2 * (radix == 16); // skip 0x for hex
                     const string& str = keyAndValue[1].substr(substrIndex);
-                    cISDataMappings::StringToData(str.c_str(), (int)str.length(), NULL, (uint8_t*)&flashCfg, info, radix);
+                    cISDataMappings::StringToData(str.c_str(), (int)str.length(), NULL, (uint8_t*)&flashCfg, *info, radix);
                     cout << "Setting DID_FLASH_CONFIG." << keyAndValue[0] << " = " << keyAndValue[1].c_str() << endl;
                     modified = true;
                 }
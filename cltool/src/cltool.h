@@ -85,6 +85,7 @@ typedef struct cmd_options_s // we need to name this to make MSVC happy, since w
 	survey_in_t surveyIn;
 	std::string asciiMessages;
 	double replaySpeed;
+	double replayStartTime;					// -rt=TIME
 	int displayMode;	
 	
 	uint64_t rmcPreset;
@@ -97,12 +98,14 @@ typedef struct cmd_options_s // we need to name this to make MSVC happy, since w
 	std::string logPath; 					// -lp path
 	float maxLogSpacePercent; 				// -lms=max_space_mb
 	uint32_t maxLogFileSize; 				// -lmf=max_file_size
+	int logCompressionLevel; 				// -lz=1
 	std::string logSubFolder; 				// -lts=1
 	int baudRate; 							// -baud=3000000
 	bool disableBroadcastsOnClose;	
 	
 	std::string roverConnection; 			// -rover=type:IP/URL:port:mountpoint:user:password   (server)
 	std::string baseConnection; 			// -base=IP:port    (client)	
+	std::string rtcmFilter; 				// -rtcmFilter=MSM4,1005/10000    (base RTCM3 message filter)
 	
 	std::string flashCfg;
 	uint32_t timeoutFlushLoggerSeconds;
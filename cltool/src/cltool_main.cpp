@@ -96,6 +96,7 @@ static void display_server_client_status(InertialSense* i, bool server=false, bo
             if (showMessageSummary)
             {
                 outstream << i->ServerMessageStatsSummary();
+                outstream << i->ServerClientStatsSummary();
             }
             refreshDisplay = true;
         }
@@ -677,6 +678,11 @@ static int cltool_createHost()
         cout << "Failed to create host at " << g_commandLineOptions.baseConnection << endl;
         return -1;
     }
+    else if (g_commandLineOptions.rtcmFilter.length() != 0 && !inertialSenseInterface.SetServerRtcmFilter(g_commandLineOptions.rtcmFilter))
+    {
+        cout << "Invalid RTCM3 filter " << g_commandLineOptions.rtcmFilter << endl;
+        return -1;
+    }
 
     inertialSenseInterface.StopBroadcasts();
 
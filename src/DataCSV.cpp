@@ -24,6 +24,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stddef.h>
 #include <inttypes.h>
 #include <math.h>
+#include <charconv>
 #include "DataCSV.h"
 #include "ISLogger.h"
 #include "data_sets.h"
@@ -37,6 +38,259 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 using namespace std;
 
+typedef enum
+{
+	CSV_OP_INT8,
+	CSV_OP_UINT8,
+	CSV_OP_INT16,
+	CSV_OP_UINT16,
+	CSV_OP_INT32,
+	CSV_OP_UINT32,
+	CSV_OP_INT64,
+	CSV_OP_UINT64,
+	CSV_OP_HEX8,
+	CSV_OP_HEX16,
+	CSV_OP_HEX32,
+	CSV_OP_HEX64,
+	CSV_OP_FLOAT,
+	CSV_OP_DOUBLE,
+	CSV_OP_STRING,
+	CSV_OP_MAPPING,		// formatted by cISDataMappings::DataToString
+	CSV_OP_DEFAULT,		// field is past the end of the struct
+} eCsvFieldOp;
+
+// max formatted length of each field op, "%.9g" and "%.17g" with sign and 3 digit exponent
+static const uint32_t s_csvOpMaxLength[] = { 4, 3, 6, 5, 11, 10, 20, 20, 10, 10, 10, 18, 16, 25 };
+
+static inline char* csvWriteHex(char* ptr, uint64_t value, int minDigits)
+{
+	const unsigned char* hexTable = getHexLookupTable();
+	char digits[16];
+	int count = 0;
+	do
+	{
+		digits[count++] = hexTable[value & 0x0F];
+		value >>= 4;
+	} while (value);
+	*ptr++ = '0';
+	*ptr++ = 'x';
+	for (int i = count; i < minDigits; i++)
+	{
+		*ptr++ = '0';
+	}
+	while (count)
+	{
+		*ptr++ = digits[--count];
+	}
+	return ptr;
+}
+
+template <typename T> static inline char* csvWriteInt(char* ptr, const uint8_t* data)
+{
+	T value;
+	memcpy(&value, data, sizeof(T));
+	return std::to_chars(ptr, ptr + 24, value).ptr;
+}
+
+bool cDataCSVRowFormatter::Init(uint32_t id)
+{
+	uint32_t count;
+	const data_info_t* fields = cISDataMappings::GetFields(id, count);
+	m_fields.clear();
+	m_id = id;
+	m_size = 0;
+	m_maxLength = 0;
+	if (id >= DID_COUNT)
+	{
+		return false;
+	}
+	m_size = cISDataMappings::GetSize(id);
+
+	// order id, comma and newline
+	uint32_t maxLength = 22;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const data_info_t& info = fields[i];
+		csv_field_op_t field = { info.dataOffset, info.dataSize, CSV_OP_DEFAULT, &info };
+		bool hex = (info.dataFlags == DataFlagsDisplayHex);
+		if (info.dataOffset + info.dataSize > m_size)
+		{	// default value: 0 or empty quotes
+			maxLength += 2;
+		}
+		else
+		{
+			switch (info.dataType)
+			{
+			case DataTypeInt8:      field.op = (uint8_t)(hex ? CSV_OP_HEX32 : CSV_OP_INT8); break;
+			case DataTypeUInt8:     field.op = (uint8_t)(hex ? CSV_OP_HEX8 : CSV_OP_UINT8); break;
+			case DataTypeInt16:     field.op = (uint8_t)(hex ? CSV_OP_HEX32 : CSV_OP_INT16); break;
+			case DataTypeUInt16:    field.op = (uint8_t)(hex ? CSV_OP_HEX16 : CSV_OP_UINT16); break;
+			case DataTypeInt32:     field.op = (uint8_t)(hex ? CSV_OP_HEX32 : CSV_OP_INT32); break;
+			case DataTypeUInt32:    field.op = (uint8_t)(hex ? CSV_OP_HEX32 : CSV_OP_UINT32); break;
+			case DataTypeInt64:     field.op = (uint8_t)(hex ? CSV_OP_HEX64 : CSV_OP_INT64); break;
+			case DataTypeUInt64:    field.op = (uint8_t)(hex ? CSV_OP_HEX64 : CSV_OP_UINT64); break;
+			case DataTypeFloat:     field.op = CSV_OP_FLOAT; break;
+			case DataTypeDouble:    field.op = CSV_OP_DOUBLE; break;
+			case DataTypeString:    field.op = CSV_OP_STRING; break;
+			default:                field.op = CSV_OP_MAPPING; break;
+			}
+
+			if (field.op < _ARRAY_ELEMENT_COUNT(s_csvOpMaxLength))
+			{
+				maxLength += s_csvOpMaxLength[field.op];
+			}
+			else
+			{	// quoted string or hex binary
+				maxLength += _MIN(IS_DATA_MAPPING_MAX_STRING_LENGTH, 2 * info.dataSize + 2);
+			}
+		}
+		maxLength++;	// comma
+		m_fields.push_back(field);
+	}
+
+	m_maxLength = maxLength;
+	m_row.resize(maxLength + 1);
+	m_tmp.resize(m_size);
+	return true;
+}
+
+const char* cDataCSVRowFormatter::Format(const p_data_hdr_t& hdr, const uint8_t* buf, int& length, const uint64_t* orderId)
+{
+	length = 0;
+	if (m_row.empty() || hdr.id != m_id)
+	{
+		return NULLPTR;
+	}
+
+	if (m_size > hdr.size)
+	{	// copy into temp buffer, zeroing out bytes that are not part of this packet
+		uint32_t dataStart = _MIN(hdr.offset, m_size);
+		uint32_t dataEnd = _MIN(hdr.offset + hdr.size, m_size);
+		memset(m_tmp.data(), 0, m_size);
+		memcpy(m_tmp.data() + dataStart, buf, dataEnd - dataStart);
+		buf = m_tmp.data();
+	}
+
+	// entire struct, even if we got a partial hdr and buf
+	p_data_hdr_t hdrCopy = hdr;
+	hdrCopy.offset = 0;
+	hdrCopy.size = m_size;
+
+	char* row = m_row.data();
+	char* ptr = row;
+	if (orderId)
+	{
+		ptr = std::to_chars(ptr, ptr + 20, *orderId).ptr;
+		*ptr++ = ',';
+	}
+
+	for (const csv_field_op_t& field : m_fields)
+	{
+		const uint8_t* data = buf + field.dataOffset;
+		switch (field.op)
+		{
+		case CSV_OP_INT8:   ptr = csvWriteInt<int8_t>(ptr, data); break;
+		case CSV_OP_UINT8:  ptr = csvWriteInt<uint8_t>(ptr, data); break;
+		case CSV_OP_INT16:  ptr = csvWriteInt<int16_t>(ptr, data); break;
+		case CSV_OP_UINT16: ptr = csvWriteInt<uint16_t>(ptr, data); break;
+		case CSV_OP_INT32:  ptr = csvWriteInt<int32_t>(ptr, data); break;
+		case CSV_OP_UINT32: ptr = csvWriteInt<uint32_t>(ptr, data); break;
+		case CSV_OP_INT64:  ptr = csvWriteInt<int64_t>(ptr, data); break;
+		case CSV_OP_UINT64: ptr = csvWriteInt<uint64_t>(ptr, data); break;
+
+		case CSV_OP_HEX8:   ptr = csvWriteHex(ptr, *data, 2); break;
+		case CSV_OP_HEX16:  { uint16_t v; memcpy(&v, data, sizeof(v)); ptr = csvWriteHex(ptr, v, 4); } break;
+		case CSV_OP_HEX64:  { uint64_t v; memcpy(&v, data, sizeof(v)); ptr = csvWriteHex(ptr, v, 16); } break;
+		case CSV_OP_HEX32:
+		{	// signed types are sign extended to 32 bits, matching printf("%X")
+			uint32_t v;
+			switch (field.dataSize)
+			{
+			case 1:     v = (uint32_t)(int32_t)*(const int8_t*)data; break;
+			case 2:     { int16_t v16; memcpy(&v16, data, sizeof(v16)); v = (uint32_t)(int32_t)v16; } break;
+			default:    memcpy(&v, data, sizeof(v)); break;
+			}
+			ptr = csvWriteHex(ptr, v, 2 * _MIN(field.dataSize, 4));
+		} break;
+
+		case CSV_OP_FLOAT:
+		{
+			float v;
+			memcpy(&v, data, sizeof(v));
+			ptr = std::to_chars(ptr, ptr + 32, (double)v, std::chars_format::general, 9).ptr;
+		} break;
+
+		case CSV_OP_DOUBLE:
+		{
+			double v;
+			memcpy(&v, data, sizeof(v));
+			ptr = std::to_chars(ptr, ptr + 32, v, std::chars_format::general, 17).ptr;
+		} break;
+
+		case CSV_OP_STRING:
+		{
+			*ptr++ = '"';
+			const char* str = (const char*)data;
+			const char* strEnd = str + (int)_MIN(IS_DATA_MAPPING_MAX_STRING_LENGTH, field.dataSize) - 3;
+			for (; str < strEnd && *str != '\0'; str++)
+			{
+				*ptr++ = *str;
+			}
+			*ptr++ = '"';
+		} break;
+
+		case CSV_OP_MAPPING:
+		{
+			data_mapping_string_t tmp;
+			cISDataMappings::DataToString(*field.info, &hdrCopy, buf, tmp);
+			size_t len = strnlen(tmp, sizeof(tmp));
+			memcpy(ptr, tmp, len);
+			ptr += len;
+		} break;
+
+		default:
+			if (field.info->dataType == DataTypeString)
+			{
+				*ptr++ = '"';
+				*ptr++ = '"';
+			}
+			else if (field.info->dataType != DataTypeBinary)
+			{
+				*ptr++ = '0';
+			}
+			break;
+		}
+		*ptr++ = ',';
+	}
+
+	if (m_fields.size())
+	{	// replace last comma
+		ptr--;
+	}
+	*ptr++ = '\n';
+	*ptr = '\0';
+	length = (int)(ptr - row);
+	return row;
+}
+
+cDataCSVRowFormatter* cDataCSV::RowFormatter(uint32_t id)
+{
+	if (id >= DID_COUNT)
+	{
+		return NULLPTR;
+	}
+	if (m_formatters.empty())
+	{
+		m_formatters.resize(DID_COUNT);
+	}
+	cDataCSVRowFormatter& formatter = m_formatters[id];
+	if ((formatter.Id() != id || formatter.MaxLength() == 0) && !formatter.Init(id))
+	{
+		return NULLPTR;
+	}
+	return &formatter;
+}
+
 
 int cDataCSV::WriteHeaderToFile(FILE* pFile, uint32_t id)
 {
@@ -80,7 +334,6 @@ int cDataCSV::ReadHeaderFromFile(FILE* pFile, uint32_t id, vector<data_info_t>&
 	{
 		return 0;
 	}
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(id);
 	stringstream stream(line);
 	string columnHeader;
 	columnHeaders.clear();
@@ -101,14 +354,14 @@ int cDataCSV::ReadHeaderFromFile(FILE* pFile, uint32_t id, vector<data_info_t>&
 		}
 		else
 		{
-			map_name_to_info_t::const_iterator offset = offsetMap->find(columnHeader);
-			if (offset == offsetMap->end())
+			const data_info_t* info = cISDataMappings::GetFieldInfo(id, columnHeader);
+			if (info == NULLPTR)
 			{
 				columnHeaders.push_back({ 0xFFFFFFFF, 0xFFFFFFFF, DataTypeBinary, (eDataFlags)0, columnHeader });
 			}
 			else
 			{
-				columnHeaders.push_back(offset->second);
+				columnHeaders.push_back(*info);
 			}
 		}
 	}
@@ -127,19 +380,17 @@ int cDataCSV::WriteDataToFile(uint64_t orderId, FILE* pFile, const p_data_hdr_t&
 	{
 		return 0;
 	}
-	string s;
-    if (!DataToStringCSV(dataHdr, dataBuf, s))
+	cDataCSVRowFormatter* formatter = RowFormatter(dataHdr.id);
+	int length;
+	const char* row;
+	if (formatter == NULLPTR || (row = formatter->Format(dataHdr, dataBuf, length, &orderId)) == NULLPTR)
 	{
 		return 0;
 	}
-	char tmp[64];
-	SNPRINTF(tmp, 64, "%llu", (long long unsigned int)orderId);
-	fputs(tmp, pFile);
-	fputc(',', pFile);
-	fputs(s.c_str(), pFile);
+	fwrite(row, 1, length, pFile);
 
-	// return the data string length plus comma plus order id string
-    return (int)s.length() + 1 + (int)strnlen(tmp, sizeof(tmp));
+	// order id string plus comma plus data string length
+	return length;
 }
 
 bool cDataCSV::StringCSVToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uint32_t bufSize, const vector<data_info_t>& columnHeaders)
@@ -190,40 +441,13 @@ bool cDataCSV::StringCSVToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uint3
 bool cDataCSV::DataToStringCSV(const p_data_hdr_t& hdr, const uint8_t* buf, string& csv)
 {
 	csv.clear();
-	string columnData;
-	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(hdr.id);
-	if (offsetMap == NULLPTR)
+	cDataCSVRowFormatter* formatter = RowFormatter(hdr.id);
+	int length;
+	const char* row;
+	if (formatter == NULLPTR || (row = formatter->Format(hdr, buf, length)) == NULLPTR)
 	{
 		return false;
 	}
-	char tmp[IS_DATA_MAPPING_MAX_STRING_LENGTH];
-	const uint8_t* bufPtr = buf;
-	uint8_t tmpBuffer[MAX_DATASET_SIZE];
-	uint32_t size = cISDataMappings::GetSize(hdr.id);
-	if (size > hdr.size)
-	{
-		// copy into temp buffer, zeroing out bytes that are not part of this packet
-		memset(tmpBuffer, 0, hdr.offset);
-		memcpy(tmpBuffer + hdr.offset, buf, hdr.size);
-		uint32_t dataEnd = hdr.offset + hdr.size;
-		memset(tmpBuffer + dataEnd, 0, size - dataEnd);
-		bufPtr = tmpBuffer;
-	}
-
-	// copy header as we are now storing an entire struct, even if we got a partial hdr and buf
-	p_data_hdr_t hdrCopy = hdr;
-	hdrCopy.offset = 0;
-	hdrCopy.size = size;
-
-	for (map_name_to_info_t::const_iterator offset = offsetMap->begin(); offset != offsetMap->end(); offset++)
-	{
-		cISDataMappings::DataToString(offset->second, &hdrCopy, bufPtr, tmp);
-		if (csv.length() != 0)
-		{
-			csv += ",";
-		}
-		csv += tmp;
-	}
-	csv += "\n";
+	csv.assign(row, length);
 	return true;
 }
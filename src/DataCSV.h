@@ -16,6 +16,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <string>
 #include <map>
 #include <regex>
+#include <vector>
 
 #include "com_manager.h"
 
@@ -57,6 +58,54 @@ typedef struct
 	std::string name;
 } data_info_t;
 
+/**
+* CSV row formatter for a single data set.  The data set mappings are compiled once into a flat list
+* of field ops and rows are written directly into a buffer sized for the longest possible row, so
+* formatting a row does not allocate.  Output is identical to cISDataMappings::DataToString per field.
+*/
+class cDataCSVRowFormatter
+{
+public:
+	/**
+	* Compile the formatter for a data set
+	* @param id the data set id
+	* @return true if success, false if no map found
+	*/
+	bool Init(uint32_t id);
+
+	/**
+	* Format a row of csv data, ending in a newline
+	* @param hdr the packet header, partial packets are formatted as a full struct with missing bytes zeroed
+	* @param buf the packet data
+	* @param length set to the row length, not including the null terminator
+	* @param orderId if not NULL, the row is prefixed with the order id and a comma
+	* @return the null terminated row, valid until the next call, or NULL if not initialized
+	*/
+	const char* Format(const p_data_hdr_t& hdr, const uint8_t* buf, int& length, const uint64_t* orderId = NULLPTR);
+
+	uint32_t Id() const { return m_id; }
+	uint32_t FieldCount() const { return (uint32_t)m_fields.size(); }
+
+	/** Max row length in bytes, not including the null terminator */
+	uint32_t MaxLength() const { return m_maxLength; }
+
+private:
+	typedef struct
+	{
+		uint32_t dataOffset;
+		uint32_t dataSize;
+		uint8_t op;
+		const data_info_t* info;
+	} csv_field_op_t;
+
+	uint32_t m_id = 0;
+	uint32_t m_size = 0;
+	uint32_t m_maxLength = 0;
+	std::vector<csv_field_op_t> m_fields;
+	std::vector<char> m_row;
+	std::vector<uint8_t> m_tmp;
+};
+
 class cDataCSV
 {
 public:
@@ -81,6 +130,15 @@ public:
 	* return true if success, false if no map found
 	*/
     bool DataToStringCSV(const p_data_hdr_t& hdr, const uint8_t* buf, std::string& csv);
+
+	/**
+	* Get the compiled row formatter for a data set, built on first use
+	* return the formatter or NULL if no map found
+	*/
+	cDataCSVRowFormatter* RowFormatter(uint32_t id);
+
+private:
+	std::vector<cDataCSVRowFormatter> m_formatters;
 };
 
 #endif // DATA_CVS_H
@@ -18,6 +18,26 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "ISLogFileBase.h"
 #include "ISLogFileFactory.h"
 
+#if DATA_CHUNK_COMPRESSION
+#include <memory>
+#include <vector>
+#include "ISUtilities.h"
+#include "miniz.h"
+
+// Compressed data buffer, per thread as chunks are written by the logger and I/O threads
+static uint8_t* compressBuffer()
+{
+	static thread_local std::vector<uint8_t> s_buf(DEFAULT_CHUNK_DATA_SIZE);
+	return s_buf.data();
+}
+
+static tdefl_compressor* compressor()
+{
+	static thread_local std::unique_ptr<tdefl_compressor, void(*)(tdefl_compressor*)> s_comp(tdefl_compressor_alloc(), tdefl_compressor_free);
+	return s_comp.get();
+}
+#endif
+
 cDataChunk::cDataChunk()
 {
 	Clear();
@@ -26,7 +46,7 @@ cDataChunk::cDataChunk()
 	m_hdr.classification = ' ' << 8 | 'U';
 	m_hdr.grpNum = 0;				//!< Chunk group number
 	m_hdr.devSerialNum = 0;			//!< Serial number
-	m_hdr.reserved = 0;				//!< Reserved 
+	m_hdr.flags = 0;				//!< Chunk flags
     m_buffTail = m_buffHead + DEFAULT_CHUNK_DATA_SIZE;
 	m_dataHead = m_buffHead;
 	m_dataTail = m_buffHead;
@@ -111,6 +131,7 @@ void cDataChunk::Clear()
 {
 	m_hdr.dataSize = 0; //!< Byte size of data in this chunk
 	m_hdr.invDataSize = (uint32_t)~0; //!< Bitwise inverse of m_Size
+	m_hdr.flags &= ~DATA_CHUNK_FLAG_COMPRESSED;
     m_dataHead = m_buffHead;
     m_dataTail = m_buffHead;
 
@@ -168,7 +189,7 @@ int32_t cDataChunk::WriteToFile(cISLogFileBase* pFile, int groupNumber, bool wri
 
 
 // Returns number of bytes read, or -1 for error
-int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile, bool readHeader)
+int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile, bool readHeader, chunk_compression_stats_t* stats)
 {
 	if (pFile == NULLPTR)
 	{
@@ -205,6 +226,21 @@ int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile, bool readHeader)
 		m_hdr.dataSize = GetBuffFree();
 	}
 
+	if (readHeader && m_hdr.marker == DATA_CHUNK_MARKER && (m_hdr.flags & DATA_CHUNK_FLAG_COMPRESSED))
+	{	// Read compressed data into a separate buffer and decompress into the chunk
+#if DATA_CHUNK_COMPRESSION
+		uint32_t size = m_hdr.dataSize;
+		uint8_t* buf = compressBuffer();
+		int32_t n = (size <= DEFAULT_CHUNK_DATA_SIZE ? static_cast<int32_t>(pFile->read(buf, size)) : 0);
+		if (n == static_cast<int32_t>(size) && Decompress(buf, size, stats))
+		{
+			return nBytes + n;
+		}
+#endif
+		Clear();
+		return -1;
+	}
+
 	// Read chunk data
 	m_dataTail += static_cast<int32_t>(pFile->read(m_buffHead, m_hdr.dataSize));
 	nBytes += GetDataSize();
@@ -277,6 +313,85 @@ int32_t cDataChunk::ReadFromFile(cISLogFileBase* pFile, bool readHeader)
 }
 
 
+bool cDataChunk::Compress(int level, chunk_compression_stats_t* stats)
+{
+	int32_t rawSize = GetDataSize();
+	if (rawSize <= 0 || (m_hdr.flags & DATA_CHUNK_FLAG_COMPRESSED))
+	{
+		return false;
+	}
+
+#if DATA_CHUNK_COMPRESSION
+	uint64_t startUs = current_timeUs();
+
+	// zlib header and checksum so corrupt data is detected when decompressing
+	tdefl_compressor* comp = compressor();
+	tdefl_init(comp, NULLPTR, NULLPTR, (int)tdefl_create_comp_flags_from_zip_params(level, MZ_DEFAULT_WINDOW_BITS, MZ_DEFAULT_STRATEGY));
+	uint8_t* buf = compressBuffer();
+	size_t inSize = rawSize;
+	size_t outSize = rawSize;
+	bool compressed = (tdefl_compress(comp, m_dataHead, &inSize, buf, &outSize, TDEFL_FINISH) == TDEFL_STATUS_DONE && outSize < (size_t)rawSize);
+
+	// Keep the data uncompressed if it did not get smaller
+	if (compressed)
+	{
+		memcpy(m_buffHead, buf, outSize);
+		m_dataHead = m_buffHead;
+		m_dataTail = m_buffHead + outSize;
+		m_hdr.dataSize = (uint32_t)outSize;
+		m_hdr.invDataSize = ~m_hdr.dataSize;
+		m_hdr.flags |= DATA_CHUNK_FLAG_COMPRESSED;
+	}
+
+	if (stats)
+	{
+		stats->chunkCount++;
+		stats->rawBytes += rawSize;
+		stats->compressedBytes += GetDataSize();
+		stats->timeUs += current_timeUs() - startUs;
+	}
+	return compressed;
+#else
+	(void)level;
+	(void)stats;
+	return false;
+#endif
+}
+
+
+bool cDataChunk::Decompress(const uint8_t* data, uint32_t size, chunk_compression_stats_t* stats)
+{
+	Clear();
+
+#if DATA_CHUNK_COMPRESSION
+	uint64_t startUs = current_timeUs();
+
+	size_t rawSize = tinfl_decompress_mem_to_mem(m_buffHead, DEFAULT_CHUNK_DATA_SIZE, data, size, TINFL_FLAG_PARSE_ZLIB_HEADER);
+	if (rawSize == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED)
+	{
+		return false;
+	}
+	m_dataTail = m_buffHead + rawSize;
+	m_hdr.dataSize = (uint32_t)rawSize;
+	m_hdr.invDataSize = ~m_hdr.dataSize;
+
+	if (stats)
+	{
+		stats->chunkCount++;
+		stats->rawBytes += rawSize;
+		stats->compressedBytes += size;
+		stats->timeUs += current_timeUs() - startUs;
+	}
+	return true;
+#else
+	(void)data;
+	(void)size;
+	(void)stats;
+	return false;
+#endif
+}
+
+
 int32_t cDataChunk::WriteAdditionalChunkHeader(cISLogFileBase* /*pFile*/)
 {
 	return 0;
@@ -22,6 +22,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #define DATA_CHUNK_MARKER           0xFC05EA32
 
+// sChunkHeader flags
+#define DATA_CHUNK_FLAG_COMPRESSED  0x00000001      // Chunk data is zlib compressed, dataSize is the compressed size
+
+// Chunk compression using miniz, not available on embedded targets
+#ifndef DATA_CHUNK_COMPRESSION
+#define DATA_CHUNK_COMPRESSION      (!PLATFORM_IS_EMBEDDED)
+#endif
+
 #include <stdint.h>
 
 #include "com_manager.h"
@@ -44,7 +52,7 @@ struct sChunkHeader
 	uint32_t	grpNum;				//!< Chunk Group Number: 0 = serial data, 1 = sorted data...
 	uint32_t	devSerialNum;		//!< Device serial number
 	uint32_t	pHandle;			//!< Device port handle
-	uint32_t	reserved;			//!< Unused
+	uint32_t	flags;				//!< DATA_CHUNK_FLAG_..., zero in logs written before flags were added
 
 #if LOG_CHUNK_STATS
 	void print()
@@ -60,13 +68,21 @@ struct sChunkHeader
 		logStats( "         grpNum:  %d\n", grpNum );
 		logStats( "   devSerialNum:  %d\n", devSerialNum );
 		logStats( "        pHandle:  %d\n", pHandle );
-		logStats( "       reserved:  %d\n", reserved );
+		logStats( "          flags:  0x%x\n", flags );
 	}
 #endif
 };
 
 POP_PACK
 
+typedef struct
+{
+	uint64_t	chunkCount;			//!< Number of chunks compressed or decompressed
+	uint64_t	rawBytes;			//!< Uncompressed data bytes
+	uint64_t	compressedBytes;	//!< Data bytes in file, including chunks stored uncompressed because they did not get smaller
+	uint64_t	timeUs;				//!< Time spent compressing or decompressing
+} chunk_compression_stats_t;
+
 class cDataChunk
 {
 public:
@@ -80,7 +96,9 @@ public:
 	uint8_t* GetDataPtr();
 	bool PopFront(int32_t size);
     int32_t WriteToFile(cISLogFileBase* pFile, int groupNumber = 0, bool writeHeader = true); // Returns number of bytes written to file and clears the chunk
-	int32_t ReadFromFile(cISLogFileBase* pFile, bool readHeader = true);
+	int32_t ReadFromFile(cISLogFileBase* pFile, bool readHeader = true, chunk_compression_stats_t* stats = NULLPTR); // Compressed data is decompressed
+	bool Compress(int level, chunk_compression_stats_t* stats = NULLPTR);   // Compress data in place before WriteToFile(), returns false if left uncompressed
+	bool Decompress(const uint8_t* data, uint32_t size, chunk_compression_stats_t* stats = NULLPTR);    // Replace chunk data with decompressed data
 	int32_t PushBack(uint8_t* d1, int32_t d1Size, uint8_t* d2 = NULL, int32_t d2Size = 0);
 
 	virtual void Clear();
@@ -80,7 +80,7 @@ bool cDataJSON::StringJSONToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uin
     hdr.size = cISDataMappings::GetSize(hdr.id);
 	char c;
 	char pc = 0;
-	map_name_to_info_t::const_iterator offset;
+	const data_info_t* info;
 	string fieldName;
 	size_t fieldStart = 0;
 	bool inName = true;
@@ -116,9 +116,9 @@ bool cDataJSON::StringJSONToData(string& s, p_data_hdr_t& hdr, uint8_t* buf, uin
 		{
             if (fieldStart != 0)
 			{
-				offset = offsetMap->find(fieldName);
+				info = cISDataMappings::GetFieldInfo(hdr.id, fieldName);
                 string json = s.substr(fieldStart, i - fieldStart);
-                if (offset != offsetMap->end() && !cISDataMappings::StringToData(json.c_str(), (int)json.size(), &hdr, buf, offset->second, 10, true))
+                if (info != NULLPTR && !cISDataMappings::StringToData(json.c_str(), (int)json.size(), &hdr, buf, *info, 10, true))
 				{
 					return false;
 				}
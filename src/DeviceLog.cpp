@@ -192,6 +192,7 @@ bool cDeviceLog::OpenNewSaveFile()
 
 	string fileName = GetNewFileName(serNum, m_fileCount, NULL);
 	m_pFile = CreateISLogFile(fileName, "wb");
+	m_fileName = fileName;
 	m_fileSize = 0;
 
 	if (m_pFile && m_pFile->isOpened())
@@ -63,6 +63,19 @@ public:
 
     virtual void Flush() {}
 
+    /**
+    * Position reading at the first data with a timestamp (cISDataMappings::GetTimestamp) at or after a time
+    * @return false if not supported or there is no data at or after the time
+    */
+    virtual bool Seek(double timestamp) { return false; }
+
+    /**
+    * Limit the DIDs returned by ReadData().  Log types that can skip data they do not need to read use this,
+    * cISLogger applies the filter for all log types.
+    * @param didFilter non-zero for each DID to read, indexed by DID, empty to read all
+    */
+    virtual void SetReadFilter(const std::vector<uint8_t>& didFilter) { m_readFilter = didFilter; }
+
     bool SetupReadInfo(const std::string &directory, const std::string &deviceName, const std::string &timeStamp);
 
     ISDevice* Device();
@@ -122,6 +135,7 @@ protected:
     bool m_showPoints;
     bool m_showPointTimestamps = true;
     double m_pointUpdatePeriodSec = 1.0f;
+    std::vector<uint8_t> m_readFilter;
 
 private:
     cLogStats m_logStats;
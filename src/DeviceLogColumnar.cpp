@@ -0,0 +1,413 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <climits>
+
+#include "ISDevice.h"
+#include "DeviceLogColumnar.h"
+#include "ISFileManager.h"
+#include "ISDataMappings.h"
+
+using namespace std;
+
+static inline uint64_t alignColumn(uint64_t offset)
+{
+	return (offset + COL_FILE_ALIGN - 1) & ~((uint64_t)COL_FILE_ALIGN - 1);
+}
+
+
+void cDeviceLogColumnar::InitDeviceForWriting(std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize)
+{
+	m_logs.clear();
+	m_nextId = 0;
+	cDeviceLog::InitDeviceForWriting(timestamp, directory, maxDiskSpace, maxFileSize);
+}
+
+
+void cDeviceLogColumnar::InitDeviceForReading()
+{
+	cDeviceLog::InitDeviceForReading();
+
+	// Create a list of files for each possible data set
+	m_logs.clear();
+	m_currentFiles.clear();
+	m_currentFileIndex.clear();
+	for (uint32_t id = DID_NULL + 1; id < DID_COUNT; id++)
+	{
+		const char* dataSet = cISDataMappings::GetDataSetName(id);
+		if (dataSet == NULL)
+		{
+			continue;
+		}
+
+		string dataSetRegex;
+		if (m_devSerialNo > 0 && m_devSerialNo < 4294967295)	// < 0xFFFFFFFF
+		{	// Include serial number if valid
+			dataSetRegex.append("LOG_SN").append(to_string(m_devSerialNo)).append(".*?");
+		}
+		dataSetRegex.append("_").append(dataSet).append("\\.col$");
+		vector<ISFileManager::file_info_t> infos;
+		ISFileManager::GetDirectorySpaceUsed(m_directory, dataSetRegex, infos, false, false);
+		if (infos.size() == 0)
+		{
+			continue;
+		}
+
+		vector<string>& files = m_currentFiles[id];
+		for (size_t i = 0; i < infos.size(); i++)
+		{
+			files.push_back(infos[i].name);
+		}
+		sort(files.begin(), files.end());
+		m_currentFileIndex[id] = 0;
+
+		cColumnarLog& log = m_logs[id];
+		log.dataId = id;
+		if (!OpenNextFile(log))
+		{
+			m_logs.erase(id);
+		}
+	}
+}
+
+
+bool cDeviceLogColumnar::CloseAllFiles()
+{
+	cDeviceLog::CloseAllFiles();
+
+	bool success = true;
+	for (map<uint32_t, cColumnarLog>::iterator i = m_logs.begin(); i != m_logs.end(); i++)
+	{
+		success &= WriteFile(i->second);
+	}
+	m_logs.clear();
+	return success;
+}
+
+
+bool cDeviceLogColumnar::InitLogForWriting(cColumnarLog& log, uint32_t dataId)
+{
+	const map_name_to_info_t* offsetMap = cISDataMappings::GetMapInfo(dataId);
+	uint32_t dataSize = cISDataMappings::GetSize(dataId);
+	if (offsetMap == NULLPTR || dataSize == 0 || dataSize > MAX_DATASET_SIZE)
+	{
+		return false;
+	}
+
+	log.dataId = dataId;
+	log.dataSize = dataSize;
+	log.fields.clear();
+	for (map_name_to_info_t::const_iterator i = offsetMap->begin(); i != offsetMap->end(); i++)
+	{
+		const data_info_t& info = i->second;
+		if (info.dataSize > 0 && info.dataOffset + info.dataSize <= dataSize && info.name.length() < COL_FIELD_NAME_SIZE)
+		{
+			log.fields.push_back(info);
+		}
+	}
+
+	// Columns in structure order, order id first
+	stable_sort(log.fields.begin(), log.fields.end(), [](const data_info_t& a, const data_info_t& b) { return a.dataOffset < b.dataOffset; });
+	log.fields.insert(log.fields.begin(), { COL_FIELD_ID_OFFSET, (uint32_t)sizeof(uint64_t), DataTypeUInt64, DataFlagsNull, "_ID_" });
+
+	log.columns.resize(log.fields.size());
+	log.image.assign(dataSize, 0);
+	log.rowCount = 0;
+	log.rowSize = 0;
+	for (size_t i = 0; i < log.fields.size(); i++)
+	{
+		log.rowSize += log.fields[i].dataSize;
+	}
+	return true;
+}
+
+
+bool cDeviceLogColumnar::WriteFile(cColumnarLog& log)
+{
+	if (log.rowCount == 0)
+	{
+		return true;
+	}
+
+	const char* dataSetName = cISDataMappings::GetDataSetName(log.dataId);
+	uint32_t serNum = (device != nullptr ? device->devInfo.serialNumber : SerialNumber());
+	if (dataSetName == NULL || !serNum || m_directory.empty())
+	{
+		return false;
+	}
+
+	// Build header and schema
+	col_file_header_t hdr = {};
+	hdr.marker = COL_FILE_MARKER;
+	hdr.version = COL_FILE_VERSION;
+	hdr.headerSize = sizeof(col_file_header_t);
+	hdr.dataId = log.dataId;
+	hdr.dataSize = log.dataSize;
+	hdr.rowCount = log.rowCount;
+	hdr.fieldCount = (uint32_t)log.fields.size();
+	hdr.fieldSize = sizeof(col_field_t);
+
+	vector<col_field_t> schema(log.fields.size());
+	uint64_t offset = alignColumn(sizeof(col_file_header_t) + schema.size() * sizeof(col_field_t));
+	for (size_t i = 0; i < schema.size(); i++)
+	{
+		const data_info_t& info = log.fields[i];
+		col_field_t& field = schema[i];
+		memset(&field, 0, sizeof(field));
+		strncpy(field.name, info.name.c_str(), COL_FIELD_NAME_SIZE - 1);
+		field.dataOffset = info.dataOffset;
+		field.dataSize = info.dataSize;
+		field.dataType = info.dataType;
+		field.dataFlags = info.dataFlags;
+		field.fileOffset = offset;
+		offset = alignColumn(offset + log.rowCount * info.dataSize);
+	}
+
+	// Write file
+	_MKDIR(m_directory.c_str());
+	log.fileCount++;
+	string fileName = GetNewFileName(serNum, log.fileCount, dataSetName);
+	FILE* pFile = fopen(fileName.c_str(), "wb");
+	if (pFile == NULL)
+	{
+#if LOG_DEBUG_FILE_WRITE
+		printf("cDeviceLogColumnar::WriteFile FAILED to open save file: %s\n", fileName.c_str());
+#endif
+		return false;
+	}
+
+	static const uint8_t padding[COL_FILE_ALIGN] = {};
+	uint64_t pos = fwrite(&hdr, 1, sizeof(hdr), pFile);
+	pos += fwrite(schema.data(), 1, schema.size() * sizeof(col_field_t), pFile);
+	for (size_t i = 0; i < schema.size(); i++)
+	{
+		pos += fwrite(padding, 1, (size_t)(schema[i].fileOffset - pos), pFile);
+		pos += fwrite(log.columns[i].data(), 1, log.columns[i].size(), pFile);
+		log.columns[i].clear();
+	}
+	pos += fwrite(padding, 1, (size_t)(offset - pos), pFile);
+	bool success = (ferror(pFile) == 0 && pos == offset);
+	fclose(pFile);
+
+#if LOG_DEBUG_FILE_WRITE
+	printf("cDeviceLogColumnar::WriteFile %s %d rows\n", fileName.c_str(), (int)log.rowCount);
+#endif
+
+	m_logSize += pos;
+	log.rowCount = 0;
+	return success;
+}
+
+
+bool cDeviceLogColumnar::SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf, protocol_type_t ptype)
+{
+    cDeviceLog::SaveData(dataHdr, dataBuf, ptype);
+
+	// Reference current log
+	cColumnarLog& log = m_logs[dataHdr->id];
+	if (log.fields.empty() && !InitLogForWriting(log, dataHdr->id))
+	{
+		m_logs.erase(dataHdr->id);
+		return false;
+	}
+
+	if (dataHdr->id == DID_DEV_INFO && device)
+	{
+		memcpy((void *)&(device->devInfo), dataBuf, sizeof(dev_info_t));
+	}
+
+	// Merge data into the last value of the data set, so partial packets still produce a full row
+	if (dataHdr->offset < log.dataSize)
+	{
+		memcpy(log.image.data() + dataHdr->offset, dataBuf, _MIN(dataHdr->size, log.dataSize - dataHdr->offset));
+	}
+
+	// Append row
+	uint64_t orderId = m_nextId++;
+	const uint8_t* id = (const uint8_t*)&orderId;
+	log.columns[0].insert(log.columns[0].end(), id, id + sizeof(orderId));
+	for (size_t i = 1; i < log.fields.size(); i++)
+	{
+		const uint8_t* value = log.image.data() + log.fields[i].dataOffset;
+		log.columns[i].insert(log.columns[i].end(), value, value + log.fields[i].dataSize);
+	}
+	log.rowCount++;
+
+	// Columns are buffered until the file is full as the file size sets the column offsets
+	if (log.rowCount * log.rowSize >= m_maxFileSize)
+	{
+		return WriteFile(log);
+	}
+
+	return true;
+}
+
+
+const col_file_header_t* cDeviceLogColumnar::ValidateFile(const uint8_t* data, size_t size)
+{
+	if (data == NULL || size < sizeof(col_file_header_t))
+	{
+		return NULL;
+	}
+
+	const col_file_header_t* hdr = (const col_file_header_t*)data;
+	if (hdr->marker != COL_FILE_MARKER ||
+		hdr->version != COL_FILE_VERSION ||
+		hdr->headerSize != sizeof(col_file_header_t) ||
+		hdr->fieldSize != sizeof(col_field_t) ||
+		hdr->fieldCount == 0 ||
+		hdr->dataSize > MAX_DATASET_SIZE ||
+		hdr->fieldCount > (size - sizeof(col_file_header_t)) / sizeof(col_field_t))
+	{
+		return NULL;
+	}
+
+	const col_field_t* schema = (const col_field_t*)(data + sizeof(col_file_header_t));
+	if (schema[0].dataOffset != COL_FIELD_ID_OFFSET || schema[0].dataSize != sizeof(uint64_t))
+	{
+		return NULL;
+	}
+	for (uint32_t i = 0; i < hdr->fieldCount; i++)
+	{
+		const col_field_t& field = schema[i];
+		if (field.name[COL_FIELD_NAME_SIZE - 1] != 0 ||
+			field.dataSize == 0 ||
+			field.fileOffset > size ||
+			hdr->rowCount > (size - field.fileOffset) / field.dataSize ||
+			(i > 0 && field.dataOffset + (uint64_t)field.dataSize > hdr->dataSize))
+		{
+			return NULL;
+		}
+	}
+	return hdr;
+}
+
+
+const uint8_t* cDeviceLogColumnar::FindColumn(const col_file_header_t* header, const std::string& name, const col_field_t** field)
+{
+	const col_field_t* schema = (const col_field_t*)((const uint8_t*)header + header->headerSize);
+	for (uint32_t i = 0; i < header->fieldCount; i++)
+	{
+		if (name == schema[i].name)
+		{
+			if (field)
+			{
+				*field = &schema[i];
+			}
+			return (const uint8_t*)header + schema[i].fileOffset;
+		}
+	}
+	return NULL;
+}
+
+
+bool cDeviceLogColumnar::OpenNextFile(cColumnarLog& log)
+{
+	log.header = NULLPTR;
+	log.schema = NULLPTR;
+	log.file.reset();
+
+	vector<string>& files = m_currentFiles[log.dataId];
+	uint32_t& index = m_currentFileIndex[log.dataId];
+	while (index < files.size())
+	{
+		const string& fileName = files[index++];
+		shared_ptr<cISLogFileMapped> file = make_shared<cISLogFileMapped>();
+		if (!file->open(fileName))
+		{
+			continue;
+		}
+		m_logSize += file->size();
+
+		const col_file_header_t* hdr = ValidateFile(file->data(), file->size());
+		if (hdr == NULL || hdr->dataId != log.dataId || hdr->rowCount == 0)
+		{
+#if LOG_DEBUG_FILE_READ
+			printf("cDeviceLogColumnar::OpenNextFile skipping %s\n", fileName.c_str());
+#endif
+			continue;
+		}
+
+		log.file = file;
+		log.header = hdr;
+		log.schema = (const col_field_t*)(file->data() + hdr->headerSize);
+		log.dataSize = hdr->dataSize;
+		log.fileCount++;
+		log.row = 0;
+		memcpy(&log.orderId, file->data() + log.schema[0].fileOffset, sizeof(uint64_t));
+		return true;
+	}
+	return false;
+}
+
+
+p_data_buf_t* cDeviceLogColumnar::ReadData()
+{
+	cColumnarLog* nextLog = NULL;
+	uint64_t nextId = ULLONG_MAX;
+	for (map<uint32_t, cColumnarLog>::iterator i = m_logs.begin(); i != m_logs.end(); i++)
+	{
+		if (i->second.orderId < nextId || nextLog == NULL)
+		{
+			nextLog = &i->second;
+			nextId = i->second.orderId;
+		}
+	}
+	if (nextLog == NULL)
+	{
+		return NULL;
+	}
+
+	// Gather the row from each column
+	cColumnarLog& log = *nextLog;
+	const uint8_t* data = log.file->data();
+	m_data.hdr.id = log.dataId;
+	m_data.hdr.size = log.dataSize;
+	m_data.hdr.offset = 0;
+	memset(m_data.buf, 0, log.dataSize);
+	for (uint32_t i = 1; i < log.header->fieldCount; i++)
+	{
+		const col_field_t& field = log.schema[i];
+		memcpy(m_data.buf + field.dataOffset, data + field.fileOffset + log.row * field.dataSize, field.dataSize);
+	}
+
+	// Advance to the next row
+	if (++log.row < log.header->rowCount)
+	{
+		memcpy(&log.orderId, data + log.schema[0].fileOffset + log.row * sizeof(uint64_t), sizeof(uint64_t));
+	}
+	else if (!OpenNextFile(log))
+	{
+		m_logs.erase(log.dataId);
+	}
+
+	if (m_data.hdr.id == DID_DEV_INFO && device)
+	{
+		memcpy((void *)&(device->devInfo), m_data.buf, sizeof(dev_info_t));
+	}
+
+    cDeviceLog::OnReadData(&m_data);
+	return &m_data;
+}
+
+
+void cDeviceLogColumnar::SetSerialNumber(uint32_t serialNumber)
+{
+    m_devSerialNo = serialNumber;
+}
@@ -0,0 +1,164 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DEVICE_LOG_COLUMNAR_H
+#define DEVICE_LOG_COLUMNAR_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "DataCSV.h"
+#include "DeviceLog.h"
+#include "ISLogFileMapped.h"
+#include "com_manager.h"
+
+/*
+* Columnar log file layout (.col), one file per data set per segment, little endian:
+*
+*   col_file_header_t                       file header
+*   col_field_t[fieldCount]                 schema, one entry per column
+*   column 0 .. fieldCount-1                rowCount * dataSize bytes each, starting on COL_FILE_ALIGN boundaries
+*
+* Column 0 is always "_ID_", a uint64 order id shared by all data sets of the device (like column 0 of the csv log)
+* so the log can be read back in order.  The remaining columns are the fields of the data set from cISDataMappings.
+* Every column is a fixed width typed array that can be used in place once the file is memory mapped.
+*/
+
+#define COL_FILE_MARKER         0x4C4F4353      // "SCOL"
+#define COL_FILE_VERSION        1
+#define COL_FILE_ALIGN          8
+#define COL_FIELD_NAME_SIZE     64
+#define COL_FIELD_ID_OFFSET     0xFFFFFFFF      // dataOffset of the "_ID_" column, not part of the data set
+
+PUSH_PACK_8
+
+typedef struct
+{
+	/** COL_FILE_MARKER */
+	uint32_t marker;
+
+	/** COL_FILE_VERSION */
+	uint16_t version;
+
+	/** sizeof(col_file_header_t) */
+	uint16_t headerSize;
+
+	/** Data set id */
+	uint32_t dataId;
+
+	/** Size of the data set structure */
+	uint32_t dataSize;
+
+	/** Number of rows in each column */
+	uint64_t rowCount;
+
+	/** Number of col_field_t entries following the header */
+	uint32_t fieldCount;
+
+	/** sizeof(col_field_t) */
+	uint32_t fieldSize;
+} col_file_header_t;
+
+typedef struct
+{
+	/** Field name, null terminated */
+	char name[COL_FIELD_NAME_SIZE];
+
+	/** Offset of the field in the data set structure, COL_FIELD_ID_OFFSET for the "_ID_" column */
+	uint32_t dataOffset;
+
+	/** Size of one value in bytes */
+	uint32_t dataSize;
+
+	/** eDataType */
+	uint32_t dataType;
+
+	/** eDataFlags */
+	uint32_t dataFlags;
+
+	/** Offset of the column from the start of the file */
+	uint64_t fileOffset;
+} col_field_t;
+
+POP_PACK
+
+class cColumnarLog
+{
+public:
+	uint32_t dataId = 0;
+	uint32_t dataSize = 0;
+	uint32_t fileCount = 0;
+
+	// writing
+	std::vector<data_info_t> fields;
+	std::vector<std::vector<uint8_t> > columns;     // one buffer per field, column 0 is the order id
+	std::vector<uint8_t> image;                     // last value of the data set, partial packets are merged into it
+	uint64_t rowCount = 0;
+	uint64_t rowSize = 0;                           // bytes per row across all columns
+
+	// reading
+	std::shared_ptr<cISLogFileMapped> file;
+	const col_file_header_t* header = NULLPTR;
+	const col_field_t* schema = NULLPTR;
+	uint64_t row = 0;
+	uint64_t orderId = 0;
+};
+
+
+class cDeviceLogColumnar : public cDeviceLog
+{
+public:
+    cDeviceLogColumnar() : cDeviceLog() {};
+    cDeviceLogColumnar(const ISDevice* dev) : cDeviceLog(dev) {};
+    cDeviceLogColumnar(uint16_t hdwId, uint32_t serialNo) : cDeviceLog(hdwId, serialNo) {};
+
+    void InitDeviceForWriting(std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) OVERRIDE;
+	void InitDeviceForReading() OVERRIDE;
+	bool CloseAllFiles() OVERRIDE;
+    bool SaveData(p_data_hdr_t* dataHdr, const uint8_t* dataBuf, protocol_type_t ptype=_PTYPE_INERTIAL_SENSE_DATA) OVERRIDE;
+	p_data_buf_t* ReadData() OVERRIDE;
+	void SetSerialNumber(uint32_t serialNumber) OVERRIDE;
+	std::string LogFileExtention() OVERRIDE { return std::string(".col"); }
+
+	/**
+	* Validate a columnar log file mapped into memory
+	* @param data start of the file
+	* @param size size of the file in bytes
+	* @return the file header, or NULL if the file is not a valid columnar log
+	*/
+	static const col_file_header_t* ValidateFile(const uint8_t* data, size_t size);
+
+	/**
+	* Find a column in a validated columnar log file
+	* @param header the file header returned by ValidateFile()
+	* @param name field name, "_ID_" for the order id column
+	* @param field set to the schema entry of the column if not NULL
+	* @return the column data (header->rowCount values of the field size), or NULL if not found
+	*/
+	static const uint8_t* FindColumn(const col_file_header_t* header, const std::string& name, const col_field_t** field = NULLPTR);
+
+private:
+	bool InitLogForWriting(cColumnarLog& log, uint32_t dataId);
+	bool WriteFile(cColumnarLog& log);
+	bool OpenNextFile(cColumnarLog& log);
+
+	std::map<uint32_t, cColumnarLog> m_logs;
+	std::map<uint32_t, std::vector<std::string> > m_currentFiles; // all files for each data set
+	std::map<uint32_t, uint32_t> m_currentFileIndex; // contains the current file index for each data set
+	p_data_buf_t m_data;
+	uint64_t m_nextId = 0; // for writing the log, column 0 is an incrementing id. This lets us read the log back in order.
+};
+
+#endif // DEVICE_LOG_COLUMNAR_H
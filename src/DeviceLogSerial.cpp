@@ -24,6 +24,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "DeviceLogSerial.h"
 #include "ISLogger.h"
 #include "ISLogFileFactory.h"
+#include "ISDataMappings.h"
 
 using namespace std;
 
@@ -42,26 +43,95 @@ cDeviceLogSerial::cDeviceLogSerial(uint16_t hdwId, uint32_t serialNo) : cDeviceL
 }
 
 void cDeviceLogSerial::InitDeviceForWriting(std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) {
-    m_chunk.Clear();
+    cDataChunk &chunk = SaveChunk();
+    chunk.Clear();
     if (device != nullptr) {
-        m_chunk.m_hdr.devSerialNum = device->devInfo.serialNumber;
-        m_chunk.m_hdr.pHandle = device->portHandle;
+        chunk.m_hdr.devSerialNum = device->devInfo.serialNumber;
+        chunk.m_hdr.pHandle = device->portHandle;
     }
+    m_compressStats = {};
 
     cDeviceLog::InitDeviceForWriting(timestamp, directory, maxDiskSpace, maxFileSize);
 }
 
 
+void cDeviceLogSerial::InitDeviceForReading() {
+    cDeviceLog::InitDeviceForReading();
+
+    m_chunk.Clear();
+    m_map.close();
+    m_mapPos = 0;
+    m_mapChunkEnd = 0;
+    m_readIndex.clear();
+    m_readIndexLoaded.clear();
+    m_seekData = NULL;
+    m_decompressStats = {};
+}
+
+
 bool cDeviceLogSerial::CloseAllFiles() {
+    CloseFiles();
+    m_map.close();
+
+    // Files are complete on return
+    if (m_writer) {
+        m_writer->Drain();
+    }
+
+    return true;
+}
+
+
+void cDeviceLogSerial::CloseFiles() {
     cDeviceLog::CloseAllFiles();
 
     // Write remaining data to file
     FlushToFile();
 
+    // Write the index of the file
+    if (m_indexEnabled && m_pFile != NULLPTR && m_index.Count()) {
+        m_index.Write(cLogChunkIndex::IndexFileName(m_fileName));
+    }
+    m_index.Clear();
+
     // Close file
-    CloseISLogFile(m_pFile);
+    CloseFile();
+}
 
-    return true;
+
+void cDeviceLogSerial::CloseFile() {
+    if (m_writer) {    // Closed by the I/O thread after the queued writes
+        m_writer->Close(m_pFile);
+        m_pFile = NULLPTR;
+    } else {
+        CloseISLogFile(m_pFile);
+    }
+}
+
+
+void cDeviceLogSerial::EnableAsyncWrite(uint32_t maxChunksInFlight) {
+    // Write out data and finish queued writes with the current mode
+    if (m_writeMode) {
+        WriteChunkToFile();
+    }
+    if (m_writer) {
+        m_writer->Drain();
+    }
+
+    uint32_t devSerialNum = SaveChunk().m_hdr.devSerialNum;
+    uint32_t pHandle = SaveChunk().m_hdr.pHandle;
+    m_writer.reset(maxChunksInFlight ? new cLogChunkWriter(maxChunksInFlight) : nullptr);
+    SaveChunk().m_hdr.devSerialNum = devSerialNum;
+    SaveChunk().m_hdr.pHandle = pHandle;
+}
+
+
+log_chunk_writer_stats_t cDeviceLogSerial::AsyncWriteStats() {
+    if (m_writer) {
+        return m_writer->Stats();
+    }
+    log_chunk_writer_stats_t stats = {};
+    return stats;
 }
 
 
@@ -81,6 +151,7 @@ bool cDeviceLogSerial::FlushToFile() {
 bool cDeviceLogSerial::SaveData(p_data_hdr_t *dataHdr, const uint8_t *dataBuf, protocol_type_t ptype) {
     cDeviceLog::SaveData(dataHdr, dataBuf, ptype);
 
+    cDataChunk *chunk = &SaveChunk();
     dev_info_t tmpInfo = {};
     dev_info_t* devInfo = &tmpInfo;
 
@@ -97,36 +168,42 @@ bool cDeviceLogSerial::SaveData(p_data_hdr_t *dataHdr, const uint8_t *dataBuf, p
 
             // Did we really get the serial number?
             if (start <= snOffset && (int) (snOffset + sizeof(uint32_t)) <= end) {
-                m_chunk.m_hdr.devSerialNum = devInfo->serialNumber;
+                chunk->m_hdr.devSerialNum = devInfo->serialNumber;
             }
         }
     } else
-        m_chunk.m_hdr.devSerialNum = m_devSerialNo;
+        chunk->m_hdr.devSerialNum = m_devSerialNo;
 
     // Ensure data will fit in chunk.  If not, create new chunk
     int32_t dataBytes = sizeof(p_data_hdr_t) + dataHdr->size;
-    int32_t buffFree = m_chunk.GetBuffFree();
+    int32_t buffFree = chunk->GetBuffFree();
     if (dataBytes > buffFree) {
         // Save chunk to file and clear
         if (!WriteChunkToFile()) {
             return false;
         } else if (m_fileSize >= m_maxFileSize) {
-            // Close existing file
-            CloseAllFiles();
+            // Close existing file, without waiting for queued writes
+            CloseFiles();
         }
+        chunk = &SaveChunk();
     }
     // Add data header and data buffer to chunk
-    if (!m_chunk.PushBack((unsigned char *) dataHdr, sizeof(p_data_hdr_t), (unsigned char *) dataBuf, dataHdr->size)) {
+    if (!chunk->PushBack((unsigned char *) dataHdr, sizeof(p_data_hdr_t), (unsigned char *) dataBuf, dataHdr->size)) {
         return false;
     }
 
+    if (m_indexEnabled) {
+        m_index.AddPacket(dataHdr->id, (ptype == _PTYPE_INERTIAL_SENSE_DATA ? cISDataMappings::GetTimestamp(dataHdr, dataBuf) : 0.0));
+    }
+
     return true;
 }
 
 
 bool cDeviceLogSerial::WriteChunkToFile() {
     // Make sure we have data to write
-    if (m_chunk.GetDataSize() == 0) {
+    cDataChunk &chunk = SaveChunk();
+    if (chunk.GetDataSize() == 0) {
         return false;
     }
 
@@ -140,8 +217,23 @@ bool cDeviceLogSerial::WriteChunkToFile() {
         return false;
     }
 
+    if (m_compressLevel > 0) {
+        chunk.Compress(m_compressLevel, &m_compressStats);
+    }
+
+    if (m_indexEnabled) {   // Chunk starts at the current end of file
+        m_index.EndChunk(m_fileSize, (uint32_t)chunk.GetDataSize());
+    }
+
+    if (m_writer) {    // Hand the chunk to the I/O thread.  Sizes are updated now so file rotation is not delayed.
+        int fileBytes = (int)sizeof(sChunkHeader) + chunk.GetDataSize();
+        m_fileSize += fileBytes;
+        m_logSize += fileBytes;
+        return m_writer->Write(m_pFile);
+    }
+
     // Write chunk to file
-    int fileBytes = m_chunk.WriteToFile(m_pFile, 0);
+    int fileBytes = chunk.WriteToFile(m_pFile, 0);
     if (!m_pFile->good()) {
         return false;
     }
@@ -155,14 +247,10 @@ bool cDeviceLogSerial::WriteChunkToFile() {
 
 
 p_data_buf_t *cDeviceLogSerial::ReadData() {
-    p_data_buf_t *data = NULL;
-
-    // Read data from chunk
-    while (!(data = ReadDataFromChunk())) {
-        // Read next chunk from file
-        if (!ReadChunkFromFile()) {
-            return NULL;
-        }
+    p_data_buf_t *data = m_seekData;
+    m_seekData = NULL;
+    if (data == NULL) {
+        data = ReadNextData();
     }
 
     // Read is good
@@ -171,6 +259,28 @@ p_data_buf_t *cDeviceLogSerial::ReadData() {
 }
 
 
+p_data_buf_t *cDeviceLogSerial::ReadNextData() {
+    while (1) {
+        p_data_buf_t *data = NULL;
+        if (m_mappedRead) {
+            data = ReadMappedData();
+        } else {
+            // Read data from chunk
+            while (!(data = ReadDataFromChunk())) {
+                // Read next chunk from file
+                if (!ReadChunkFromFile()) {
+                    return NULL;
+                }
+            }
+        }
+
+        if (data == NULL || m_readFilter.empty() || (data->hdr.id < m_readFilter.size() && m_readFilter[data->hdr.id])) {
+            return data;
+        }
+    }
+}
+
+
 p_data_buf_t *cDeviceLogSerial::ReadDataFromChunk() {
     // Ensure chunk has data
     if (m_chunk.GetDataSize() <= 0) {
@@ -189,25 +299,217 @@ p_data_buf_t *cDeviceLogSerial::ReadDataFromChunk() {
 
 bool cDeviceLogSerial::ReadChunkFromFile() {
     // Read next chunk from file
-    while (m_chunk.ReadFromFile(m_pFile) < 0) {
+    while (1) {
+        if (m_pFile != NULLPTR) {
+            // Skip chunks without the DIDs being read
+            int64_t offset = m_readFilter.empty() ? 0 : NextWantedChunk(m_pFile->tell());
+            if (offset >= 0) {
+                if (!m_readFilter.empty()) {
+                    m_pFile->seek((long) offset, SEEK_SET);
+                }
+                if (m_chunk.ReadFromFile(m_pFile, true, &m_decompressStats) >= 0) {
+                    return true;
+                }
+            }
+        }
+
         if (!OpenNextReadFile()) {
             // No more data or error opening next file
             return false;
         }
     }
+}
+
+
+p_data_buf_t *cDeviceLogSerial::ReadMappedData() {
+    while (1) {
+        // Compressed chunks are decompressed into m_chunk
+        p_data_buf_t *data = ReadDataFromChunk();
+        if (data != NULL) {
+            return data;
+        }
+
+        // Packets are used in place in the chunk data, which has the same layout as p_data_buf_t
+        std::size_t remaining = m_mapChunkEnd - m_mapPos;
+        if (remaining >= sizeof(p_data_hdr_t)) {
+            data = (p_data_buf_t *) (m_map.data() + m_mapPos);
+            std::size_t size = sizeof(p_data_hdr_t) + data->hdr.size;
+            if (size <= remaining) {
+                m_mapPos += size;
+                return data;
+            }
+        }
+
+        // Next chunk, or next file
+        while (!ReadMappedChunk()) {
+            if (!OpenNextMappedFile()) {
+                // No more data or error opening next file
+                return NULL;
+            }
+        }
+    }
+}
+
+
+bool cDeviceLogSerial::ReadMappedChunk() {
+    if (!m_map.isOpened()) {
+        return false;
+    }
+
+    // Skip chunks without the DIDs being read
+    int64_t offset = m_readFilter.empty() ? (int64_t) m_mapChunkEnd : NextWantedChunk(m_mapChunkEnd);
+    if (offset < 0 || m_map.size() - _MIN((std::size_t) offset, m_map.size()) < sizeof(sChunkHeader)) {
+        m_mapPos = m_mapChunkEnd = m_map.size();
+        return false;
+    }
+    m_mapChunkEnd = (std::size_t) offset;
+
+    // Same checks as cDataChunk::ReadFromFile(), the file is not read past a bad or truncated chunk
+    const sChunkHeader *hdr = (const sChunkHeader *) (m_map.data() + m_mapChunkEnd);
+    std::size_t start = m_mapChunkEnd + sizeof(sChunkHeader);
+    if (hdr->marker != DATA_CHUNK_MARKER ||
+        hdr->dataSize != ~(hdr->invDataSize) ||
+        hdr->dataSize > m_map.size() - start) {
+        m_mapPos = m_mapChunkEnd = m_map.size();
+        return false;
+    }
+
+    if (hdr->flags & DATA_CHUNK_FLAG_COMPRESSED) {
+        if (!m_chunk.Decompress(m_map.data() + start, hdr->dataSize, &m_decompressStats)) {
+            m_mapPos = m_mapChunkEnd = m_map.size();
+            return false;
+        }
+        m_mapPos = m_mapChunkEnd = start + hdr->dataSize;
+        return true;
+    }
+
+    m_mapPos = start;
+    m_mapChunkEnd = start + hdr->dataSize;
     return true;
 }
 
 
+bool cDeviceLogSerial::OpenNextMappedFile() {
+    m_map.close();
+    m_mapPos = 0;
+    m_mapChunkEnd = 0;
+
+    if (m_fileCount == m_fileNames.size()) {
+        return false;
+    }
+
+    m_fileName = m_fileNames[m_fileCount++];
+    return m_map.open(m_fileName);
+}
+
+
+bool cDeviceLogSerial::OpenReadFileAt(size_t file, uint64_t offset) {
+    m_chunk.Clear();
+    m_fileCount = (uint32_t) file;
+
+    if (m_mappedRead) {
+        if (!OpenNextMappedFile()) {
+            return false;
+        }
+        m_mapPos = m_mapChunkEnd = (std::size_t) _MIN(offset, (uint64_t) m_map.size());
+        return true;
+    }
+
+    if (!OpenNextReadFile()) {
+        return false;
+    }
+    return m_pFile->seek((long) offset, SEEK_SET) == 0;
+}
+
+
+cLogChunkIndex *cDeviceLogSerial::ReadIndex(size_t file) {
+    if (file >= m_fileNames.size()) {
+        return NULL;
+    }
+    if (m_readIndex.size() != m_fileNames.size()) {
+        m_readIndex.clear();
+        m_readIndex.resize(m_fileNames.size());
+        m_readIndexLoaded.assign(m_fileNames.size(), false);
+    }
+
+    if (!m_readIndexLoaded[file]) {
+        m_readIndexLoaded[file] = true;
+        std::unique_ptr<cLogChunkIndex> index(new cLogChunkIndex());
+        if (index->Read(cLogChunkIndex::IndexFileName(m_fileNames[file]))) {
+            m_readIndex[file] = std::move(index);
+        }
+    }
+    return m_readIndex[file].get();
+}
+
+
+// Returns the offset of the next chunk at or after offset in the current read file with any DID in m_readFilter,
+// offset itself if the file has no index, or -1 if there are none
+int64_t cDeviceLogSerial::NextWantedChunk(uint64_t offset) {
+    cLogChunkIndex *index = (m_fileCount > 0 ? ReadIndex(m_fileCount - 1) : NULL);
+    if (index == NULL) {
+        return (int64_t) offset;
+    }
+
+    int chunk = index->FindNext(offset, m_readFilter);
+    return (chunk < 0 ? -1 : (int64_t) index->Entry(chunk).offset);
+}
+
+
+bool cDeviceLogSerial::Seek(double timestamp) {
+    m_seekData = NULL;
+
+    for (size_t file = 0; file < m_fileNames.size(); file++) {
+        // Start at the first chunk with data at or after the time, or at the start of a file without an index
+        uint64_t offset = 0;
+        cLogChunkIndex *index = ReadIndex(file);
+        if (index != NULL) {
+            int chunk = index->FindTime(timestamp);
+            if (chunk < 0) {
+                continue;
+            }
+            offset = index->Entry(chunk).offset;
+        }
+
+        if (!OpenReadFileAt(file, offset)) {
+            return false;
+        }
+
+        // Skip earlier data in the chunk
+        p_data_buf_t *data;
+        while ((data = ReadNextData()) != NULL) {
+            if (cISDataMappings::GetTimestamp(&data->hdr, data->buf) >= timestamp) {
+                m_seekData = data;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Past the end of the log
+    m_chunk.Clear();
+    m_map.close();
+    m_mapPos = m_mapChunkEnd = 0;
+    CloseISLogFile(m_pFile);
+    m_fileCount = (uint32_t) m_fileNames.size();
+    return false;
+}
+
+
 void cDeviceLogSerial::SetSerialNumber(uint32_t serialNumber) {
     m_devSerialNo = serialNumber;
     m_chunk.m_hdr.devSerialNum = serialNumber;
+    SaveChunk().m_hdr.devSerialNum = serialNumber;
 }
 
 
 void cDeviceLogSerial::Flush() {
     if (WriteChunkToFile()) {
-        m_pFile->flush();
+        if (m_writer) {
+            m_writer->Flush(m_pFile);
+        } else {
+            m_pFile->flush();
+        }
     }
 }
 
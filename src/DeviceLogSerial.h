@@ -16,12 +16,19 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdio.h>
 #include <string>
 #include <vector>
+#include <memory>
 
 #include "DataChunk.h"
 #include "DeviceLog.h"
+#include "ISLogChunkWriter.h"
+#include "ISLogFileMapped.h"
+#include "ISLogChunkIndex.h"
 #include "com_manager.h"
 
 
+// default deflate level of EnableCompression(), fast with most of the size reduction of higher levels for log data
+#define LOG_CHUNK_COMPRESSION_DEFAULT_LEVEL     1
+
 class cDeviceLogSerial : public cDeviceLog {
 public:
     cDeviceLogSerial();
@@ -32,6 +39,8 @@ public:
 
     void InitDeviceForWriting(std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFilesize) OVERRIDE;
 
+    void InitDeviceForReading() OVERRIDE;
+
     bool CloseAllFiles() OVERRIDE;
 
     bool FlushToFile() OVERRIDE;
@@ -46,14 +55,103 @@ public:
 
     void Flush() OVERRIDE;
 
+    /**
+    * Position reading at the first data at or after a time.  Files with a chunk index (cLogChunkIndex) are
+    * positioned directly, others are read from the start of the file.
+    */
+    bool Seek(double timestamp) OVERRIDE;
+
+    /**
+    * Write a chunk index sidecar file (cLogChunkIndex) next to each log file.  Enabled by default.
+    */
+    void EnableChunkIndex(bool enable = true) { m_indexEnabled = enable; }
+
+    /**
+    * Write filled chunks to file from an I/O thread (cLogChunkWriter) instead of the logging thread
+    * @param maxChunksInFlight number of filled chunks that may be waiting to be written before logging waits, 0 to write synchronously
+    */
+    void EnableAsyncWrite(uint32_t maxChunksInFlight = LOG_CHUNK_WRITER_DEFAULT_CHUNKS);
+
+    bool AsyncWriteEnabled() { return m_writer != nullptr; }
+
+    /**
+    * Get the I/O thread queue depth and write latency, all zero when not writing asynchronously
+    */
+    log_chunk_writer_stats_t AsyncWriteStats();
+
+    /**
+    * Compress chunk data (miniz deflate) before it is written.  Chunks that do not get smaller are written
+    * uncompressed.  Reading decompresses chunks as needed.  Applies to chunks written after the call.
+    * @param level 1 (fastest) to 10 (smallest), 0 to disable
+    */
+    void EnableCompression(int level = LOG_CHUNK_COMPRESSION_DEFAULT_LEVEL) { m_compressLevel = level; }
+
+    int CompressionLevel() { return m_compressLevel; }
+
+    /**
+    * Get the size and time of compressing chunks written since InitDeviceForWriting()
+    */
+    const chunk_compression_stats_t& CompressionStats() { return m_compressStats; }
+
+    /**
+    * Get the size and time of decompressing chunks read since InitDeviceForReading()
+    */
+    const chunk_compression_stats_t& DecompressionStats() { return m_decompressStats; }
+
+    /**
+    * Read log files memory mapped (cISLogFileMapped).  ReadData() then returns packets in place in the mapped file
+    * rather than copied into m_chunk, except for compressed chunks.  Call before reading.
+    */
+    void EnableMappedRead(bool enable = true) { m_mappedRead = enable; }
+
+    bool MappedReadEnabled() { return m_mappedRead; }
+
     cDataChunk m_chunk;
 
 private:
+    // chunk being filled when writing, owned by m_writer when writing asynchronously
+    cDataChunk& SaveChunk() { return m_writer ? *m_writer->Chunk() : m_chunk; }
+
+    p_data_buf_t *ReadNextData();
+
     p_data_buf_t *ReadDataFromChunk();
 
     bool ReadChunkFromFile();
 
+    p_data_buf_t *ReadMappedData();
+
+    bool ReadMappedChunk();
+
+    bool OpenNextMappedFile();
+
+    bool OpenReadFileAt(size_t file, uint64_t offset);
+
+    cLogChunkIndex *ReadIndex(size_t file);
+
+    int64_t NextWantedChunk(uint64_t offset);
+
     bool WriteChunkToFile();
+
+    void CloseFiles();
+
+    void CloseFile();
+
+    std::unique_ptr<cLogChunkWriter> m_writer;
+
+    bool m_mappedRead = false;
+    cISLogFileMapped m_map;
+    std::size_t m_mapPos = 0;          // next packet in the mapped file
+    std::size_t m_mapChunkEnd = 0;     // end of the current chunk data, start of the next chunk header
+
+    int m_compressLevel = 0;
+    chunk_compression_stats_t m_compressStats = {};
+    chunk_compression_stats_t m_decompressStats = {};
+
+    bool m_indexEnabled = true;
+    cLogChunkIndex m_index;                                 // index of the file being written
+    std::vector<std::unique_ptr<cLogChunkIndex>> m_readIndex;   // index of each file being read, NULL if none
+    std::vector<bool> m_readIndexLoaded;
+    p_data_buf_t *m_seekData = NULL;                        // packet found by Seek(), returned by the next ReadData()
 };
 
 #endif // DEVICE_LOG_SERIAL_H
@@ -22,6 +22,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <stdlib.h>
 #include <stddef.h>
 #include <limits.h>
+#include <algorithm>
+#include <functional>
 
 #include "ISLogger.h"
 #include "ISLogFileFactory.h"
@@ -39,6 +41,7 @@ cDeviceLogSorted::cDeviceLogSorted()
     for (uint32_t i = 0; i < DID_COUNT; i++)
     {
         m_chunks[i] = NULLPTR;
+        m_readChunks[i] = NULLPTR;
     }
 }
 
@@ -46,6 +49,7 @@ cDeviceLogSorted::cDeviceLogSorted(const ISDevice* dev) : cDeviceLog(dev) {
     for (uint32_t i = 0; i < DID_COUNT; i++)
     {
         m_chunks[i] = NULLPTR;
+        m_readChunks[i] = NULLPTR;
     }
 }
 
@@ -53,6 +57,17 @@ cDeviceLogSorted::cDeviceLogSorted(uint16_t hdwId, uint32_t serialNo) : cDeviceL
     for (uint32_t i = 0; i < DID_COUNT; i++)
     {
         m_chunks[i] = NULLPTR;
+        m_readChunks[i] = NULLPTR;
+    }
+}
+
+
+cDeviceLogSorted::~cDeviceLogSorted()
+{
+    for (uint32_t i = 0; i < DID_COUNT; i++)
+    {
+        delete m_chunks[i];
+        m_chunks[i] = NULLPTR;
     }
 }
 
@@ -68,7 +83,6 @@ void cDeviceLogSorted::InitDeviceForWriting(std::string timestamp, std::string d
         }
     }
 	m_dataSerNum = 0;
-	m_lastSerNum = 0xFFFFFFFF;
 	cDeviceLog::InitDeviceForWriting(timestamp, directory, maxDiskSpace, maxFileSize);
 }
 
@@ -85,7 +99,6 @@ void cDeviceLogSorted::InitDeviceForReading()
 		}
 	}
     m_dataSerNum = 0;
-	m_lastSerNum = 0xFFFFFFFF;
 	cDeviceLog::InitDeviceForReading();
 
 	// Open all files
@@ -95,36 +108,40 @@ void cDeviceLogSorted::InitDeviceForReading()
 
 bool cDeviceLogSorted::OpenAllReadFiles()
 {
-	// Close files if open
-	for (unsigned int i = 0; i < m_pFiles.size(); i++)
-	{	
-		CloseISLogFile(m_pFiles[i]);
+	// Drop any previous read state and close files
+	for (uint32_t id = 0; id < DID_COUNT; id++)
+	{
+		m_readChunks[id] = NULLPTR;
 	}
-	m_pFiles.clear();
-
-	for (m_fileCount = 0; m_fileCount < m_fileNames.size(); m_fileCount++)
+	m_readHeap.clear();
+	m_reader.reset(new cLogSortedChunkReader(m_fileNames));
+	m_fileCount = (uint32_t)m_fileNames.size();
+	if (!m_fileNames.empty())
 	{
-		m_fileName = m_fileNames[m_fileCount];
-		m_pFiles.push_back(CreateISLogFile(m_fileName, "rb"));
+		m_fileName = m_fileNames.back();
+	}
 
-		if (m_pFiles.back())
-		{	// Success
-#if LOG_DEBUG_FILE_READ
-			printf("cDeviceLog::OpenNextReadFile %s\n", m_fileName.c_str());
-#endif
-		}
-		else
-		{	// Failure
+	// Find the chunks of each DID in all files
+	if (!m_reader->Index(m_readIndex))
+	{
 #if LOG_DEBUG_FILE_READ
-			printf("cDeviceLog::OpenNextReadFile FAILED %s\n", m_fileName.c_str());
+		printf("cDeviceLogSorted::OpenAllReadFiles FAILED %s\n", m_directory.c_str());
 #endif
-			return false;
-		}
+		return false;
 	}
 
-	for (uint32_t id = 0; id < DID_COUNT; id++)
+	// Read the first chunk of each DID and request the next
+	for (uint32_t id = 1; id < DID_COUNT; id++)
 	{
-		m_chunksAvailable[id] = true;
+		m_readIndexPos[id] = 0;
+		if (!m_readIndex[id].empty())
+		{
+			m_reader->Request(id, m_readIndex[id][m_readIndexPos[id]++]);
+		}
+	}
+	for (uint32_t id = 1; id < DID_COUNT; id++)
+	{
+		NextReadChunk(id);
 	}
 
 	return true;
@@ -139,12 +156,13 @@ bool cDeviceLogSorted::CloseAllFiles()
 	// Close file pointer used for writing
 	CloseISLogFile(m_pFile);
 
-	// Close file pointer array used for reading
-	for (unsigned int i = 0; i < m_pFiles.size(); i++)
+	// Close files used for reading
+	for (uint32_t id = 0; id < DID_COUNT; id++)
 	{
-		CloseISLogFile(m_pFiles[i]);
+		m_readChunks[id] = NULLPTR;
 	}
-	m_pFiles.clear();
+	m_readHeap.clear();
+	m_reader.reset();
 
 	cDeviceLog::CloseAllFiles();
 
@@ -298,225 +316,114 @@ bool cDeviceLogSorted::WriteChunkToFile(uint32_t id)
 }
 
 
-// Re-serialize data to original order
-// Consider using a queue where data from chunks are added on one end and the serial order # is checked on the other end.
-// This function needs to scan across all chunk queues and find the next lowest data to pop off.
-
-// Read serialized data
-p_data_buf_t* cDeviceLogSorted::ReadData()
+// Replace the exhausted read chunk of a DID with the prefetched chunk, request the chunk after it, and add the DID
+// to the heap if it has data.  Returns false when the DID has no more data.
+bool cDeviceLogSorted::NextReadChunk(uint32_t id)
 {
-	p_data_buf_t* data;
-
-	while (1)
+	if (m_reader == nullptr)
 	{
-		data = SerializeDataFromChunks();
-
-		if (data)
-		{	// Found data
-            cDeviceLog::OnReadData(data);       // Record statistics
-
-#if LOG_DEBUG_PRINT_DID_READ
-			double timestamp = cISDataMappings::GetTimestamp(&(data->hdr), data->buf);
-			printf("sorted did read: %d  DID: %2d  size: %3d  time: %.4lf\n", m_dataSerNum-1, data->hdr.id, data->hdr.size, timestamp);
-#endif
-		}
-
-		return data;
+		return false;
 	}
-}
 
+	m_reader->Release(m_readChunks[id]);
+	m_readChunks[id] = NULLPTR;
 
-p_data_buf_t* cDeviceLogSorted::SerializeDataFromChunks()
-{
-
-tryAgain:
-
-	uint32_t foundId = UINT_MAX;
-	uint32_t minSerialNum = UINT_MAX;
-    cSortedDataChunk *chunk;
-
-	// while there is data in any chunk, find the chunk with the next id
-	for (uint32_t id = 1; id < DID_COUNT; id++)
+	cSortedDataChunk* chunk;
+	while ((chunk = m_reader->Take(id)) != NULLPTR || m_readIndexPos[id] < m_readIndex[id].size())
 	{
-		if (!m_chunksAvailable[id])
+		// Keep one chunk in flight for this DID
+		if (m_readIndexPos[id] < m_readIndex[id].size())
 		{
-			continue;
+			m_reader->Request(id, m_readIndex[id][m_readIndexPos[id]++]);
 		}
 
-        chunk = m_chunks[id];
-        if (chunk == NULLPTR || chunk->GetDataSize() == 0)
-		{
-			// Chunk is empty.  Search all files for new chuck.
-			if (ReadNextChunkFromFiles(id))
-			{
-				chunk = m_chunks[id];
-			}
-			if (chunk == NULLPTR || chunk->GetDataSize() == 0)
-			{
-				m_chunksAvailable[id] = false;
-				continue;
-			}
+		if (chunk == NULLPTR)
+		{	// Read failed, try the next chunk
+			continue;
 		}
 
+		m_logSize += chunk->GetHeaderSize() + chunk->m_hdr.dataSize;
 		uint32_t dataSerNum = chunk->GetDataSerNum();
-        if (dataSerNum == UINT_MAX)
-        {
-            continue;
-        }
-		if (dataSerNum == m_dataSerNum)
-		{	// Found exact match.
-			foundId = id;
-			break;
-		}
-		if (dataSerNum < minSerialNum)
-		{	// Search for lowest serial number
-			foundId = id;
-			minSerialNum = dataSerNum;
+		if (chunk->m_subHdr.dHdr.id != id || dataSerNum == UINT_MAX)
+		{	// Chunk is empty or not the expected DID
+			m_reader->Release(chunk);
+			continue;
 		}
-	}
-
-	if (foundId == UINT_MAX)
-	{   // No more data left
-		return NULL;
-	}
-
-    chunk = m_chunks[foundId];
-	p_cnk_data_t* cnkData = (p_cnk_data_t*)(chunk->GetDataPtr());
-
-#if 0	// Error check for gap data serial number.  Verify we didn't drop any data.
-
-	if (m_lastSerNum == UINT_MAX)
-	{
-		m_lastSerNum = m_dataSerNum;
-	}
-	if (m_dataSerNum - m_lastSerNum > 1)
-	{
-		cout << endl << "Gap in data: " << foundId << "\t" << m_dataSerNum;
-	}
-	m_lastSerNum = m_dataSerNum;
 
+#if LOG_DEBUG_PRINT_CHUNK_READ
+		printf("sorted chunk read:   DID:%3d  dCount: %5d  nBytes: %6d   dataSN: %2d\n", id, chunk->m_subHdr.dCount, chunk->GetDataSize(), dataSerNum);
 #endif
 
-	// Increment data serial number to one larger than current
-	m_dataSerNum = chunk->GetDataSerNum() + 1;
-	
-	if (chunk->m_subHdr.dHdr.size <= MAX_DATASET_SIZE)
-	{   
-		// Data fits in temp buf
-
-        // Copy data header
-		m_data.hdr = chunk->m_subHdr.dHdr;
-
-		// Copy data buffer, ensure not to overrun chunk memory in case of corrupt data
-		memcpy(m_data.buf, cnkData->buf, _MIN(chunk->GetDataSize(), (int32_t)(m_data.hdr.size)));
-
-        // Size = serial number plus data size
-		int pSize = chunk->m_subHdr.dHdr.size + sizeof(uint32_t);
-
-		chunk->PopFront(pSize);
-		return &m_data;
+		m_readChunks[id] = chunk;
+		m_readHeap.push_back(((uint64_t)dataSerNum << 32) | id);
+		std::push_heap(m_readHeap.begin(), m_readHeap.end(), std::greater<uint64_t>());
+		return true;
 	}
-    else
-    {
-        perror("Data is larger than max data set size");
-    }
 
-	goto tryAgain;
+	return false;
 }
 
 
-// This function reads the next sorted chunk matching the specified DID from all of the files.  The file pointers are advanced 
-// if the current chunk dataSerNum is older than the current m_dataSerNum.  Files are closed if the last chuch dataSerNum 
-// is older than the current m_dataSerNum.
-bool cDeviceLogSorted::ReadNextChunkFromFiles(uint32_t id)
+// Re-serialize data to original order.  The heap holds the next dataSerNum of each DID.
+p_data_buf_t* cDeviceLogSorted::ReadData()
 {
-	// Error check ID
-	if (id >= DID_COUNT || id == DID_NULL)
+	while (!m_readHeap.empty())
 	{
-		return false;
-	}
-
-	// Reset data serial number and file data size
-	m_fileSize = 0;
-
-	// Read chunk and append it to existing chunks of same type
-	if (!ReadChunkFromFiles(&m_readChunk, id))
-	{
-		return false;
-	}
-
-	id = m_readChunk.m_subHdr.dHdr.id;
+		std::pop_heap(m_readHeap.begin(), m_readHeap.end(), std::greater<uint64_t>());
+		uint32_t id = (uint32_t)(m_readHeap.back() & 0xFFFFFFFF);
+		m_readHeap.pop_back();
+
+		cSortedDataChunk* chunk = m_readChunks[id];
+		p_cnk_data_t* cnkData = (p_cnk_data_t*)(chunk->GetDataPtr());
+		int32_t pSize = chunk->m_subHdr.dHdr.size + sizeof(uint32_t);	// Size = serial number plus data size
+		if (chunk->m_subHdr.dHdr.size > MAX_DATASET_SIZE || pSize > chunk->GetDataSize())
+		{	// Corrupt chunk, drop the rest of it
+			perror("Data is larger than max data set size");
+			NextReadChunk(id);
+			continue;
+		}
 
-	if (m_chunks[id] == NULLPTR)
-	{
-		m_chunks[id] = new cSortedDataChunk();
-	}
+		m_dataSerNum = cnkData->dataSerNum + 1;
+		m_data.hdr = chunk->m_subHdr.dHdr;
+		memcpy(m_data.buf, cnkData->buf, m_data.hdr.size);
+		chunk->PopFront(pSize);
 
-	cSortedDataChunk* chunk = m_chunks[id];
+		// Next data of this DID
+		if (chunk->GetDataSize() > 0)
+		{
+			m_readHeap.push_back(((uint64_t)chunk->GetDataSerNum() << 32) | id);
+			std::push_heap(m_readHeap.begin(), m_readHeap.end(), std::greater<uint64_t>());
+		}
+		else
+		{
+			NextReadChunk(id);
+		}
 
-	if (chunk->GetDataSize() == 0)
-	{
-		// Reset buffer
-		chunk->Clear();
+		cDeviceLog::OnReadData(&m_data);       // Record statistics
 
-		// Copy chunk sub header
-		chunk->m_subHdr = m_readChunk.m_subHdr;
+#if LOG_DEBUG_PRINT_DID_READ
+		double timestamp = cISDataMappings::GetTimestamp(&(m_data.hdr), m_data.buf);
+		printf("sorted did read: %d  DID: %2d  size: %3d  time: %.4lf\n", m_dataSerNum-1, m_data.hdr.id, m_data.hdr.size, timestamp);
+#endif
 
-		// Find lowest serial number (used for sorting data)
-		m_dataSerNum = _MIN(m_dataSerNum, m_readChunk.GetDataSerNum());
+		return &m_data;
 	}
 
-	// add data count
-	chunk->m_subHdr.dCount += m_readChunk.m_subHdr.dCount;
-
-	// Resize chunk if necessary
-//         if (m_readChunk.GetDataSize() > chunk->GetBuffFree())
-//         {
-//             chunk->Resize(chunk->GetDataSize() + m_readChunk.GetDataSize());
-//         }
-
-	// Append data
-	chunk->PushBack(m_readChunk.GetDataPtr(), m_readChunk.GetDataSize());
-
-	return m_fileSize != 0;
+	return NULL;
 }
 
 
-// This function reads the next sorted chunk matching the specified DID from all of the files.  The file pointers are advanced 
-// if the current chunk dataSerNum is older than the current m_dataSerNum.  Files are closed if the last chuch dataSerNum 
-// is older than the current m_dataSerNum.
-bool cDeviceLogSorted::ReadChunkFromFiles(cSortedDataChunk *chunk, uint32_t id)
+log_chunk_read_stats_t cDeviceLogSorted::ReadStats()
 {
-	if (m_pFiles.size() == 0 || m_pFiles.front() == NULLPTR || chunk == NULLPTR)
-	{
-		return false;
-	}
-
-	// Read chunk from file
-	int nBytes = chunk->ReadFromFiles(m_pFiles, id, m_dataSerNum);
-	if (nBytes < 0)
+	if (m_reader == nullptr)
 	{
-		return false;
+		log_chunk_read_stats_t stats = {};
+		return stats;
 	}
-
-#if LOG_DEBUG_PRINT_CHUNK_READ
-	printf("sorted chunk read:   DID:%3d  dCount: %5d  nBytes: %6d   dataSN: %2d\n", chunk->m_subHdr.dHdr.id, chunk->m_subHdr.dCount, (int)(nBytes-sizeof(sChunkHeader)-sizeof(sChunkSubHeader)), chunk->GetDataSerNum());
-#endif
-
-	// Validate chunk: non-zero size and is sorted type
-	int hdrSize = sizeof(p_data_hdr_t);
-	if (nBytes < hdrSize || chunk->m_hdr.grpNum != 1)
-	{
-		return false;
-	}
-
-	// Update stats
-	m_fileSize += nBytes;
-	m_logSize += nBytes;
-
-	return true;
+	return m_reader->Stats();
 }
 
+
 void cDeviceLogSorted::SetSerialNumber(uint32_t serialNumber)
 {
     m_devSerialNo = serialNumber;
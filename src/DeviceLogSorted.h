@@ -17,9 +17,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <string>
 #include <vector>
 #include <list>
+#include <memory>
 
 #include "DeviceLog.h"
 #include "DataChunkSorted.h"
+#include "ISLogSortedChunkReader.h"
 
 
 class cDeviceLogSorted : public cDeviceLog
@@ -28,6 +30,7 @@ public:
     cDeviceLogSorted();
     cDeviceLogSorted(const ISDevice* dev);
     cDeviceLogSorted(uint16_t hdwId, uint32_t serialNo);
+    virtual ~cDeviceLogSorted();
 
     void InitDeviceForWriting(std::string timestamp, std::string directory, uint64_t maxDiskSpace, uint32_t maxFileSize) OVERRIDE;
 	void InitDeviceForReading() OVERRIDE;
@@ -39,21 +42,27 @@ public:
 	void SetSerialNumber(uint32_t serialNumber) OVERRIDE;
 	std::string LogFileExtention() OVERRIDE { return std::string(".sdat"); }
 
+	/**
+	* Get the file read counters, all zero when not reading
+	*/
+	log_chunk_read_stats_t ReadStats();
+
     cSortedDataChunk *m_chunks[DID_COUNT];
-	bool m_chunksAvailable[DID_COUNT];
 
-	p_data_buf_t* SerializeDataFromChunks();
-	bool ReadNextChunkFromFiles(uint32_t id);
-	bool ReadChunkFromFiles(cSortedDataChunk *chunk, uint32_t id);
 	bool WriteChunkToFile(uint32_t id);
 
 	uint32_t m_dataSerNum;
-	uint32_t m_lastSerNum;
 	p_data_buf_t m_data;
-	cSortedDataChunk m_readChunk;
 
-	std::vector<cISLogFileBase*> m_pFiles;
+private:
+	bool NextReadChunk(uint32_t id);
 
+	// Reading: the current chunk of each DID is merged by dataSerNum while the reader prefetches the next one
+	std::unique_ptr<cLogSortedChunkReader> m_reader;
+	std::vector<std::vector<log_chunk_location_t>> m_readIndex;    // chunk locations of each DID
+	uint32_t m_readIndexPos[DID_COUNT];                             // next chunk location to request for each DID
+	cSortedDataChunk *m_readChunks[DID_COUNT];                      // chunk being read for each DID, owned by m_reader
+	std::vector<uint64_t> m_readHeap;                               // min-heap of dataSerNum << 32 | DID, one per DID with data
 };
 
 #endif // DEVICE_LOG_SORTED_H
@@ -529,8 +529,24 @@ typedef struct
     /** Search pointer prior to reset (used to identify errors) */
     uint8_t* scanPrior;
 
+    /** Size of the ring in RXBUF_MODE_RING, zero in linear mode.  The bytes from start + ringSize to end are the mirror region, where a packet that wraps continues so it is contiguous. */
+    uint32_t ringSize;
+
 } is_comm_buffer_t;
 
+/** Receive buffer mode, see is_comm_init_mode() */
+typedef enum
+{
+    /** Unparsed data is shifted to the buffer start when the end is reached.  Buffer is flushed if it cannot be shifted by 1/3 of its size. */
+    RXBUF_MODE_LINEAR           = 0,
+
+    /** Buffer is used as a ring followed by a mirror region, packets are parsed in place without shifting or flushing the buffer */
+    RXBUF_MODE_RING             = 1,
+} eRxBufMode;
+
+/** Max size of the RXBUF_MODE_RING mirror region, limits the largest packet that can wrap around the end of the ring */
+#define IS_COMM_RING_MIRROR_SIZE    PKT_BUF_SIZE
+
 typedef enum
 {
     ENABLE_PROTOCOL_ISB         = 0x00000001,
@@ -614,6 +630,28 @@ typedef struct
 /** Pop off the packing argument, we can safely allow packing and shifting in memory at this point */
 POP_PACK
 
+/** Packet found by is_comm_parse_batch().  Data is in place in the comm receive buffer and valid until the next call to is_comm_free(). */
+typedef struct
+{
+    /** Protocol type (see protocol_type_t) */
+    protocol_type_t ptype;
+
+    /** ISB packet flags (see eISBPacketFlags), zero for other protocols */
+    uint8_t flags;
+
+    /** ISB data ID, zero for other protocols */
+    uint16_t did;
+
+    /** ISB data offset, zero for other protocols */
+    uint16_t offset;
+
+    /** Data size.  For ISB packets this is the payload data size.  For non-ISB packets (NMEA, UBX, RTCM, etc.) this is the entire packet size. */
+    uint16_t size;
+
+    /** Data location, NULL for parse errors and ISB packets without data */
+    uint8_t *ptr;
+} is_comm_pkt_desc_t;
+
 // Read parse general message handler function
 // typedef void(*pfnIsCommParseMsgHandler)(com_manager_t* cmInstance, com_manager_port_t* cmPort, is_comm_instance_t* comm, int32_t port, protocol_type_t ptype)
 // typedef protocol_type_t(*pfnIsCommParseMsgHandler)(unsigned int port, const unsigned char* msg, int msgSize);
@@ -654,10 +692,28 @@ typedef struct
 */
 void is_comm_init(is_comm_instance_t* instance, uint8_t *buffer, int bufferSize);
 
+/**
+* Init simple communications interface with the specified receive buffer mode - call this before doing anything else
+* @param instance communications instance
+* @param buffer receive buffer
+* @param bufferSize receive buffer size.  In RXBUF_MODE_RING up to IS_COMM_RING_MIRROR_SIZE bytes (at most half the buffer) are used as the mirror region.
+* @param mode receive buffer mode (see eRxBufMode)
+*/
+void is_comm_init_mode(is_comm_instance_t* instance, uint8_t *buffer, int bufferSize, eRxBufMode mode);
+
 // void is_comm_read_parse(pfnIsCommPortRead portRead, unsigned int port, is_comm_instance_t* comm);
 void is_comm_buffer_parse_messages(uint8_t *buf, uint32_t buf_size, is_comm_instance_t* comm, is_comm_callbacks_t *callbacks);
 void is_comm_port_parse_messages(pfnIsCommPortRead portRead, unsigned int port, is_comm_instance_t *comm, is_comm_callbacks_t *callbacks);
 
+/**
+* Call the callback functions for a packet in comm->rxPkt, i.e. one parsed on another thread and copied into comm
+* @param port the port the packet was received on
+* @param comm the comm instance holding the packet
+* @param ptype the packet protocol type
+* @param callbacks the callback functions
+*/
+void is_comm_dispatch_packet(unsigned int port, is_comm_instance_t* comm, protocol_type_t ptype, is_comm_callbacks_t *callbacks);
+
 /**
 * Decode packet data - when data is available, return value will be the protocol type (see protocol_type_t) and the comm instance dataPtr will point to the start of the valid data.  For Inertial Sense binary protocol, comm instance dataHdr contains the data ID (DID), size, and offset.
 * @param instance the comm instance passed to is_comm_init
@@ -757,6 +813,23 @@ static inline protocol_type_t is_comm_parse(is_comm_instance_t* instance)
     return is_comm_parse_timeout(instance, 0);
 }
 
+/**
+* Decode all packets in the comm buffer, up to maxCount, into an array of packet descriptors.  Use in place of the is_comm_parse() loop to
+* process the packets from a read in a batch.  Parse errors are included as _PTYPE_PARSE_ERROR descriptors.  Only the last packet is left in 
+* rxPkt and ackNeeded, so use is_comm_parse() where acknowledges must be sent.
+* @param instance the comm instance passed to is_comm_init
+* @param desc array of packet descriptors to fill
+* @param maxCount size of desc array.  If full, call again before is_comm_free() to get the remaining packets.
+* @param timeMs current time in milliseconds used for paser timeout (see is_comm_parse_timeout())
+* @return number of descriptors filled, zero when no more packets are available
+*/
+int is_comm_parse_batch_timeout(is_comm_instance_t* instance, is_comm_pkt_desc_t *desc, int maxCount, uint32_t timeMs);
+
+static inline int is_comm_parse_batch(is_comm_instance_t* instance, is_comm_pkt_desc_t *desc, int maxCount)
+{
+    return is_comm_parse_batch_timeout(instance, desc, maxCount, 0);
+}
+
 /**
  * @brief Generate InertialSense binary (ISB) packet.
  * @param buf Buffer to write to.
@@ -786,6 +859,7 @@ int is_comm_write_pkt(pfnIsCommPortWrite portWrite, unsigned int port, is_comm_i
 
 /**
  * Removed old data and shift unparsed data to the the buffer start if running out of space at the buffer end.  Returns number of bytes available in the bufer.
+ * In RXBUF_MODE_RING, parsed data is released and the unparsed bytes of a packet that wrapped into the mirror region are moved back to the start of the ring.
  * @param instance the comm instance passed to is_comm_init
  * @return the number of bytes available in the comm buffer 
  */
@@ -892,6 +966,9 @@ static inline int is_comm_stop_broadcasts_current_ports(pfnIsCommPortWrite portW
  */
 uint16_t is_comm_fletcher16(uint16_t cksum_init, const void* data, uint32_t size);
 
+/** Byte at a time reference implementation of is_comm_fletcher16(), which is vectorized (SSE2/AVX2) when available */
+uint16_t is_comm_fletcher16_ref(uint16_t cksum_init, const void* data, uint32_t size);
+
 /**
  * @brief Compute the xor 16 bit checksum for the given data array.
  * @param cksum_init initial value for the checksum.
@@ -930,6 +1007,9 @@ void is_comm_encode_hdr(packet_t *pkt, uint8_t flags, uint16_t did, uint16_t dat
 int is_comm_write_isb_precomp_to_port(pfnIsCommPortWrite portWrite, unsigned int port, is_comm_instance_t* comm, packet_t *pkt);
 
 unsigned int calculate24BitCRCQ(unsigned char* buffer, unsigned int len);
+
+/** Byte at a time reference implementation of calculate24BitCRCQ(), which uses slice-by-8 tables when not embedded */
+unsigned int calculate24BitCRCQ_ref(unsigned char* buffer, unsigned int len);
 unsigned int getBitsAsUInt32(const unsigned char* buffer, unsigned int pos, unsigned int len);
 
 int validateBaudRate(unsigned int baudRate);
@@ -2717,6 +2717,90 @@ const char* const cISDataMappings::m_dataIdNames[] =
 };
 
 
+// FNV-1a hash of a name, the seed selects one of a family of hash functions
+static inline uint32_t nameHash(const char* name, size_t length, uint32_t seed, bool nocase)
+{
+    uint32_t hash = 2166136261u ^ (seed * 0x9E3779B1u);
+    for (size_t i = 0; i < length; i++)
+    {
+        uint8_t c = (uint8_t)name[i];
+        hash = (hash ^ (nocase ? g_asciiToLowerMap[c] : c)) * 16777619u;
+    }
+    return hash ^ (hash >> 16);
+}
+
+static inline bool nameEqual(const char* name1, size_t length1, const std::string& name2, bool nocase)
+{
+    if (length1 != name2.size())
+    {
+        return false;
+    }
+    if (!nocase)
+    {
+        return memcmp(name1, name2.c_str(), length1) == 0;
+    }
+    for (size_t i = 0; i < length1; i++)
+    {
+        if (g_asciiToLowerMap[(uint8_t)name1[i]] != g_asciiToLowerMap[(uint8_t)name2[i]])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Search for a seed that maps every name to its own slot, growing the table if needed.  Duplicate names keep the first entry.
+static void buildNameIndex(name_hash_index_t& index, const vector<string>& names, bool nocase)
+{
+    index.slots.clear();
+    index.seed = 0;
+    index.mask = 0;
+    if (names.empty() || names.size() >= UINT16_MAX)
+    {
+        return;
+    }
+
+    uint32_t size = 4;
+    while (size < 2 * names.size())
+    {
+        size <<= 1;
+    }
+    vector<uint16_t> slots;
+    for (uint32_t maxSize = size * 8; size <= maxSize; size <<= 1)
+    {
+        for (uint32_t seed = 0; seed < 256; seed++)
+        {
+            slots.assign(size, UINT16_MAX);
+            bool collision = false;
+            for (size_t i = 0; i < names.size() && !collision; i++)
+            {
+                uint16_t& slot = slots[nameHash(names[i].c_str(), names[i].size(), seed, nocase) & (size - 1)];
+                if (slot == UINT16_MAX)
+                {
+                    slot = (uint16_t)i;
+                }
+                else
+                {
+                    collision = !nameEqual(names[i].c_str(), names[i].size(), names[slot], nocase);
+                }
+            }
+            if (!collision)
+            {
+                index.slots.swap(slots);
+                index.seed = seed;
+                index.mask = size - 1;
+                return;
+            }
+        }
+    }
+}
+
+// Returns the only entry index a name can match, or UINT16_MAX if none.  The caller compares the name.
+static inline uint16_t findNameSlot(const name_hash_index_t& index, const char* name, size_t length, bool nocase)
+{
+    return index.slots[nameHash(name, length, index.seed, nocase) & index.mask];
+}
+
 cISDataMappings::cISDataMappings()
 {
     PopulateSizeMappings(m_lookupSize);
@@ -2819,10 +2903,24 @@ cISDataMappings::cISDataMappings()
 #endif
 
     // this mustcome last
+    vector<string> names;
     for (uint32_t id = 0; id < DID_COUNT; id++)
     {
         PopulateTimestampField(id, m_timestampFields, m_lookupInfo);
+
+        // flat field table and name index
+        data_field_table_t& table = m_fieldTables[id];
+        names.clear();
+        for (map_name_to_info_t::const_iterator it = m_lookupInfo[id].begin(); it != m_lookupInfo[id].end(); it++)
+        {
+            table.fields.push_back(it->second);
+            names.push_back(it->second.name);
+        }
+        buildNameIndex(table.index, names, true);
     }
+
+    names.assign(m_dataIdNames, m_dataIdNames + DID_COUNT);
+    buildNameIndex(m_dataIdIndex, names, false);
 }
 
 
@@ -2843,9 +2941,28 @@ const char* cISDataMappings::GetDataSetName(uint32_t dataId)
 }
 
 
-uint32_t cISDataMappings::GetDataSetId(string name)
+uint32_t cISDataMappings::GetDataSetId(const string& name)
 {
-//     transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+#if PLATFORM_IS_EMBEDDED
+
+    if (s_map == NULLPTR)
+    {
+        s_map = new cISDataMappings();
+    }
+    const name_hash_index_t& index = s_map->m_dataIdIndex;
+
+#else
+
+    const name_hash_index_t& index = s_map.m_dataIdIndex;
+
+#endif
+
+    if (index.slots.size())
+    {
+        uint16_t id = findNameSlot(index, name.c_str(), name.size(), false);
+        return (id != UINT16_MAX && strcmp(name.c_str(), m_dataIdNames[id]) == 0 ? id : 0);
+    }
 
     for (eDataIDs id = 0; id < DID_COUNT; id++)
     {
@@ -2889,6 +3006,71 @@ const map_name_to_info_t* cISDataMappings::GetMapInfo(uint32_t dataId)
 }
 
 
+const data_info_t* cISDataMappings::GetFields(uint32_t dataId, uint32_t& count)
+{
+    count = 0;
+    if (dataId >= DID_COUNT)
+    {
+        return NULLPTR;
+    }
+
+#if PLATFORM_IS_EMBEDDED
+
+    if (s_map == NULLPTR)
+    {
+        s_map = new cISDataMappings();
+    }
+    const data_field_table_t& table = s_map->m_fieldTables[dataId];
+
+#else
+
+    const data_field_table_t& table = s_map.m_fieldTables[dataId];
+
+#endif
+
+    count = (uint32_t)table.fields.size();
+    return table.fields.data();
+}
+
+
+const data_info_t* cISDataMappings::GetFieldInfo(uint32_t dataId, const char* name, size_t nameLength)
+{
+    if (dataId >= DID_COUNT)
+    {
+        return NULLPTR;
+    }
+
+#if PLATFORM_IS_EMBEDDED
+
+    if (s_map == NULLPTR)
+    {
+        s_map = new cISDataMappings();
+    }
+    const data_field_table_t& table = s_map->m_fieldTables[dataId];
+
+#else
+
+    const data_field_table_t& table = s_map.m_fieldTables[dataId];
+
+#endif
+
+    if (table.index.slots.size())
+    {
+        uint16_t i = findNameSlot(table.index, name, nameLength, true);
+        return (i != UINT16_MAX && nameEqual(name, nameLength, table.fields[i].name, true) ? &table.fields[i] : NULLPTR);
+    }
+
+    for (const data_info_t& field : table.fields)
+    {
+        if (nameEqual(name, nameLength, field.name, true))
+        {
+            return &field;
+        }
+    }
+    return NULLPTR;
+}
+
+
 uint32_t cISDataMappings::GetSize(uint32_t dataId)
 {
 
@@ -15,6 +15,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <string>
 #include <map>
+#include <vector>
 #include <inttypes.h>
 #include "com_manager.h"
 #include "DataCSV.h"
@@ -137,6 +138,27 @@ struct equal_to<std::string> : public unary_function<std::string, bool>
 typedef std::map<std::string, data_info_t, sCaseInsensitiveCompare> map_name_to_info_t;
 typedef char data_mapping_string_t[IS_DATA_MAPPING_MAX_STRING_LENGTH];
 
+/**
+* Perfect hash index of names.  Each name hashes to its own slot for the selected seed,
+* so a lookup is one hash and one compare.
+*/
+typedef struct
+{
+	/** Hash slot to entry index, UINT16_MAX if unused.  Empty if no perfect hash was found. */
+	std::vector<uint16_t> slots;
+	uint32_t seed;
+	uint32_t mask;
+} name_hash_index_t;
+
+/**
+* Flat field table for a data set, sorted by case-insensitive name (the same order as map_name_to_info_t)
+*/
+typedef struct
+{
+	std::vector<data_info_t> fields;
+	name_hash_index_t index;
+} data_field_table_t;
+
 class cISDataMappings
 {
 public:
@@ -157,7 +179,7 @@ public:
 	* @param dataId the data id to get a data set name from
 	* @return data set name or NULL if not found
 	*/
-	static uint32_t GetDataSetId(std::string name);
+	static uint32_t GetDataSetId(const std::string& name);
 
 	/**
 	* Get the info for a data id
@@ -165,6 +187,24 @@ public:
 	*/
 	static const map_name_to_info_t* GetMapInfo(uint32_t dataId);
 
+	/**
+	* Get the fields of a data set as a flat array, in the same order as GetMapInfo
+	* @param dataId the data id
+	* @param count receives the number of fields
+	* @return the fields, or NULL if dataId is out of range or the data set has no fields
+	*/
+	static const data_info_t* GetFields(uint32_t dataId, uint32_t& count);
+
+	/**
+	* Find a field by case-insensitive name
+	* @param dataId the data id
+	* @param name the field name, need not be null terminated
+	* @param nameLength the number of chars in name
+	* @return the field info, or NULL if not found
+	*/
+	static const data_info_t* GetFieldInfo(uint32_t dataId, const char* name, size_t nameLength);
+	static const data_info_t* GetFieldInfo(uint32_t dataId, const std::string& name) { return GetFieldInfo(dataId, name.c_str(), name.size()); }
+
 	/**
 	* Get the size of a given data id
 	* @param dataId the data id
@@ -252,6 +292,8 @@ private:
 	uint32_t m_lookupSize[DID_COUNT];
 	const data_info_t* m_timestampFields[DID_COUNT];
 	map_name_to_info_t m_lookupInfo[DID_COUNT];
+	data_field_table_t m_fieldTables[DID_COUNT];
+	name_hash_index_t m_dataIdIndex;
 
     #define PROTECT_UNALIGNED_ASSIGNS
     template<typename T>
@@ -0,0 +1,199 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+#include <algorithm>
+
+#include "ISLogChunkIndex.h"
+#include "ISLogFileFactory.h"
+
+using namespace std;
+
+void cLogChunkIndex::Clear()
+{
+	m_entries.clear();
+	m_dids.clear();
+	memset(m_buildCount, 0, sizeof(m_buildCount));
+	m_buildIds.clear();
+	m_buildTimeMin = 0.0;
+	m_buildTimeMax = 0.0;
+}
+
+void cLogChunkIndex::AddPacket(uint16_t id, double timestamp)
+{
+	if (id >= _ARRAY_ELEMENT_COUNT(m_buildCount))
+	{
+		return;
+	}
+
+	if (m_buildCount[id]++ == 0)
+	{
+		m_buildIds.push_back(id);
+	}
+	else if (m_buildCount[id] == 0)
+	{	// Saturate
+		m_buildCount[id] = UINT16_MAX;
+	}
+
+	if (timestamp != 0.0)
+	{
+		if (m_buildTimeMin == 0.0 || timestamp < m_buildTimeMin)
+		{
+			m_buildTimeMin = timestamp;
+		}
+		if (m_buildTimeMax == 0.0 || timestamp > m_buildTimeMax)
+		{
+			m_buildTimeMax = timestamp;
+		}
+	}
+}
+
+void cLogChunkIndex::EndChunk(uint64_t offset, uint32_t dataSize)
+{
+	chunk_t c;
+	c.entry.offset = offset;
+	c.entry.dataSize = dataSize;
+	c.entry.timeMin = m_buildTimeMin;
+	c.entry.timeMax = m_buildTimeMax;
+	c.entry.didCount = (uint16_t)m_buildIds.size();
+	c.didStart = (uint32_t)m_dids.size();
+	m_entries.push_back(c);
+
+	sort(m_buildIds.begin(), m_buildIds.end());
+	for (uint16_t id : m_buildIds)
+	{
+		log_chunk_index_did_t d = { id, m_buildCount[id] };
+		m_dids.push_back(d);
+		m_buildCount[id] = 0;
+	}
+	m_buildIds.clear();
+	m_buildTimeMin = 0.0;
+	m_buildTimeMax = 0.0;
+}
+
+bool cLogChunkIndex::Write(const string& indexFileName)
+{
+	cISLogFileBase* file = CreateISLogFile(indexFileName, "wb");
+	if (file == NULLPTR || !file->isOpened())
+	{
+		CloseISLogFile(file);
+		return false;
+	}
+
+	log_chunk_index_hdr_t hdr = {};
+	hdr.marker = LOG_CHUNK_INDEX_MARKER;
+	hdr.version = LOG_CHUNK_INDEX_VERSION;
+	hdr.chunkCount = (uint32_t)m_entries.size();
+	file->write(&hdr, sizeof(hdr));
+	for (chunk_t& c : m_entries)
+	{
+		file->write(&c.entry, sizeof(c.entry));
+		file->write(&m_dids[c.didStart], c.entry.didCount * sizeof(log_chunk_index_did_t));
+	}
+
+	bool good = file->good();
+	CloseISLogFile(file);
+	return good;
+}
+
+bool cLogChunkIndex::Read(const string& indexFileName)
+{
+	Clear();
+
+	cISLogFileBase* file = CreateISLogFile(indexFileName, "rb");
+	if (file == NULLPTR || !file->isOpened())
+	{
+		CloseISLogFile(file);
+		return false;
+	}
+
+	log_chunk_index_hdr_t hdr;
+	bool good = (file->read(&hdr, sizeof(hdr)) == sizeof(hdr)) &&
+		hdr.marker == LOG_CHUNK_INDEX_MARKER &&
+		hdr.version == LOG_CHUNK_INDEX_VERSION;
+	for (uint32_t i = 0; good && i < hdr.chunkCount; i++)
+	{
+		chunk_t c;
+		good = (file->read(&c.entry, sizeof(c.entry)) == sizeof(c.entry));
+		if (good)
+		{
+			c.didStart = (uint32_t)m_dids.size();
+			m_dids.resize(m_dids.size() + c.entry.didCount);
+			size_t size = c.entry.didCount * sizeof(log_chunk_index_did_t);
+			good = (file->read(&m_dids[c.didStart], size) == size);
+			m_entries.push_back(c);
+		}
+	}
+	CloseISLogFile(file);
+
+	if (!good)
+	{	// Incomplete or not an index
+		Clear();
+	}
+	return good;
+}
+
+uint32_t cLogChunkIndex::DidCount(size_t chunk, uint16_t id)
+{
+	const chunk_t& c = m_entries[chunk];
+	for (uint32_t i = c.didStart; i < c.didStart + c.entry.didCount; i++)
+	{
+		if (m_dids[i].id == id)
+		{
+			return m_dids[i].count;
+		}
+	}
+	return 0;
+}
+
+int cLogChunkIndex::FindTime(double timestamp)
+{
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].entry.timeMax >= timestamp && m_entries[i].entry.timeMax != 0.0)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+int cLogChunkIndex::FindNext(uint64_t offset, const vector<uint8_t>& didFilter)
+{
+	// Chunks are in file order
+	size_t i = lower_bound(m_entries.begin(), m_entries.end(), offset, 
+		[](const chunk_t& c, uint64_t off) { return c.entry.offset < off; }) - m_entries.begin();
+
+	for (; i < m_entries.size(); i++)
+	{
+		const chunk_t& c = m_entries[i];
+		for (uint32_t d = c.didStart; d < c.didStart + c.entry.didCount; d++)
+		{
+			if (m_dids[d].id < didFilter.size() && didFilter[m_dids[d].id])
+			{
+				return (int)i;
+			}
+		}
+	}
+	return -1;
+}
+
+string cLogChunkIndex::IndexFileName(const string& logFileName)
+{
+	size_t dot = logFileName.find_last_of('.');
+	size_t slash = logFileName.find_last_of("/\\");
+	if (dot == string::npos || (slash != string::npos && dot < slash))
+	{
+		return logFileName + LOG_CHUNK_INDEX_EXTENSION;
+	}
+	return logFileName.substr(0, dot) + LOG_CHUNK_INDEX_EXTENSION;
+}
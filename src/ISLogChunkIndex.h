@@ -0,0 +1,130 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_LOG_CHUNK_INDEX_H
+#define IS_LOG_CHUNK_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ISConstants.h"
+
+#define LOG_CHUNK_INDEX_MARKER      0x58444E49      // "INDX"
+#define LOG_CHUNK_INDEX_VERSION     1
+
+// index sidecar file extension, replaces the log file extension
+#define LOG_CHUNK_INDEX_EXTENSION   ".idx"
+
+PUSH_PACK_1
+
+/** Index file header */
+typedef struct
+{
+	uint32_t	marker;				//!< LOG_CHUNK_INDEX_MARKER
+	uint16_t	version;			//!< LOG_CHUNK_INDEX_VERSION
+	uint16_t	reserved;
+	uint32_t	chunkCount;			//!< Number of chunk entries that follow
+} log_chunk_index_hdr_t;
+
+/** Index file chunk entry, followed by didCount log_chunk_index_did_t */
+typedef struct
+{
+	uint64_t	offset;				//!< File offset of the chunk header
+	uint32_t	dataSize;			//!< Chunk data size, excluding the chunk header
+	double		timeMin;			//!< Earliest packet timestamp (cISDataMappings::GetTimestamp), zero if none
+	double		timeMax;			//!< Latest packet timestamp, zero if none
+	uint16_t	didCount;			//!< Number of DIDs in the chunk
+} log_chunk_index_entry_t;
+
+/** Number of packets of one DID in a chunk */
+typedef struct
+{
+	uint16_t	id;
+	uint16_t	count;
+} log_chunk_index_did_t;
+
+POP_PACK
+
+/**
+* Index of the chunks in one .dat log file, stored in a sidecar file next to the log.  Built while writing the log
+* and used when reading to seek to a time or skip chunks without the DIDs of interest.
+*/
+class cLogChunkIndex
+{
+public:
+	cLogChunkIndex() { Clear(); }
+
+	void Clear();
+
+	/**
+	* Add a packet to the chunk being built
+	* @param id packet DID
+	* @param timestamp packet timestamp, zero if the DID has no timestamp
+	*/
+	void AddPacket(uint16_t id, double timestamp);
+
+	/**
+	* Finish the chunk being built once it is written to the log file
+	* @param offset file offset of the chunk header
+	* @param dataSize chunk data size
+	*/
+	void EndChunk(uint64_t offset, uint32_t dataSize);
+
+	bool Write(const std::string& indexFileName);
+	bool Read(const std::string& indexFileName);
+
+	size_t Count() { return m_entries.size(); }
+	const log_chunk_index_entry_t& Entry(size_t chunk) { return m_entries[chunk].entry; }
+
+	/**
+	* Number of packets of a DID in a chunk
+	*/
+	uint32_t DidCount(size_t chunk, uint16_t id);
+
+	/**
+	* Find the first chunk with a packet at or after a time
+	* @return chunk number or -1 if none
+	*/
+	int FindTime(double timestamp);
+
+	/**
+	* Find the first chunk at or after a file offset that has any of a set of DIDs
+	* @param offset file offset
+	* @param didFilter non-zero for each wanted DID, indexed by DID
+	* @return chunk number or -1 if none
+	*/
+	int FindNext(uint64_t offset, const std::vector<uint8_t>& didFilter);
+
+	/**
+	* Sidecar index file name for a log file name
+	*/
+	static std::string IndexFileName(const std::string& logFileName);
+
+private:
+	typedef struct
+	{
+		log_chunk_index_entry_t entry;
+		uint32_t didStart;			// first DID of the chunk in m_dids
+	} chunk_t;
+
+	std::vector<chunk_t> m_entries;
+	std::vector<log_chunk_index_did_t> m_dids;
+
+	// chunk being built
+	uint16_t m_buildCount[256];
+	std::vector<uint16_t> m_buildIds;
+	double m_buildTimeMin;
+	double m_buildTimeMax;
+};
+
+#endif // IS_LOG_CHUNK_INDEX_H
@@ -0,0 +1,181 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISLogChunkWriter.h"
+#include "ISLogFileFactory.h"
+#include "ISUtilities.h"
+
+using namespace std;
+
+cLogChunkWriter::cLogChunkWriter(uint32_t maxChunksInFlight)
+{
+	// One chunk is always being filled by the logger
+	m_maxChunksInFlight = _MAX(maxChunksInFlight, 1);
+	for (uint32_t i = 0; i <= m_maxChunksInFlight; i++)
+	{
+		m_chunks.emplace_back(new cDataChunk());
+		m_free.push_back(m_chunks.back().get());
+	}
+	m_chunk = m_free.back();
+	m_free.pop_back();
+
+	m_thread = threadCreateAndStart(&cLogChunkWriter::WriteThread, this);
+}
+
+cLogChunkWriter::~cLogChunkWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running = false;
+	}
+	m_jobCv.notify_one();
+
+	// The I/O thread finishes all queued jobs before exiting
+	threadJoinAndFree(m_thread);
+	m_thread = NULL;
+}
+
+bool cLogChunkWriter::Write(cISLogFileBase* file)
+{
+	job_t job = { JOB_WRITE, file, m_chunk, current_timeUs() };
+	cDataChunk* next;
+	bool ok;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+		m_stats.queueDepth++;
+		m_stats.queueDepthMax = _MAX(m_stats.queueDepthMax, m_stats.queueDepth);
+		m_jobCv.notify_one();
+
+		if (m_free.empty())
+		{	// All chunks in flight, the disk is not keeping up
+			m_stats.waitCount++;
+			m_doneCv.wait(lock, [this] { return !m_free.empty(); });
+		}
+		next = m_free.back();
+		m_free.pop_back();
+
+		ok = (m_unreportedErrors == 0);
+		m_unreportedErrors = 0;
+	}
+
+	// Chunk header fields set by the logger carry over to the next chunk
+	next->m_hdr.devSerialNum = m_chunk->m_hdr.devSerialNum;
+	next->m_hdr.pHandle = m_chunk->m_hdr.pHandle;
+	m_chunk = next;
+	return ok;
+}
+
+void cLogChunkWriter::Flush(cISLogFileBase* file)
+{
+	job_t job = { JOB_FLUSH, file, NULL, current_timeUs() };
+	Queue(job);
+}
+
+void cLogChunkWriter::Close(cISLogFileBase* file)
+{
+	if (file != NULL)
+	{
+		job_t job = { JOB_CLOSE, file, NULL, current_timeUs() };
+		Queue(job);
+	}
+}
+
+void cLogChunkWriter::Drain()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCv.wait(lock, [this] { return m_jobs.empty() && !m_busy; });
+}
+
+log_chunk_writer_stats_t cLogChunkWriter::Stats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void cLogChunkWriter::Queue(const job_t& job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_jobCv.notify_one();
+}
+
+void cLogChunkWriter::DoJob(job_t& job)
+{
+	switch (job.type)
+	{
+	case JOB_WRITE:
+	{
+		uint64_t startUs = current_timeUs();
+		int32_t bytes = job.chunk->WriteToFile(job.file, 0);
+		bool good = (bytes >= 0) && job.file->good();
+		job.chunk->Clear();
+		uint64_t endUs = current_timeUs();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (good)
+		{
+			m_stats.chunkCount++;
+			m_stats.bytesWritten += bytes;
+		}
+		else
+		{
+			m_stats.writeErrorCount++;
+			m_unreportedErrors++;
+		}
+		m_stats.queueDepth--;
+		m_stats.writeTimeMaxUs = _MAX(m_stats.writeTimeMaxUs, (uint32_t)(endUs - startUs));
+		uint32_t latencyUs = (uint32_t)(endUs - job.timeUs);
+		m_stats.latencyMaxUs = _MAX(m_stats.latencyMaxUs, latencyUs);
+		m_latencySumUs += latencyUs;
+		m_stats.latencyAvgUs = (uint32_t)(m_latencySumUs / (m_stats.chunkCount + m_stats.writeErrorCount));
+		m_free.push_back(job.chunk);
+		break;
+	}
+
+	case JOB_FLUSH:
+		job.file->flush();
+		break;
+
+	case JOB_CLOSE:
+		CloseISLogFile(job.file);
+		break;
+	}
+}
+
+void cLogChunkWriter::WriteThread(void* info)
+{
+	cLogChunkWriter* w = (cLogChunkWriter*)info;
+	std::unique_lock<std::mutex> lock(w->m_mutex);
+
+	while (1)
+	{
+		w->m_jobCv.wait(lock, [w] { return !w->m_jobs.empty() || !w->m_running; });
+		if (w->m_jobs.empty())
+		{	// Stopped and all jobs done
+			break;
+		}
+
+		job_t job = w->m_jobs.front();
+		w->m_jobs.pop_front();
+		w->m_busy = true;
+		lock.unlock();
+
+		w->DoJob(job);
+
+		lock.lock();
+		w->m_busy = false;
+		w->m_doneCv.notify_all();
+	}
+}
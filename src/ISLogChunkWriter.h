@@ -0,0 +1,147 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_LOG_CHUNK_WRITER_H
+#define IS_LOG_CHUNK_WRITER_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "DataChunk.h"
+
+// default number of filled chunks that may be waiting to be written or in the middle of being written
+#define LOG_CHUNK_WRITER_DEFAULT_CHUNKS     4
+
+typedef struct
+{
+	/** Chunks written to file */
+	uint64_t chunkCount;
+
+	/** Bytes written to file, including chunk headers */
+	uint64_t bytesWritten;
+
+	/** Failed chunk writes */
+	uint32_t writeErrorCount;
+
+	/** Times the logger waited for a free chunk because the max number of chunks were in flight */
+	uint32_t waitCount;
+
+	/** Chunks currently waiting to be written or being written, and the largest number seen */
+	uint32_t queueDepth;
+	uint32_t queueDepthMax;
+
+	/** Max and average time from handing off a chunk to it being written, in microseconds */
+	uint32_t latencyMaxUs;
+	uint32_t latencyAvgUs;
+
+	/** Longest single chunk write to file, in microseconds */
+	uint32_t writeTimeMaxUs;
+} log_chunk_writer_stats_t;
+
+/**
+* Write-behind file output for cDataChunk.  The logger fills Chunk(), and Write() hands the filled chunk to an I/O
+* thread in exchange for an empty one so slow disk writes do not stall the logger.  Files are flushed and closed by
+* the I/O thread in order with the writes.  All methods except Stats() are called from the logger thread.
+*/
+class cLogChunkWriter
+{
+public:
+	/**
+	* Constructor, starts the I/O thread
+	* @param maxChunksInFlight number of filled chunks that may be queued before Write() waits for the I/O thread
+	*/
+	cLogChunkWriter(uint32_t maxChunksInFlight = LOG_CHUNK_WRITER_DEFAULT_CHUNKS);
+
+	/**
+	* Destructor, finishes all queued writes and stops the I/O thread
+	*/
+	virtual ~cLogChunkWriter();
+
+	/**
+	* The chunk to fill
+	*/
+	cDataChunk* Chunk() { return m_chunk; }
+
+	/**
+	* Queue Chunk() to be written to a file and replace it with an empty chunk, waiting for one if necessary
+	* @param file the file to write to, must stay open until passed to Close()
+	* @return false if a previously queued write failed
+	*/
+	bool Write(cISLogFileBase* file);
+
+	/**
+	* Flush a file once its queued writes are done
+	*/
+	void Flush(cISLogFileBase* file);
+
+	/**
+	* Close and delete a file (CloseISLogFile) once its queued writes are done
+	*/
+	void Close(cISLogFileBase* file);
+
+	/**
+	* Wait for all queued writes, flushes, and closes to finish
+	*/
+	void Drain();
+
+	uint32_t MaxChunksInFlight() { return m_maxChunksInFlight; }
+
+	/**
+	* Get a snapshot of the writer counters
+	*/
+	log_chunk_writer_stats_t Stats();
+
+private:
+	cLogChunkWriter(const cLogChunkWriter& copy); // Disable copy constructor
+
+	enum eJobType
+	{
+		JOB_WRITE = 0,
+		JOB_FLUSH,
+		JOB_CLOSE,
+	};
+
+	typedef struct
+	{
+		eJobType            type;
+		cISLogFileBase*     file;
+		cDataChunk*         chunk;
+		uint64_t            timeUs;
+	} job_t;
+
+	static void WriteThread(void* info);
+	void Queue(const job_t& job);
+	void DoJob(job_t& job);
+
+	uint32_t m_maxChunksInFlight;
+	std::vector<std::unique_ptr<cDataChunk>> m_chunks;
+	cDataChunk* m_chunk;
+	void* m_thread = NULL;
+
+	// shared with the I/O thread
+	std::mutex m_mutex;
+	std::condition_variable m_jobCv;            // I/O thread waits for jobs
+	std::condition_variable m_doneCv;           // logger waits for free chunks or drain
+	std::deque<job_t> m_jobs;
+	std::vector<cDataChunk*> m_free;
+	bool m_busy = false;
+	bool m_running = true;
+	uint32_t m_unreportedErrors = 0;
+	uint64_t m_latencySumUs = 0;
+	log_chunk_writer_stats_t m_stats = {};
+};
+
+#endif // IS_LOG_CHUNK_WRITER_H
@@ -0,0 +1,132 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISLogFileMapped.h"
+
+#if PLATFORM_IS_WINDOWS
+#include <windows.h>
+#elif !PLATFORM_IS_EMBEDDED
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+cISLogFileMapped::~cISLogFileMapped()
+{
+    close();
+}
+
+bool cISLogFileMapped::open(const std::string& filePath)
+{
+    close();
+
+#if PLATFORM_IS_WINDOWS
+
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_opened = true;
+    if (size.QuadPart == 0)
+    {
+        return true;
+    }
+
+    m_mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (m_mapping != NULLPTR)
+    {
+        m_data = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_COPY, 0, 0, 0);
+    }
+    if (m_data == NULLPTR)
+    {
+        close();
+        return false;
+    }
+    m_size = (std::size_t)size.QuadPart;
+    return true;
+
+#elif !PLATFORM_IS_EMBEDDED
+
+    int fd = ::open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    m_opened = true;
+    if (st.st_size == 0)
+    {
+        ::close(fd);
+        return true;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        m_opened = false;
+        return false;
+    }
+    madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+    m_data = (uint8_t*)data;
+    m_size = (std::size_t)st.st_size;
+    return true;
+
+#else
+
+    return false;
+
+#endif
+}
+
+void cISLogFileMapped::close()
+{
+#if PLATFORM_IS_WINDOWS
+    if (m_data != NULLPTR)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != NULLPTR)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = NULLPTR;
+    }
+    if (m_file != NULLPTR)
+    {
+        CloseHandle(m_file);
+        m_file = NULLPTR;
+    }
+#elif !PLATFORM_IS_EMBEDDED
+    if (m_data != NULLPTR)
+    {
+        munmap(m_data, m_size);
+    }
+#endif
+    m_data = NULLPTR;
+    m_size = 0;
+    m_opened = false;
+}
@@ -0,0 +1,55 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef _IS_SDK_IS_LOG_FILE_MAPPED_H_
+#define _IS_SDK_IS_LOG_FILE_MAPPED_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "ISConstants.h"
+
+/**
+* Read-only view of a whole log file mapped into memory, so log records can be used in place without copying
+* them into a read buffer.  Pages are copy-on-write: changes made through Data() are private and never reach the file.
+*/
+class cISLogFileMapped
+{
+public:
+    cISLogFileMapped() {}
+    ~cISLogFileMapped();
+
+    /**
+    * Map a file, closing any file already mapped.  An empty file opens with Size() of zero.
+    * @return true on success
+    */
+    bool open(const std::string& filePath);
+    void close();
+    bool isOpened() { return m_opened; }
+
+    uint8_t* data() { return m_data; }
+    std::size_t size() { return m_size; }
+
+private:
+    cISLogFileMapped(const cISLogFileMapped& copy); // Disable copy constructor
+
+    uint8_t* m_data = NULLPTR;
+    std::size_t m_size = 0;
+    bool m_opened = false;
+#if PLATFORM_IS_WINDOWS
+    void* m_file = NULLPTR;
+    void* m_mapping = NULLPTR;
+#endif
+};
+
+#endif //_IS_SDK_IS_LOG_FILE_MAPPED_H_
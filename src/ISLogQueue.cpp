@@ -0,0 +1,245 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "ISLogQueue.h"
+
+using namespace std;
+
+// records are padded so the record header is always aligned
+#define LOG_QUEUE_RECORD_ALIGN      8
+
+typedef struct
+{
+	/** Record size in bytes including this header and padding.  Zero marks unused space at the end of the buffer. */
+	uint32_t            size;
+
+	/** Packet header, followed by hdr.size bytes of data */
+	p_data_hdr_t        hdr;
+} log_queue_record_t;
+
+static inline uint32_t recordSize(uint32_t dataSize)
+{
+	return (uint32_t)((sizeof(log_queue_record_t) + dataSize + LOG_QUEUE_RECORD_ALIGN - 1) & ~(LOG_QUEUE_RECORD_ALIGN - 1));
+}
+
+void cLogQueueEvent::Signal()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_signaled = true;
+	}
+	m_cv.notify_one();
+}
+
+bool cLogQueueEvent::Wait(uint32_t timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	bool signaled = m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return m_signaled; });
+	m_signaled = false;
+	return signaled;
+}
+
+cLogPacketQueue::cLogPacketQueue(uint32_t capacity, eOverflowPolicy policy, uint32_t maxDataSize)
+{
+	// Power of two size so positions can wrap with a mask.  Two of the largest records must fit so a
+	// record always fits in an empty queue, including any skipped space at the end of the buffer.
+	uint32_t size = LOG_QUEUE_RECORD_ALIGN;
+	while (size < capacity || size < 2 * recordSize(maxDataSize))
+	{
+		size <<= 1;
+	}
+	m_buf.resize(size);
+	m_mask = size - 1;
+	m_policy = policy;
+
+	m_head = 0;
+	m_tail = 0;
+	m_popCount = 0;
+	m_wakeSignaled = false;
+	m_producerWaiting = false;
+	m_pushCount = 0;
+	m_dropCount = 0;
+	m_dropOldestCount = 0;
+	m_blockCount = 0;
+	m_highWater = 0;
+}
+
+void cLogPacketQueue::SetWakeup(cLogQueueEvent* event, uint32_t bytes, uint32_t packets)
+{
+	m_wakeEvent = event;
+	m_wakeBytes = bytes;
+	m_wakePackets = packets;
+}
+
+// Returns the position after the record or unused space at pos
+uint64_t cLogPacketQueue::Skip(uint64_t pos)
+{
+	uint32_t size = ((log_queue_record_t*)Record(pos))->size;
+	return pos + (size ? size : m_buf.size() - (pos & m_mask));
+}
+
+bool cLogPacketQueue::WaitForSpace()
+{
+	m_blockCount.fetch_add(1, std::memory_order_relaxed);
+	m_producerWaiting.store(true, std::memory_order_seq_cst);
+	if (m_wakeEvent)
+	{	// Make sure the consumer is awake to free space
+		m_wakeEvent->Signal();
+	}
+	bool signaled = m_spaceEvent.Wait(LOG_QUEUE_BLOCK_TIMEOUT_MS);
+	m_producerWaiting.store(false, std::memory_order_relaxed);
+	return signaled;
+}
+
+bool cLogPacketQueue::Push(const p_data_hdr_t& hdr, const uint8_t* data)
+{
+	uint64_t head = m_head.load(std::memory_order_relaxed);
+	uint32_t size = recordSize(hdr.size);
+	uint64_t toEnd = m_buf.size() - (head & m_mask);
+
+	// A record never wraps, the space at the end of the buffer is skipped instead
+	uint64_t needed = size + (toEnd < size ? toEnd : 0);
+
+	uint64_t tail;
+	while (m_buf.size() - (head - (tail = m_tail.load(std::memory_order_acquire))) < needed)
+	{
+		switch (m_policy)
+		{
+		default:
+		case OVERFLOW_DROP_NEWEST:
+			m_dropCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+
+		case OVERFLOW_DROP_OLDEST:
+			// Reclaim the oldest record.  Fails if the consumer popped it first, in which case just re-check.
+			if (m_tail.compare_exchange_strong(tail, Skip(tail), std::memory_order_acq_rel) &&
+				((log_queue_record_t*)Record(tail))->size)
+			{
+				m_dropCount.fetch_add(1, std::memory_order_relaxed);
+				m_dropOldestCount.fetch_add(1, std::memory_order_relaxed);
+			}
+			break;
+
+		case OVERFLOW_BLOCK:
+			if (!WaitForSpace() && m_buf.size() - (head - m_tail.load(std::memory_order_acquire)) < needed)
+			{	// Timed out
+				m_dropCount.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			break;
+		}
+	}
+
+	// Writes below must not be seen before a reclaimed record is released by the tail update above
+	std::atomic_thread_fence(std::memory_order_release);
+
+	if (toEnd < size)
+	{	// Mark end of buffer as unused
+		((log_queue_record_t*)Record(head))->size = 0;
+		head += toEnd;
+	}
+
+	log_queue_record_t* rec = (log_queue_record_t*)Record(head);
+	rec->size = size;
+	rec->hdr = hdr;
+	memcpy((uint8_t*)rec + sizeof(log_queue_record_t), data, hdr.size);
+	head += size;
+	m_head.store(head, std::memory_order_release);
+	m_pushCount.fetch_add(1, std::memory_order_release);
+
+	uint32_t used = (uint32_t)(head - tail);
+	if (used > m_highWater.load(std::memory_order_relaxed))
+	{
+		m_highWater.store(used, std::memory_order_relaxed);
+	}
+
+	if (m_wakeEvent && (used >= m_wakeBytes || Count() >= m_wakePackets) && 
+		!m_wakeSignaled.exchange(true, std::memory_order_acq_rel))
+	{	// Threshold reached, wake the consumer once until it empties the queue
+		m_wakeEvent->Signal();
+	}
+	return true;
+}
+
+p_data_hdr_t* cLogPacketQueue::Front(const uint8_t** data)
+{
+	while (1)
+	{
+		uint64_t tail = m_tail.load(std::memory_order_acquire);
+		uint64_t head = m_head.load(std::memory_order_acquire);
+		if (tail == head)
+		{	// Empty, rearm the wakeup
+			m_wakeSignaled.store(false, std::memory_order_release);
+			return NULL;
+		}
+
+		log_queue_record_t* rec = (log_queue_record_t*)Record(tail);
+		if (rec->size == 0)
+		{	// Skip unused space at end of buffer
+			m_tail.compare_exchange_strong(tail, Skip(tail), std::memory_order_acq_rel);
+			continue;
+		}
+
+		m_frontPos = tail;
+		if (m_policy != OVERFLOW_DROP_OLDEST)
+		{	// In place
+			*data = (const uint8_t*)rec + sizeof(log_queue_record_t);
+			return &rec->hdr;
+		}
+
+		// Copy out, then make sure the producer did not reclaim the record while it was being read
+		m_frontCopy.hdr = rec->hdr;
+		if (m_frontCopy.hdr.size <= MAX_DATASET_SIZE)
+		{
+			memcpy(m_frontCopy.buf, (uint8_t*)rec + sizeof(log_queue_record_t), m_frontCopy.hdr.size);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (m_tail.load(std::memory_order_relaxed) == tail)
+		{
+			*data = m_frontCopy.buf;
+			return &m_frontCopy.hdr;
+		}
+	}
+}
+
+void cLogPacketQueue::Pop()
+{
+	uint64_t tail = m_frontPos;
+	if (tail == m_head.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	// Fails only if the producer already dropped this record (OVERFLOW_DROP_OLDEST)
+	if (m_tail.compare_exchange_strong(tail, Skip(tail), std::memory_order_acq_rel))
+	{
+		m_popCount.fetch_add(1, std::memory_order_release);
+	}
+
+	if (m_producerWaiting.load(std::memory_order_seq_cst))
+	{
+		m_spaceEvent.Signal();
+	}
+}
+
+log_queue_stats_t cLogPacketQueue::Stats() const
+{
+	log_queue_stats_t stats;
+	stats.pushCount = m_pushCount.load(std::memory_order_relaxed);
+	stats.dropCount = m_dropCount.load(std::memory_order_relaxed);
+	stats.blockCount = m_blockCount.load(std::memory_order_relaxed);
+	stats.highWaterBytes = m_highWater.load(std::memory_order_relaxed);
+	stats.capacityBytes = Capacity();
+	return stats;
+}
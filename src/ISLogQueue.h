@@ -0,0 +1,190 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_LOG_QUEUE_H
+#define IS_LOG_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "ISComm.h"
+
+// default per device log queue size in bytes (rounded up to a power of two)
+#define LOG_QUEUE_DEFAULT_SIZE      (1024 * 1024)
+
+// default thresholds at which the producer wakes the logger thread
+#define LOG_QUEUE_WAKE_BYTES        (8 * 1024)
+#define LOG_QUEUE_WAKE_PACKETS      32
+
+// max time the logger thread sleeps without a wakeup, bounds latency at low data rates
+#define LOG_QUEUE_WAKE_TIMEOUT_MS   20
+
+// max time the producer waits for space in OVERFLOW_BLOCK mode before dropping the packet
+#define LOG_QUEUE_BLOCK_TIMEOUT_MS  1000
+
+typedef struct
+{
+	/** Number of packets added to the queue */
+	uint64_t pushCount;
+
+	/** Number of packets dropped because the queue was full */
+	uint64_t dropCount;
+
+	/** Number of times the producer waited for space (OVERFLOW_BLOCK) */
+	uint64_t blockCount;
+
+	/** Largest number of bytes held in the queue */
+	uint32_t highWaterBytes;
+
+	/** Size of the queue in bytes */
+	uint32_t capacityBytes;
+} log_queue_stats_t;
+
+/**
+* Auto-reset event used to wake a waiting thread
+*/
+class cLogQueueEvent
+{
+public:
+	/**
+	* Wake the waiting thread, or the next call to Wait() if none is waiting
+	*/
+	void Signal();
+
+	/**
+	* Wait for Signal()
+	* @param timeoutMs max time to wait in milliseconds
+	* @return true if signaled, false on timeout
+	*/
+	bool Wait(uint32_t timeoutMs);
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_signaled = false;
+};
+
+/**
+* Lock-free single producer / single consumer queue of variable length data packets.
+* Each record holds the packet header followed by only hdr.size bytes of data.  Push()
+* is called from the receive thread, Front() and Pop() from the logger thread.
+*/
+class cLogPacketQueue
+{
+public:
+	/** What Push() does when the queue is full */
+	enum eOverflowPolicy
+	{
+		OVERFLOW_DROP_NEWEST = 0,	// drop the packet being pushed, never blocks
+		OVERFLOW_DROP_OLDEST,		// drop the oldest packets to make room, never blocks
+		OVERFLOW_BLOCK,				// wait for the consumer, up to LOG_QUEUE_BLOCK_TIMEOUT_MS
+	};
+
+	/**
+	* Constructor
+	* @param capacity the queue size in bytes, rounded up to a power of two
+	* @param policy what to do when the queue is full
+	* @param maxDataSize the largest data size pushed, the queue is made large enough for two such records
+	*/
+	cLogPacketQueue(uint32_t capacity = LOG_QUEUE_DEFAULT_SIZE, eOverflowPolicy policy = OVERFLOW_DROP_NEWEST, uint32_t maxDataSize = MAX_DATASET_SIZE);
+
+	/**
+	* Signal an event when the queue reaches a byte or packet count.  The event is signaled
+	* once and rearmed when the consumer empties the queue.
+	* @param event the event to signal, NULL to disable
+	* @param bytes byte count threshold
+	* @param packets packet count threshold
+	*/
+	void SetWakeup(cLogQueueEvent* event, uint32_t bytes = LOG_QUEUE_WAKE_BYTES, uint32_t packets = LOG_QUEUE_WAKE_PACKETS);
+
+	/**
+	* Add a packet to the queue (producer)
+	* @param hdr the packet header, hdr.size bytes are copied from data
+	* @param data the packet data
+	* @return true if queued, false if the queue is full and the packet was dropped
+	*/
+	bool Push(const p_data_hdr_t& hdr, const uint8_t* data);
+
+	/**
+	* Get the oldest packet in the queue without removing it (consumer).  The data is in place
+	* in the queue, except for OVERFLOW_DROP_OLDEST where it is copied out as the producer may
+	* reclaim the record at any time.
+	* @param data set to the packet data
+	* @return the packet header or NULL if the queue is empty
+	*/
+	p_data_hdr_t* Front(const uint8_t** data);
+
+	/**
+	* Remove the packet returned by Front() (consumer)
+	*/
+	void Pop();
+
+	/**
+	* Number of bytes currently held in the queue
+	*/
+	uint32_t Size() const { uint64_t tail = m_tail.load(std::memory_order_acquire); return (uint32_t)(m_head.load(std::memory_order_acquire) - tail); }
+
+	bool Empty() const { return Size() == 0; }
+
+	/**
+	* Number of packets currently held in the queue
+	*/
+	uint32_t Count() const { uint64_t removed = m_popCount.load(std::memory_order_acquire) + m_dropOldestCount.load(std::memory_order_acquire); return (uint32_t)(m_pushCount.load(std::memory_order_acquire) - removed); }
+
+	eOverflowPolicy Policy() const { return m_policy; }
+
+	uint32_t Capacity() const { return (uint32_t)m_buf.size(); }
+
+	/**
+	* Get a snapshot of the queue counters
+	*/
+	log_queue_stats_t Stats() const;
+
+private:
+	uint8_t* Record(uint64_t pos) { return &m_buf[pos & m_mask]; }
+	uint64_t Skip(uint64_t pos);
+	bool WaitForSpace();
+
+	std::vector<uint8_t> m_buf;
+	uint64_t m_mask;
+	eOverflowPolicy m_policy;
+
+	// producer and consumer positions are kept on separate cache lines
+	alignas(64) std::atomic<uint64_t> m_head;       // write position, only modified by the producer
+	alignas(64) std::atomic<uint64_t> m_tail;       // read position, modified by the consumer (and producer in OVERFLOW_DROP_OLDEST)
+
+	// consumer state
+	alignas(64) uint64_t m_frontPos = 0;            // position of record returned by Front()
+	p_data_buf_t m_frontCopy;                       // OVERFLOW_DROP_OLDEST copy of record returned by Front()
+	std::atomic<uint64_t> m_popCount;
+
+	// producer wakeup of consumer
+	alignas(64) cLogQueueEvent* m_wakeEvent = NULL;
+	uint32_t m_wakeBytes = LOG_QUEUE_WAKE_BYTES;
+	uint32_t m_wakePackets = LOG_QUEUE_WAKE_PACKETS;
+	std::atomic<bool> m_wakeSignaled;
+
+	// consumer wakeup of producer (OVERFLOW_BLOCK)
+	cLogQueueEvent m_spaceEvent;
+	std::atomic<bool> m_producerWaiting;
+
+	std::atomic<uint64_t> m_pushCount;
+	std::atomic<uint64_t> m_dropCount;
+	std::atomic<uint64_t> m_dropOldestCount;
+	std::atomic<uint64_t> m_blockCount;
+	std::atomic<uint32_t> m_highWater;
+};
+
+#endif // IS_LOG_QUEUE_H
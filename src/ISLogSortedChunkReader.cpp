@@ -0,0 +1,297 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+
+#include "ISLogSortedChunkReader.h"
+#include "ISLogFileFactory.h"
+#include "ISUtilities.h"
+
+using namespace std;
+
+cLogSortedChunkReader::cLogSortedChunkReader(const vector<string>& fileNames, bool async)
+{
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		cISLogFileBase* file = CreateISLogFile(fileNames[i], "rb");
+		if (file != NULL)
+		{
+			m_files.push_back(file);
+			m_filePos.push_back(0);
+		}
+	}
+
+#if PLATFORM_IS_EMBEDDED
+	(void)async;
+	m_async = false;
+#else
+	m_async = async;
+#endif
+}
+
+cLogSortedChunkReader::~cLogSortedChunkReader()
+{
+	if (m_thread != NULL)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_running = false;
+			m_jobs.clear();
+		}
+		m_jobCv.notify_one();
+		threadJoinAndFree(m_thread);
+		m_thread = NULL;
+	}
+
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		CloseISLogFile(m_files[i]);
+	}
+}
+
+bool cLogSortedChunkReader::SeekFile(uint32_t fileIndex, long int offset, log_chunk_read_stats_t& stats)
+{
+	if (m_filePos[fileIndex] == offset)
+	{
+		return true;
+	}
+	stats.seekCount++;
+	if (m_files[fileIndex]->seek(offset) != 0)
+	{
+		m_filePos[fileIndex] = -1;
+		return false;
+	}
+	m_filePos[fileIndex] = offset;
+	return true;
+}
+
+bool cLogSortedChunkReader::Index(vector<vector<log_chunk_location_t>>& index)
+{
+	index.clear();
+	index.resize(DID_COUNT);
+	if (m_files.empty())
+	{
+		return false;
+	}
+
+	log_chunk_read_stats_t stats = {};
+	for (uint32_t f = 0; f < m_files.size(); f++)
+	{
+		cISLogFileBase* file = m_files[f];
+		long int offset = 0;
+		while (SeekFile(f, offset, stats))
+		{
+			// Read headers and the first dataSerNum, the chunk data is skipped
+			sChunkHeader hdr;
+			sChunkSubHeader subHdr;
+			uint32_t dataSerNum;
+			size_t n = file->read(&hdr, sizeof(hdr));
+			if (n == sizeof(hdr))
+			{
+				n += file->read(&subHdr, sizeof(subHdr));
+			}
+			if (n == sizeof(hdr) + sizeof(subHdr) && hdr.dataSize >= sizeof(dataSerNum) && !(hdr.flags & DATA_CHUNK_FLAG_COMPRESSED))
+			{
+				n += file->read(&dataSerNum, sizeof(dataSerNum));
+			}
+			stats.bytesRead += n;
+			m_filePos[f] = -1;
+
+			if (n < sizeof(hdr) + sizeof(subHdr) ||
+				hdr.marker != DATA_CHUNK_MARKER ||
+				hdr.dataSize != ~(hdr.invDataSize) ||
+				hdr.grpNum != 1)
+			{	// End of file or not a sorted chunk
+				break;
+			}
+
+			log_chunk_location_t location = { f, UINT32_MAX, offset };
+			if (n == sizeof(hdr) + sizeof(subHdr) + sizeof(dataSerNum))
+			{
+				location.dataSerNum = dataSerNum;
+			}
+			else
+			{	// Compressed, read the whole chunk to get the first dataSerNum
+				cSortedDataChunk* chunk = NewChunk();
+				if (ReadChunk(chunk, location, stats))
+				{
+					location.dataSerNum = chunk->GetDataSerNum();
+				}
+				Release(chunk);
+			}
+
+			if (subHdr.dHdr.id < DID_COUNT && hdr.dataSize > 0)
+			{
+				index[subHdr.dHdr.id].push_back(location);
+			}
+			offset += sizeof(hdr) + sizeof(subHdr) + hdr.dataSize;
+		}
+	}
+
+	// Files may not be listed in the order they were written
+	for (size_t id = 0; id < index.size(); id++)
+	{
+		stable_sort(index[id].begin(), index[id].end(), [](const log_chunk_location_t& a, const log_chunk_location_t& b) { return a.dataSerNum < b.dataSerNum; });
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.seekCount += stats.seekCount;
+	m_stats.bytesRead += stats.bytesRead;
+	return true;
+}
+
+bool cLogSortedChunkReader::ReadChunk(cSortedDataChunk* chunk, const log_chunk_location_t& location, log_chunk_read_stats_t& stats)
+{
+	if (location.fileIndex >= m_files.size() || !SeekFile(location.fileIndex, location.offset, stats))
+	{
+		return false;
+	}
+
+	int32_t nBytes = chunk->ReadFromFile(m_files[location.fileIndex]);
+	if (nBytes <= 0 || chunk->m_hdr.grpNum != 1)
+	{
+		m_filePos[location.fileIndex] = -1;
+		chunk->Clear();
+		return false;
+	}
+
+	m_filePos[location.fileIndex] = location.offset + chunk->GetHeaderSize() + chunk->m_hdr.dataSize;
+	stats.bytesRead += chunk->GetHeaderSize() + chunk->m_hdr.dataSize;
+	stats.chunkCount++;
+	return true;
+}
+
+cSortedDataChunk* cLogSortedChunkReader::NewChunk()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_free.empty())
+	{
+		m_chunks.emplace_back(new cSortedDataChunk());
+		return m_chunks.back().get();
+	}
+	cSortedDataChunk* chunk = m_free.back();
+	m_free.pop_back();
+	return chunk;
+}
+
+void cLogSortedChunkReader::Release(cSortedDataChunk* chunk)
+{
+	if (chunk != NULL)
+	{
+		chunk->Clear();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_free.push_back(chunk);
+	}
+}
+
+void cLogSortedChunkReader::Done(uint32_t slot, cSortedDataChunk* chunk, bool good, const log_chunk_read_stats_t& stats)
+{
+	if (!good)
+	{
+		Release(chunk);
+		chunk = NULL;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_done[slot] = chunk;
+	m_stats.chunkCount += stats.chunkCount;
+	m_stats.seekCount += stats.seekCount;
+	m_stats.bytesRead += stats.bytesRead;
+}
+
+void cLogSortedChunkReader::Request(uint32_t slot, const log_chunk_location_t& location)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_requested.insert(slot);
+	}
+
+	if (!m_async)
+	{
+		log_chunk_read_stats_t stats = {};
+		cSortedDataChunk* chunk = NewChunk();
+		Done(slot, chunk, ReadChunk(chunk, location, stats), stats);
+		return;
+	}
+
+	if (m_thread == NULL)
+	{
+		m_thread = threadCreateAndStart(&cLogSortedChunkReader::ReadThread, this);
+	}
+
+	job_t job = { slot, location };
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs.push_back(job);
+	}
+	m_jobCv.notify_one();
+}
+
+cSortedDataChunk* cLogSortedChunkReader::Take(uint32_t slot)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_requested.erase(slot) == 0)
+	{	// Nothing requested
+		return NULL;
+	}
+
+	map<uint32_t, cSortedDataChunk*>::iterator it = m_done.find(slot);
+	if (it == m_done.end())
+	{	// The chunk is queued or being read
+		uint64_t startUs = current_timeUs();
+		m_stats.waitCount++;
+		m_doneCv.wait(lock, [this, slot] { return m_done.count(slot) != 0 || !m_running; });
+		m_stats.waitUs += current_timeUs() - startUs;
+		it = m_done.find(slot);
+		if (it == m_done.end())
+		{
+			return NULL;
+		}
+	}
+
+	cSortedDataChunk* chunk = it->second;
+	m_done.erase(it);
+	return chunk;
+}
+
+log_chunk_read_stats_t cLogSortedChunkReader::Stats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void cLogSortedChunkReader::ReadThread(void* info)
+{
+	cLogSortedChunkReader* r = (cLogSortedChunkReader*)info;
+	std::unique_lock<std::mutex> lock(r->m_mutex);
+
+	while (1)
+	{
+		r->m_jobCv.wait(lock, [r] { return !r->m_jobs.empty() || !r->m_running; });
+		if (!r->m_running)
+		{
+			break;
+		}
+
+		job_t job = r->m_jobs.front();
+		r->m_jobs.pop_front();
+		lock.unlock();
+
+		log_chunk_read_stats_t stats = {};
+		cSortedDataChunk* chunk = r->NewChunk();
+		bool good = r->ReadChunk(chunk, job.location, stats);
+		r->Done(job.slot, chunk, good, stats);
+
+		lock.lock();
+		r->m_doneCv.notify_all();
+	}
+}
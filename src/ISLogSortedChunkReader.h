@@ -0,0 +1,138 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_LOG_SORTED_CHUNK_READER_H
+#define IS_LOG_SORTED_CHUNK_READER_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include "DataChunkSorted.h"
+
+typedef struct
+{
+	/** Index into the file names */
+	uint32_t fileIndex;
+
+	/** dataSerNum of the first data in the chunk */
+	uint32_t dataSerNum;
+
+	/** File offset of the chunk header */
+	long int offset;
+} log_chunk_location_t;
+
+typedef struct
+{
+	/** Chunks read from file, not counting the chunk index scan */
+	uint64_t chunkCount;
+
+	/** File seeks, including the chunk index scan */
+	uint64_t seekCount;
+
+	/** Bytes read from file, including the chunk index scan */
+	uint64_t bytesRead;
+
+	/** Times Take() waited for a chunk that was not read yet, and the total wait time in microseconds */
+	uint64_t waitCount;
+	uint64_t waitUs;
+} log_chunk_read_stats_t;
+
+/**
+* Read-ahead file input for the sorted (.sdat) log.  Index() scans the chunk headers of all files once, then chunks are
+* read by location from an I/O thread.  Request() queues the read of a chunk for a slot (the DID) and Take() returns it,
+* so the next chunk of each DID is read while the current one is being used.  All methods except Stats() are called
+* from the reader thread.
+*/
+class cLogSortedChunkReader
+{
+public:
+	/**
+	* Constructor, opens the files
+	* @param fileNames the log files
+	* @param async read chunks from an I/O thread, otherwise Request() reads the chunk
+	*/
+	cLogSortedChunkReader(const std::vector<std::string>& fileNames, bool async = true);
+
+	/**
+	* Destructor, stops the I/O thread and closes the files
+	*/
+	virtual ~cLogSortedChunkReader();
+
+	/**
+	* Scan the chunk headers of all files, must be called before Request()
+	* @param index set to the chunk locations of each DID, ordered by dataSerNum
+	* @return false if no files could be opened
+	*/
+	bool Index(std::vector<std::vector<log_chunk_location_t>>& index);
+
+	/**
+	* Queue the read of a chunk, at most one per slot until it is returned by Take()
+	*/
+	void Request(uint32_t slot, const log_chunk_location_t& location);
+
+	/**
+	* Get the chunk requested for a slot, waiting for it to be read.  The chunk belongs to the caller until Release().
+	* @return the chunk or NULL if nothing was requested or the read failed
+	*/
+	cSortedDataChunk* Take(uint32_t slot);
+
+	/**
+	* Return a chunk from Take() so it can be reused
+	*/
+	void Release(cSortedDataChunk* chunk);
+
+	/**
+	* Get a snapshot of the reader counters
+	*/
+	log_chunk_read_stats_t Stats();
+
+private:
+	cLogSortedChunkReader(const cLogSortedChunkReader& copy); // Disable copy constructor
+
+	typedef struct
+	{
+		uint32_t                slot;
+		log_chunk_location_t    location;
+	} job_t;
+
+	static void ReadThread(void* info);
+	bool ReadChunk(cSortedDataChunk* chunk, const log_chunk_location_t& location, log_chunk_read_stats_t& stats);
+	bool SeekFile(uint32_t fileIndex, long int offset, log_chunk_read_stats_t& stats);
+	cSortedDataChunk* NewChunk();
+	void Done(uint32_t slot, cSortedDataChunk* chunk, bool good, const log_chunk_read_stats_t& stats);
+
+	std::vector<cISLogFileBase*> m_files;
+	std::vector<long int> m_filePos;            // current position of each file, -1 if unknown
+	bool m_async;
+	void* m_thread = NULL;
+
+	// shared with the I/O thread
+	std::mutex m_mutex;
+	std::condition_variable m_jobCv;            // I/O thread waits for jobs
+	std::condition_variable m_doneCv;           // reader waits for chunks
+	std::deque<job_t> m_jobs;
+	std::set<uint32_t> m_requested;                 // slots with a chunk requested and not yet taken
+	std::map<uint32_t, cSortedDataChunk*> m_done;   // read chunks by slot, NULL if the read failed
+	std::vector<std::unique_ptr<cSortedDataChunk>> m_chunks;
+	std::vector<cSortedDataChunk*> m_free;
+	bool m_running = true;
+	log_chunk_read_stats_t m_stats = {};
+};
+
+#endif // IS_LOG_SORTED_CHUNK_READER_H
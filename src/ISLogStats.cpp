@@ -58,6 +58,26 @@ void cLogStatDataId::LogTimestamp(double timestamp)
     lastTimestamp = timestamp;
 }
 
+void cLogStatDataId::Merge(const cLogStatDataId& other)
+{
+    count += other.count;
+    errorCount += other.errorCount;
+    totalTimeDelta += other.totalTimeDelta;
+    timestampDeltaCount += other.timestampDeltaCount;
+    timestampDropCount += other.timestampDropCount;
+    minTimestampDelta = _MIN(minTimestampDelta, other.minTimestampDelta);
+    maxTimestampDelta = _MAX(maxTimestampDelta, other.maxTimestampDelta);
+    if (timestampDeltaCount)
+    {
+        averageTimeDelta = totalTimeDelta / (double)timestampDeltaCount;
+    }
+    if (other.lastTimestamp > 0.0)
+    {
+        lastTimestamp = other.lastTimestamp;
+        lastTimestampDelta = other.lastTimestampDelta;
+    }
+}
+
 void cLogStatDataId::Printf()
 {
 
@@ -85,6 +105,9 @@ void cLogStats::Clear()
     }
     errorCount = 0;
     count = 0;
+    queueStats = {};
+    compressStats = {};
+    decompressStats = {};
 }
 
 void cLogStats::LogError(const p_data_hdr_t* hdr)
@@ -134,6 +157,39 @@ void cLogStats::LogDataAndTimestamp(uint32_t id, double timestamp, protocol_type
     count++;
 }
 
+void cLogStats::Merge(const cLogStats& other)
+{
+    for (auto& it : other.isbStats)     { isbStats[it.first].Merge(it.second); }
+    for (auto& it : other.nmeaStats)    { nmeaStats[it.first].Merge(it.second); }
+    for (auto& it : other.rtcm3Stats)   { rtcm3Stats[it.first].Merge(it.second); }
+    for (auto& it : other.ubloxStats)   { ubloxStats[it.first].Merge(it.second); }
+    count += other.count;
+    errorCount += other.errorCount;
+    AddCompressionStats(compressStats, other.compressStats);
+    AddCompressionStats(decompressStats, other.decompressStats);
+}
+
+void cLogStats::AddCompressionStats(chunk_compression_stats_t& stats, const chunk_compression_stats_t& other)
+{
+    stats.chunkCount += other.chunkCount;
+    stats.rawBytes += other.rawBytes;
+    stats.compressedBytes += other.compressedBytes;
+    stats.timeUs += other.timeUs;
+}
+
+static void writeCompressionStats(cISLogFileBase* file, const char* name, const chunk_compression_stats_t& stats)
+{
+    if (stats.chunkCount == 0)
+    {
+        return;
+    }
+
+    double ratio = (stats.compressedBytes ? (double)stats.rawBytes / (double)stats.compressedBytes : 0.0);
+    double rateMBps = (stats.timeUs ? (double)stats.rawBytes / (double)stats.timeUs : 0.0);
+    file->lprintf("%s chunks: %llu,   Raw: %llu bytes,   Compressed: %llu bytes,   Ratio: %.2f,   CPU time: %.1f ms (%.1f MB/s)\r\n\r\n", name,
+        (unsigned long long)stats.chunkCount, (unsigned long long)stats.rawBytes, (unsigned long long)stats.compressedBytes, ratio, stats.timeUs * 0.001, rateMBps);
+}
+
 void cLogStats::Printf()
 {
 
@@ -211,6 +267,13 @@ void cLogStats::WriteToFile(const string& file_name)
         // flush log stats to disk
         statsFile = CreateISLogFile(file_name, "wb");
         statsFile->lprintf("Total msg count: %d,   Total errors: %d\r\n\r\n", count, errorCount);
+        if (queueStats.pushCount || queueStats.dropCount)
+        {
+            statsFile->lprintf("Queue count: %llu,   Queue drops: %llu,   Queue blocks: %llu,   Queue high water: %u of %u bytes\r\n\r\n",
+                (unsigned long long)queueStats.pushCount, (unsigned long long)queueStats.dropCount, (unsigned long long)queueStats.blockCount, queueStats.highWaterBytes, queueStats.capacityBytes);
+        }
+        writeCompressionStats(statsFile, "Compressed", compressStats);
+        writeCompressionStats(statsFile, "Decompressed", decompressStats);
 
         WriteMsgStats(isbStats,   "ISB",   _PTYPE_INERTIAL_SENSE_DATA);
         WriteMsgStats(nmeaStats,  "NMEA" , _PTYPE_NMEA);
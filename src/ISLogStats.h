@@ -19,6 +19,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "data_sets.h"
 #include "ISComm.h"
+#include "ISLogQueue.h"
+#include "DataChunk.h"
 
 
 typedef void (*FuncLogDataAndTimestamp)(uint32_t dataId, double timestamp);
@@ -39,6 +41,8 @@ public:
 
 	cLogStatDataId();
 	void LogTimestamp(double timestamp);
+	// Add the counts of another, e.g. the same data id from another device
+	void Merge(const cLogStatDataId& other);
 	void Printf();
 };
 
@@ -51,6 +55,9 @@ public:
 	std::map<int, cLogStatDataId> ubloxStats;
 	uint64_t count; // count of all data ids
 	uint64_t errorCount; // total error count
+	log_queue_stats_t queueStats; // receive to logger thread queue counters, summed across devices
+	chunk_compression_stats_t compressStats; // .dat chunks compressed when writing, summed across devices
+	chunk_compression_stats_t decompressStats; // .dat chunks decompressed when reading, summed across devices
 	cISLogFileBase* statsFile;
 
 	cLogStats();
@@ -59,7 +66,10 @@ public:
 	cLogStatDataId* MsgStats(protocol_type_t ptype, uint32_t id);
 	void LogData(uint32_t id, protocol_type_t ptype=_PTYPE_INERTIAL_SENSE_DATA);
 	void LogDataAndTimestamp(uint32_t id, double timestamp, protocol_type_t ptype=_PTYPE_INERTIAL_SENSE_DATA);
+	// Add the counts of stats collected separately, e.g. by another thread
+	void Merge(const cLogStats& other);
 	void Printf();
+	static void AddCompressionStats(chunk_compression_stats_t& stats, const chunk_compression_stats_t& other);
 	void WriteMsgStats(std::map<int, cLogStatDataId> &msgStats, const char* msgName, protocol_type_t ptype=_PTYPE_NONE);
 	void WriteToFile(const std::string& fileName);
 };
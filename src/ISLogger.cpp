@@ -24,6 +24,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <set>
 #include <sstream>
 #include <mutex>
+#include <thread>
+#include <cstdarg>
 
 #include "ISFileManager.h"
 #include "ISLogger.h"
@@ -52,6 +54,7 @@ const string cISLogger::g_emptyString;
 
 #if !PLATFORM_IS_EMBEDDED
 static std::mutex g_devices_mutex;
+static std::mutex g_error_file_mutex;
 #endif
 
 bool cISLogger::isHeaderCorrupt(const p_data_hdr_t *hdr)
@@ -76,6 +79,18 @@ bool cISLogger::isDataCorrupt(const p_data_buf_t *data)
     return m_useChunkHeader && data != NULL && isHeaderCorrupt(&data->hdr);
 }
 
+void cISLogger::ErrorPrintf(const char* format, ...)
+{
+#if !PLATFORM_IS_EMBEDDED
+    // CopyLog() threads share the error file
+    const std::lock_guard<std::mutex> lock(g_error_file_mutex);
+#endif
+    va_list args;
+    va_start(args, format);
+    m_errorFile.vprintf(format, args);
+    va_end(args);
+}
+
 cISLogger::cISLogger()
 {
     m_logStats.Clear();
@@ -96,6 +111,7 @@ void cISLogger::Cleanup()
 #endif
     m_devices.clear();
     m_logStats.Clear();
+    ResetMergeRead();
 }
 
 
@@ -235,9 +251,10 @@ std::shared_ptr<cDeviceLog> cISLogger::registerDevice(ISDevice& device) {
         case LOGTYPE_CSV:   device.devLogger = make_shared<cDeviceLogCSV>(&device);     break;
         case LOGTYPE_JSON:  device.devLogger = make_shared<cDeviceLogJSON>(&device);    break;
         case LOGTYPE_KML:   device.devLogger = make_shared<cDeviceLogKML>(&device);     break;
+        case LOGTYPE_COLUMNAR: device.devLogger = make_shared<cDeviceLogColumnar>(&device); break;
 #endif
     }
-    device.devLogger->InitDeviceForWriting(m_timeStamp, m_directory, m_maxDiskSpace, m_maxFileSize);
+    InitDeviceLogForWriting(device.devLogger);
     m_devices[device.devInfo.serialNumber] = device.devLogger;
 
     return device.devLogger;
@@ -255,14 +272,27 @@ std::shared_ptr<cDeviceLog> cISLogger::registerDevice(uint16_t hdwId, uint32_t s
         case LOGTYPE_CSV:   deviceLog = make_shared<cDeviceLogCSV>(hdwId, serialNo);     break;
         case LOGTYPE_JSON:  deviceLog = make_shared<cDeviceLogJSON>(hdwId, serialNo);    break;
         case LOGTYPE_KML:   deviceLog = make_shared<cDeviceLogKML>(hdwId, serialNo);     break;
+        case LOGTYPE_COLUMNAR: deviceLog = make_shared<cDeviceLogColumnar>(hdwId, serialNo); break;
 #endif
     }
-    deviceLog->InitDeviceForWriting(m_timeStamp, m_directory, m_maxDiskSpace, m_maxFileSize);
+    InitDeviceLogForWriting(deviceLog);
     m_devices[serialNo] = deviceLog;
 
     return deviceLog;
 }
 
+void cISLogger::InitDeviceLogForWriting(const std::shared_ptr<cDeviceLog>& deviceLog) {
+    deviceLog->InitDeviceForWriting(m_timeStamp, m_directory, m_maxDiskSpace, m_maxFileSize);
+
+    cDeviceLogSerial* serialLog = dynamic_cast<cDeviceLogSerial*>(deviceLog.get());
+    if (m_asyncWriteChunks && serialLog != nullptr) {
+        serialLog->EnableAsyncWrite(m_asyncWriteChunks);
+    }
+    if (serialLog != nullptr) {
+        serialLog->EnableCompression(m_compressionLevel);
+    }
+}
+
 bool cISLogger::InitDevicesForWriting(std::vector<ISDevice>& devices)
 {
     // Remove all devices
@@ -345,7 +375,7 @@ bool cISLogger::ParseFilename(string filename, int &serialNum, string &date, str
 }
 
 
-bool cISLogger::LoadFromDirectory(const string &directory, eLogType logType, vector<string> serials)
+bool cISLogger::LoadFromDirectory(const string &directory, eLogType logType, vector<string> serials, eReadMode readMode)
 {
     // Delete and clear prior devices
     Cleanup();
@@ -362,6 +392,7 @@ bool cISLogger::LoadFromDirectory(const string &directory, eLogType logType, vec
     case cISLogger::LOGTYPE_SDAT: fileExtensionRegex = "\\.sdat$"; break;
     case cISLogger::LOGTYPE_CSV: fileExtensionRegex = "\\.csv$"; break;
     case cISLogger::LOGTYPE_JSON: fileExtensionRegex = "\\.json$"; break;
+    case cISLogger::LOGTYPE_COLUMNAR: fileExtensionRegex = "\\.col$"; break;
     case cISLogger::LOGTYPE_KML: return false; // fileExtensionRegex = "\\.kml$"; break; // kml read not supported
     }
 
@@ -415,12 +446,19 @@ bool cISLogger::LoadFromDirectory(const string &directory, eLogType logType, vec
                         switch (logType)
                         {
                         default:
-                        case cISLogger::LOGTYPE_DAT:    deviceLog = make_shared<cDeviceLogSerial>(0, serialNum); break;
+                        case cISLogger::LOGTYPE_DAT:
+                        {
+                            std::shared_ptr<cDeviceLogSerial> serialLog = make_shared<cDeviceLogSerial>(0, serialNum);
+                            serialLog->EnableMappedRead(readMode == READMODE_MAPPED);
+                            deviceLog = serialLog;
+                            break;
+                        }
                         case cISLogger::LOGTYPE_RAW:    deviceLog = make_shared<cDeviceLogRaw>(0, serialNum); break;
 #if !defined(PLATFORM_IS_EVB_2) || !PLATFORM_IS_EVB_2
                         case cISLogger::LOGTYPE_SDAT:   deviceLog = make_shared<cDeviceLogSorted>(0, serialNum); break;
                         case cISLogger::LOGTYPE_CSV:    deviceLog = make_shared<cDeviceLogCSV>(0, serialNum); break;
                         case cISLogger::LOGTYPE_JSON:   deviceLog = make_shared<cDeviceLogJSON>(0, serialNum); break;
+                        case cISLogger::LOGTYPE_COLUMNAR: deviceLog = make_shared<cDeviceLogColumnar>(0, serialNum); break;
 #endif
                         }
                         deviceLog->SetupReadInfo(directory, serialNumber, m_timeStamp);
@@ -439,12 +477,13 @@ bool cISLogger::LoadFromDirectory(const string &directory, eLogType logType, vec
 
     for (auto &d : this->DeviceLogs()) {
         d->InitDeviceForReading();
+        d->SetReadFilter(m_readFilter);
     }
     return (m_devices.size() != 0);
 }
 
 
-bool cISLogger::LogData(std::shared_ptr<cDeviceLog> deviceLog, p_data_hdr_t *dataHdr, const uint8_t *dataBuf)
+bool cISLogger::LogData(const std::shared_ptr<cDeviceLog>& deviceLog, p_data_hdr_t *dataHdr, const uint8_t *dataBuf)
 {
     // This method is NOT for LOGTYPE_RAW (but all others)
     if (!m_enabled || (deviceLog == nullptr) || (m_logType == LOGTYPE_RAW)) {
@@ -458,21 +497,27 @@ bool cISLogger::LogData(std::shared_ptr<cDeviceLog> deviceLog, p_data_hdr_t *dat
     }
 
     m_lastCommTime = GetTime();
+    SaveData(deviceLog, dataHdr, dataBuf, m_logStats);
+    return true;
+}
+
+void cISLogger::SaveData(const std::shared_ptr<cDeviceLog>& deviceLog, p_data_hdr_t *dataHdr, const uint8_t *dataBuf, cLogStats& stats)
+{
     if (isHeaderCorrupt(dataHdr))
     {
-        m_errorFile.lprintf("Corrupt log header, id: %lu, offset: %lu, size: %lu\r\n", (unsigned long)dataHdr->id, (unsigned long)dataHdr->offset, (unsigned long)dataHdr->size);
-        m_logStats.LogError(dataHdr);
+        ErrorPrintf("Corrupt log header, id: %lu, offset: %lu, size: %lu\r\n", (unsigned long)dataHdr->id, (unsigned long)dataHdr->offset, (unsigned long)dataHdr->size);
+        stats.LogError(dataHdr);
     }
     else if (!deviceLog->SaveData(dataHdr, dataBuf))
     {
-        m_errorFile.lprintf("Underlying log implementation failed to save\r\n");
-        m_logStats.LogError(dataHdr);
+        ErrorPrintf("Underlying log implementation failed to save\r\n");
+        stats.LogError(dataHdr);
     }
 #if 1
     else
     {	// Success
         double timestamp = cISDataMappings::GetTimestamp(dataHdr, dataBuf);
-        m_logStats.LogDataAndTimestamp(dataHdr->id, timestamp);
+        stats.LogDataAndTimestamp(dataHdr->id, timestamp);
 
         if (dataHdr->id == DID_DIAGNOSTIC_MESSAGE)
         {
@@ -494,10 +539,9 @@ bool cISLogger::LogData(std::shared_ptr<cDeviceLog> deviceLog, p_data_hdr_t *dat
         }
     }
 #endif
-    return true;
 }
 
-bool cISLogger::LogData(std::shared_ptr<cDeviceLog> deviceLog, int dataSize, const uint8_t *dataBuf)
+bool cISLogger::LogData(const std::shared_ptr<cDeviceLog>& deviceLog, int dataSize, const uint8_t *dataBuf)
 {
     // This method is ONLY for LOGTYPE_RAW
     if (!m_enabled || (deviceLog == nullptr) || (m_logType != LOGTYPE_RAW)) {
@@ -511,36 +555,62 @@ bool cISLogger::LogData(std::shared_ptr<cDeviceLog> deviceLog, int dataSize, con
     }
 
     m_lastCommTime = GetTime();
-    if (!deviceLog->SaveData(dataSize, dataBuf, m_logStats))
+    SaveData(deviceLog, dataSize, dataBuf, m_logStats);
+    return true;
+}
+
+void cISLogger::SaveData(const std::shared_ptr<cDeviceLog>& deviceLog, int dataSize, const uint8_t *dataBuf, cLogStats& stats)
+{
+    if (!deviceLog->SaveData(dataSize, dataBuf, stats))
     {	// Save Error
-        m_errorFile.lprintf("Underlying log implementation failed to save\r\n");
-        m_logStats.LogError(NULL);
+        ErrorPrintf("Underlying log implementation failed to save\r\n");
+        stats.LogError(NULL);
     }
-    else
-    {	// Success
+}
+
+uint32_t cISLogger::LogQueuedData(const std::shared_ptr<cDeviceLog>& deviceLog, cLogPacketQueue& queue)
+{
+    uint32_t count = 0;
+    p_data_hdr_t *hdr;
+    const uint8_t *buf;
 
+    // Packets are written in place from the queue
+    while (m_enabled && (hdr = queue.Front(&buf)) != NULL)
+    {
+        // Failures are counted in the log stats.  The packet is discarded rather than retried so the queue keeps draining.
+        LogData(deviceLog, hdr, buf);
+        queue.Pop();
+        count++;
     }
-    return true;
+    return count;
 }
 
 
-p_data_buf_t *cISLogger::ReadData(std::shared_ptr<cDeviceLog> deviceLog)
+p_data_buf_t *cISLogger::ReadData(const std::shared_ptr<cDeviceLog>& deviceLog)
+{
+    return ReadData(deviceLog, m_logStats);
+}
+
+p_data_buf_t *cISLogger::ReadData(const std::shared_ptr<cDeviceLog>& deviceLog, cLogStats& stats)
 {
     if (deviceLog == nullptr) {
         return NULL;
     }
 
     p_data_buf_t *data = NULL;
-    while (isDataCorrupt(data = deviceLog->ReadData()))
+    do
     {
-        m_errorFile.lprintf("Corrupt log header, id: %lu, offset: %lu, size: %lu\r\n", (unsigned long)data->hdr.id, (unsigned long)data->hdr.offset, (unsigned long)data->hdr.size);
-        m_logStats.LogError(&data->hdr);
-        data = NULL;
-    }
+        while (isDataCorrupt(data = deviceLog->ReadData()))
+        {
+            ErrorPrintf("Corrupt log header, id: %lu, offset: %lu, size: %lu\r\n", (unsigned long)data->hdr.id, (unsigned long)data->hdr.offset, (unsigned long)data->hdr.size);
+            stats.LogError(&data->hdr);
+            data = NULL;
+        }
+    } while (data != NULL && !m_readFilter.empty() && (data->hdr.id >= m_readFilter.size() || !m_readFilter[data->hdr.id]));
     if (data != NULL)
     {
         double timestamp = cISDataMappings::GetTimestamp(&data->hdr, data->buf);
-        m_logStats.LogDataAndTimestamp(data->hdr.id, timestamp);
+        stats.LogDataAndTimestamp(data->hdr.id, timestamp);
     }
     return data;
 }
@@ -549,10 +619,42 @@ p_data_buf_t *cISLogger::ReadData(size_t devIndex) {
     if (devIndex >= m_devices.size())
         return nullptr;
 
-    return ReadData(m_devices[devIndex]);
+    // Devices are keyed by serial number, devIndex is the position in the map
+    auto it = m_devices.begin();
+    std::advance(it, devIndex);
+    return ReadData(it->second);
 }
 
 
+bool cISLogger::Seek(double timestamp)
+{
+    ResetMergeRead();
+    bool found = false;
+    for (auto &d : DeviceLogs())
+    {
+        found |= d->Seek(timestamp);
+    }
+    return found;
+}
+
+void cISLogger::SetReadFilter(const std::vector<uint32_t>& dids)
+{
+    m_readFilter.clear();
+    for (uint32_t id : dids)
+    {
+        if (id >= m_readFilter.size())
+        {
+            m_readFilter.resize(id + 1, 0);
+        }
+        m_readFilter[id] = 1;
+    }
+
+    for (auto &d : DeviceLogs())
+    {
+        d->SetReadFilter(m_readFilter);
+    }
+}
+
 p_data_buf_t *cISLogger::ReadNextData(size_t& devIndex)
 {
     while (devIndex < m_devices.size())
@@ -570,12 +672,98 @@ p_data_buf_t *cISLogger::ReadNextData(size_t& devIndex)
     return NULL;
 }
 
+bool cISLogger::ReadMergeCursor(sMergeCursor& cursor)
+{
+    p_data_buf_t *data = ReadData(cursor.devLog);
+    if (data == NULL)
+    {
+        return false;
+    }
+
+    cursor.data.hdr = data->hdr;
+    memcpy(cursor.data.buf, data->buf, _MIN(data->hdr.size, sizeof(cursor.data.buf)));
+    double timestamp = cISDataMappings::GetTimestamp(&data->hdr, data->buf);
+    if (timestamp != 0.0)
+    {
+        cursor.timestamp = timestamp;
+    }
+    return true;
+}
+
+void cISLogger::ResetMergeRead()
+{
+    m_mergeCursors.clear();
+    m_mergeHeap.clear();
+    m_mergeCurrent = -1;
+}
+
+p_data_buf_t *cISLogger::ReadNextDataByTime(std::shared_ptr<cDeviceLog>* devLogger)
+{
+    // Heap order, earliest timestamp on top and ties go to the first device
+    auto later = [this](uint32_t a, uint32_t b)
+    {
+        double ta = m_mergeCursors[a].timestamp;
+        double tb = m_mergeCursors[b].timestamp;
+        return (ta > tb) || (ta == tb && a > b);
+    };
+
+    if (m_mergeCursors.empty() && m_mergeCurrent < 0)
+    {   // Start with the first data of each device
+        m_mergeCursors.resize(m_devices.size());
+        uint32_t i = 0;
+        for (auto it : m_devices)
+        {
+            m_mergeCursors[i].devLog = it.second;
+            if (ReadMergeCursor(m_mergeCursors[i]))
+            {
+                m_mergeHeap.push_back(i);
+                std::push_heap(m_mergeHeap.begin(), m_mergeHeap.end(), later);
+            }
+            i++;
+        }
+    }
+    else if (m_mergeCurrent >= 0 && ReadMergeCursor(m_mergeCursors[m_mergeCurrent]))
+    {   // Replace the data returned last time with the next data of that device
+        m_mergeHeap.push_back((uint32_t)m_mergeCurrent);
+        std::push_heap(m_mergeHeap.begin(), m_mergeHeap.end(), later);
+    }
+
+    if (m_mergeHeap.empty())
+    {
+        m_mergeCurrent = -1;
+        return NULL;
+    }
+
+    std::pop_heap(m_mergeHeap.begin(), m_mergeHeap.end(), later);
+    m_mergeCurrent = (int)m_mergeHeap.back();
+    m_mergeHeap.pop_back();
+
+    sMergeCursor& cursor = m_mergeCursors[m_mergeCurrent];
+    if (devLogger)
+    {
+        *devLogger = cursor.devLog;
+    }
+    return &cursor.data;
+}
+
 void cISLogger::CloseAllFiles()
 {
+    ResetMergeRead();
+    m_logStats.compressStats = {};
+    m_logStats.decompressStats = {};
     for (auto it : m_devices)
     {
         if (it.second != nullptr)
+        {
             it.second->CloseAllFiles();
+
+            cDeviceLogSerial* serialLog = dynamic_cast<cDeviceLogSerial*>(it.second.get());
+            if (serialLog != nullptr)
+            {
+                cLogStats::AddCompressionStats(m_logStats.compressStats, serialLog->CompressionStats());
+                cLogStats::AddCompressionStats(m_logStats.decompressStats, serialLog->DecompressionStats());
+            }
+        }
     }
 
     m_logStats.WriteToFile(m_directory + "/stats.txt");
@@ -690,7 +878,8 @@ int g_copyReadCount;
 int g_copyReadDid;
 
 /**
- * FIXME:  Not sure what to do here... this seems to be making a copy of a cISLogger instance, but I'm not sure why...
+ * Convert all device logs of another logger into this logger.  With SetCopyThreads() > 1 devices are copied in
+ * parallel, each by one thread, producing the same files as a serial copy.
  * @param log
  * @param timestamp
  * @param outputDir
@@ -709,72 +898,143 @@ bool cISLogger::CopyLog(cISLogger &log, const string &timestamp, const string &o
         return false;
     }
 
-    is_comm_instance_t comm;
-    uint8_t commBuf[PKT_BUF_SIZE];
-    is_comm_init(&comm, commBuf, sizeof(commBuf));
-
     EnableLogging(true);
-    p_data_buf_t *data = NULL;
-    for ( auto& srcDev : log.DeviceLogs() )
+    vector<shared_ptr<cDeviceLog>> srcDevs = log.DeviceLogs();
+    vector<shared_ptr<cDeviceLog>> dstDevs;
+    for ( auto& srcDev : srcDevs )
     {
         auto dstDev = ( srcDev->Device() != nullptr ? registerDevice(*(srcDev->Device())) : registerDevice(0, srcDev->SerialNumber()) );
 
 #if LOG_DEBUG_GEN == 2
         // Don't print status here
 #elif LOG_DEBUG_GEN || DEBUG_PRINT
-        printf("cISLogger::CopyLog SN%d type %d, (%d of %d)\n", devInfo->serialNumber, logType, dev + 1, log.DeviceCount());
+        printf("cISLogger::CopyLog SN%d type %d, (%d of %d)\n", srcDev->SerialNumber(), logType, (int)dstDevs.size() + 1, log.DeviceCount());
 #endif
 
         // Set KML configuration
         dstDev->SetKmlConfig(m_gpsData, m_showPath, m_showSample, m_showTimeStamp, m_iconUpdatePeriodSec, m_altClampToGround);
+        dstDevs.push_back(dstDev);
+    }
+
+    uint32_t threadCount = m_copyThreads;
+#if PLATFORM_IS_EMBEDDED
+    threadCount = 1;
+#else
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency();
+    }
+#endif
+    threadCount = _MIN(threadCount, (uint32_t)srcDevs.size());
+
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < srcDevs.size(); i++)
+        {
+            CopyDeviceLog(log, srcDevs[i], dstDevs[i], logType, enableCsvIns2ToIns1Conversion, log.m_logStats, m_logStats);
+        }
+    }
+#if !PLATFORM_IS_EMBEDDED
+    else
+    {
+        // Each device has its own source and destination files, so only the stats are kept per device and merged after
+        sCopyJob job(log, srcDevs, dstDevs);
+        job.logger = this;
+        job.logType = logType;
+        job.enableCsvIns2ToIns1Conversion = enableCsvIns2ToIns1Conversion;
+
+        vector<void*> threads;
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            threads.push_back(threadCreateAndStart(&cISLogger::CopyLogThread, &job));
+        }
+        for (void* thread : threads)
+        {
+            threadJoinAndFree(thread);
+        }
 
-        // Copy data
-        for (g_copyReadCount = 0; (data = log.ReadData(srcDev)); g_copyReadCount++)
+        // Merge in device order so the totals do not depend on thread timing
+        for (size_t i = 0; i < srcDevs.size(); i++)
         {
+            log.m_logStats.Merge(job.readStats[i]);
+            m_logStats.Merge(job.writeStats[i]);
+        }
+    }
+#endif
+
+    CloseAllFiles();
+    return true;
+}
+
+#if !PLATFORM_IS_EMBEDDED
+
+void cISLogger::CopyLogThread(void* info)
+{
+    sCopyJob* job = (sCopyJob*)info;
+    size_t i;
+    while ((i = job->next++) < job->srcDevs.size())
+    {
+        job->logger->CopyDeviceLog(job->src, job->srcDevs[i], job->dstDevs[i], job->logType, job->enableCsvIns2ToIns1Conversion, job->readStats[i], job->writeStats[i]);
+    }
+}
+
+#endif
+
+void cISLogger::CopyDeviceLog(cISLogger &log, const std::shared_ptr<cDeviceLog>& srcDev, const std::shared_ptr<cDeviceLog>& dstDev, eLogType logType, bool enableCsvIns2ToIns1Conversion, cLogStats& readStats, cLogStats& writeStats)
+{
+    is_comm_instance_t comm;
+    uint8_t commBuf[PKT_BUF_SIZE];
+    is_comm_init(&comm, commBuf, sizeof(commBuf));
+
+    // Copy data
+    p_data_buf_t *data = NULL;
+    for (int readCount = 0; (data = log.ReadData(srcDev, readStats)); readCount++)
+    {
 
 #if LOG_DEBUG_PRINT_READ
-            double timestamp = cISDataMappings::GetTimestamp(&(data->hdr), data->buf);
-            printf("read: %d DID: %3d time: %.4lf\n", g_copyReadCount, data->hdr.id, timestamp);
-            g_copyReadDid = data->hdr.id;
+        double timestamp = cISDataMappings::GetTimestamp(&(data->hdr), data->buf);
+        printf("read: %d DID: %3d time: %.4lf\n", readCount, data->hdr.id, timestamp);
+        g_copyReadCount = readCount;
+        g_copyReadDid = data->hdr.id;
 #endif
 
 #if LOG_DEBUG_GEN == 2
-            PrintProgress();
+        PrintProgress();
 #endif
 
-            // CSV special cases 
-            if (logType == eLogType::LOGTYPE_CSV && enableCsvIns2ToIns1Conversion)
-            {
-                if (data->hdr.id == DID_INS_2)
-                {	// Convert INS2 to INS1 when creating .csv logs
-                    ins_1_t ins1;
-                    ins_2_t ins2;
-
-                    copyDataBufPToStructP(&ins2, data, sizeof(ins_2_t));
-                    convertIns2ToIns1(&ins2, &ins1);
-
-                    p_data_hdr_t hdr;
-                    hdr.id = DID_INS_1;
-                    hdr.size = sizeof(ins_1_t);
-                    hdr.offset = 0;
-                    LogData(dstDev, &hdr, (uint8_t *)&ins1);
-                }
+        // CSV special cases 
+        if (logType == eLogType::LOGTYPE_CSV && enableCsvIns2ToIns1Conversion)
+        {
+            if (data->hdr.id == DID_INS_2)
+            {	// Convert INS2 to INS1 when creating .csv logs
+                ins_1_t ins1;
+                ins_2_t ins2;
+
+                copyDataBufPToStructP(&ins2, data, sizeof(ins_2_t));
+                convertIns2ToIns1(&ins2, &ins1);
+
+                p_data_hdr_t hdr;
+                hdr.id = DID_INS_1;
+                hdr.size = sizeof(ins_1_t);
+                hdr.offset = 0;
+                SaveData(dstDev, &hdr, (uint8_t *)&ins1, writeStats);
             }
+        }
 
-            // Save data
-            if (logType == LOGTYPE_RAW)
-            {	// Encode data into to ISB packet
-                int pktSize = is_comm_data_to_buf(comm.rxBuf.start, comm.rxBuf.size, &comm, data->hdr.id, data->hdr.size, data->hdr.offset, data->buf);
-                LogData(dstDev, pktSize, comm.rxBuf.start);
-            }
-            else
+        // Save data
+        if (logType == LOGTYPE_RAW)
+        {	// Encode data into to ISB packet
+            int pktSize = is_comm_data_to_buf(comm.rxBuf.start, comm.rxBuf.size, &comm, data->hdr.id, data->hdr.size, data->hdr.offset, data->buf);
+            if (pktSize > 0)
             {
-                LogData(dstDev, &data->hdr, data->buf);
+                SaveData(dstDev, pktSize, comm.rxBuf.start, writeStats);
             }
         }
+        else
+        {
+            SaveData(dstDev, &data->hdr, data->buf, writeStats);
+        }
     }
-    CloseAllFiles();
-    return true;
 }
 
 /*
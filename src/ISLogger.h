@@ -20,6 +20,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vector>
 #include <map>
 #include <memory>
+#include <atomic>
 
 #include "DeviceLogSerial.h"
 #include "DeviceLogRaw.h"
@@ -29,6 +30,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "DeviceLogCSV.h"
 #include "DeviceLogJSON.h"
 #include "DeviceLogKML.h"
+#include "DeviceLogColumnar.h"
 #endif
 
 #if PLATFORM_IS_EVB_2
@@ -40,6 +42,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include "ISConstants.h"
 #include "ISLogStats.h"
+#include "ISLogQueue.h"
 
 
 // default logging path if none specified
@@ -56,7 +59,14 @@ public:
 		LOGTYPE_SDAT,		// sorted
 		LOGTYPE_CSV,
 		LOGTYPE_KML,
-		LOGTYPE_JSON
+		LOGTYPE_JSON,
+		LOGTYPE_COLUMNAR	// per data set column files, see DeviceLogColumnar.h
+	};
+
+	enum eReadMode
+	{
+		READMODE_STREAM = 0,	// files read into a chunk buffer
+		READMODE_MAPPED,		// LOGTYPE_DAT files memory mapped, ReadData() returns packets in place in the file
 	};
 
 	static const std::string g_emptyString;
@@ -64,8 +74,8 @@ public:
 	cISLogger();
 	virtual ~cISLogger();
 
-	// Setup logger to read from file.
-	bool LoadFromDirectory(const std::string& directory, eLogType logType = LOGTYPE_DAT, std::vector<std::string> serials = {});
+	// Setup logger to read from file.  READMODE_MAPPED applies to LOGTYPE_DAT, other types are always streamed.
+	bool LoadFromDirectory(const std::string& directory, eLogType logType = LOGTYPE_DAT, std::vector<std::string> serials = {}, eReadMode readMode = READMODE_STREAM);
 
 	// Setup logger for writing to file.
 	bool InitSave(eLogType logType = LOGTYPE_DAT, const std::string& directory = g_emptyString, float maxDiskSpacePercent = 0.5f, uint32_t maxFileSize = 1024 * 1024 * 5, bool useSubFolderTimestamp = true);
@@ -79,13 +89,38 @@ public:
 
 	// update internal state, handle timeouts, etc.
 	void Update();
-	bool LogData(std::shared_ptr<cDeviceLog> devLogger, p_data_hdr_t* dataHdr, const uint8_t* dataBuf);
-	bool LogData(std::shared_ptr<cDeviceLog> devLogger, int dataSize, const uint8_t* dataBuf);
+	bool LogData(const std::shared_ptr<cDeviceLog>& devLogger, p_data_hdr_t* dataHdr, const uint8_t* dataBuf);
+	bool LogData(const std::shared_ptr<cDeviceLog>& devLogger, int dataSize, const uint8_t* dataBuf);
+	// Write and remove all packets in queue, returns the number of packets
+	uint32_t LogQueuedData(const std::shared_ptr<cDeviceLog>& devLogger, cLogPacketQueue& queue);
     bool LogDataBySN(uint32_t serialNo, p_data_hdr_t* dataHdr, const uint8_t* dataBuf) { return LogData(DeviceLogBySerialNumber(serialNo), dataHdr, dataBuf); }
     bool LogDataBySN(uint32_t serialNo, int dataSize, const uint8_t* dataBuf) {  return LogData(DeviceLogBySerialNumber(serialNo), dataSize, dataBuf); }
-	p_data_buf_t* ReadData(std::shared_ptr<cDeviceLog> devLogger = nullptr);
+	p_data_buf_t* ReadData(const std::shared_ptr<cDeviceLog>& devLogger = nullptr);
     p_data_buf_t* ReadData(size_t devIndex);
 	p_data_buf_t* ReadNextData(size_t& devIndex);
+
+	/**
+	* Read the data of all devices as one sequence ordered by cISDataMappings::GetTimestamp().  One packet per device
+	* is held in a min-heap, so memory use does not depend on log size.  Data without a timestamp keeps the time of
+	* the previous data of its device.  The order of each device's data is kept.  Seek() and LoadFromDirectory()
+	* restart the sequence.
+	* @param devLogger set to the device log the data was read from if not NULL
+	* @return the next data, valid until the next call, or NULL when all devices are done
+	*/
+	p_data_buf_t* ReadNextDataByTime(std::shared_ptr<cDeviceLog>* devLogger = NULLPTR);
+
+	/**
+	* Position all devices at their first data at or after a time.  Uses the .dat chunk index when available.
+	* @param timestamp time as returned by cISDataMappings::GetTimestamp()
+	* @return true if any device has data at or after the time
+	*/
+	bool Seek(double timestamp);
+
+	/**
+	* Only return these DIDs from ReadData() and ReadNextData().  .dat logs with a chunk index skip chunks without them.
+	* @param dids DIDs to read, empty to read all
+	*/
+	void SetReadFilter(const std::vector<uint32_t>& dids);
 	void EnableLogging(bool enabled) { m_enabled = enabled; }
 	bool Enabled() { return m_enabled; }
 	void CloseAllFiles();
@@ -119,6 +154,7 @@ public:
 		bool useSubFolderTimestamp = true,
 		bool enableCsvIns2ToIns1Conversion = true);
 	const cLogStats& GetStats() { return m_logStats; }
+	void LogQueueStats(const log_queue_stats_t& stats) { m_logStats.queueStats = stats; }
 	eLogType GetType() { return m_logType; }
 
 	/**
@@ -133,6 +169,30 @@ public:
 	*/
 	void SetTimeoutFlushSeconds(time_t timeoutFlushSeconds) { m_timeoutFlushSeconds = timeoutFlushSeconds; }
 
+	/**
+	* Write LOGTYPE_DAT chunks to file from an I/O thread per device so disk stalls do not block logging.
+	* Applies to devices registered after the call.
+	* @param maxChunksInFlight number of filled chunks per device that may be waiting to be written, 0 to write synchronously
+	*/
+	void SetAsyncWriteChunks(uint32_t maxChunksInFlight) { m_asyncWriteChunks = maxChunksInFlight; }
+	uint32_t AsyncWriteChunks() { return m_asyncWriteChunks; }
+
+	/**
+	* Compress LOGTYPE_DAT chunks when writing, see cDeviceLogSerial::EnableCompression().  Applies to devices registered
+	* after the call.  Compression stats are in GetStats() after CloseAllFiles().
+	* @param level 1 (fastest) to 10 (smallest), 0 to disable (default)
+	*/
+	void SetCompressionLevel(int level) { m_compressionLevel = level; }
+	int CompressionLevel() { return m_compressionLevel; }
+
+	/**
+	* Set the number of threads CopyLog() converts devices on.  Each device is copied by a single thread, so the
+	* output files are the same as a serial copy.
+	* @param threads number of threads, 0 for one per CPU core, 1 to copy serially (default)
+	*/
+	void SetCopyThreads(uint32_t threads) { m_copyThreads = threads; }
+	uint32_t CopyThreads() { return m_copyThreads; }
+
     // check if a data header is corrupt
     static bool isHeaderCorrupt(const p_data_hdr_t* hdr);
 
@@ -183,6 +243,10 @@ public:
 		{
 			return cISLogger::eLogType::LOGTYPE_RAW;
 		}
+		else if (logTypeString == "col")
+		{
+			return cISLogger::eLogType::LOGTYPE_COLUMNAR;
+		}
 		return cISLogger::eLogType::LOGTYPE_DAT;
 	}
 
@@ -197,8 +261,44 @@ private:
 
 	bool InitSaveCommon(eLogType logType, const std::string& directory, const std::string& subDirectory, float maxDiskSpacePercent, uint32_t maxFileSize, bool useSubFolderTimestamp);
 	bool InitDevicesForWriting(std::vector<ISDevice>& devices);
+	void InitDeviceLogForWriting(const std::shared_ptr<cDeviceLog>& deviceLog);
 	void Cleanup();
 	void PrintProgress();
+	void ErrorPrintf(const char* format, ...);
+	p_data_buf_t* ReadData(const std::shared_ptr<cDeviceLog>& devLogger, cLogStats& stats);
+	void SaveData(const std::shared_ptr<cDeviceLog>& devLogger, p_data_hdr_t* dataHdr, const uint8_t* dataBuf, cLogStats& stats);
+	void SaveData(const std::shared_ptr<cDeviceLog>& devLogger, int dataSize, const uint8_t* dataBuf, cLogStats& stats);
+	void CopyDeviceLog(cISLogger& log, const std::shared_ptr<cDeviceLog>& srcDev, const std::shared_ptr<cDeviceLog>& dstDev, eLogType logType, bool enableCsvIns2ToIns1Conversion, cLogStats& readStats, cLogStats& writeStats);
+
+#if !PLATFORM_IS_EMBEDDED
+	// Devices shared by the CopyLog() threads, each thread takes the next device not yet copied
+	struct sCopyJob
+	{
+		sCopyJob(cISLogger& log, const std::vector<std::shared_ptr<cDeviceLog>>& src, const std::vector<std::shared_ptr<cDeviceLog>>& dst) :
+			src(log), srcDevs(src), dstDevs(dst), readStats(src.size()), writeStats(src.size()) {}
+
+		cISLogger* logger = NULLPTR;
+		cISLogger& src;
+		const std::vector<std::shared_ptr<cDeviceLog>>& srcDevs;
+		const std::vector<std::shared_ptr<cDeviceLog>>& dstDevs;
+		std::vector<cLogStats> readStats;
+		std::vector<cLogStats> writeStats;
+		eLogType logType = LOGTYPE_DAT;
+		bool enableCsvIns2ToIns1Conversion = false;
+		std::atomic<size_t> next{0};
+	};
+	static void CopyLogThread(void* info);
+#endif
+
+	// ReadNextDataByTime() cursor, the next data of one device
+	struct sMergeCursor
+	{
+		std::shared_ptr<cDeviceLog> devLog;
+		double timestamp = 0.0;
+		p_data_buf_t data;
+	};
+	bool ReadMergeCursor(sMergeCursor& cursor);
+	void ResetMergeRead();
 
 	static time_t GetTime()
     {
@@ -218,6 +318,13 @@ private:
 
 	uint64_t				m_maxDiskSpace = 0;
 	uint32_t				m_maxFileSize = 0;
+	uint32_t				m_asyncWriteChunks = 0;
+	uint32_t				m_copyThreads = 1;
+	int						m_compressionLevel = 0;
+	std::vector<uint8_t>	m_readFilter;
+	std::vector<sMergeCursor> m_mergeCursors;		// one per device
+	std::vector<uint32_t>	m_mergeHeap;			// cursor indices, earliest timestamp first
+	int						m_mergeCurrent = -1;	// cursor returned by the last ReadNextDataByTime(), read again on the next call
 	cLogStats				m_logStats;
 #if PLATFORM_IS_EVB_2
 	cISLogFileFatFs         m_errorFile;
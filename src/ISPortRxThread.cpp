@@ -0,0 +1,234 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "ISPortRxThread.h"
+#include "ISUtilities.h"
+
+using namespace std;
+
+typedef struct
+{
+	/** Parsed packet, data.ptr is not valid in the queue */
+	packet_t            pkt;
+
+	/** Time the data was read, from current_timeUs() */
+	uint64_t            timeUs;
+
+	/** Parser error state at the time of the packet (_PTYPE_PARSE_ERROR) */
+	uint32_t            rxErrorCount;
+	uint8_t             rxErrorType;
+} port_rx_record_t;
+
+cISPortRxThread::cISPortRxThread(int port, serial_port_t* serialPort, uint32_t queueSize) : 
+	m_queue(queueSize, cLogPacketQueue::OVERFLOW_DROP_NEWEST, sizeof(port_rx_record_t) + PKT_BUF_SIZE), 
+	m_rawQueue(PORT_RX_RAW_QUEUE_DEFAULT_SIZE)
+{
+	m_port = port;
+	m_serialPort = serialPort;
+	m_running = false;
+	m_rawEnabled = false;
+	m_rxBytes = 0;
+	m_rxPacketCount = 0;
+	m_fullReadCount = 0;
+	m_parseErrorCount = 0;
+	is_comm_init(&m_comm, m_commBuffer, sizeof(m_commBuffer));
+}
+
+cISPortRxThread::~cISPortRxThread()
+{
+	Stop();
+}
+
+void cISPortRxThread::Start(cLogQueueEvent* wakeEvent)
+{
+	if (m_thread != NULL)
+	{
+		return;
+	}
+
+	// Wake the application on the first queued packet, rearmed once it empties the queue
+	m_queue.SetWakeup(wakeEvent, 1, 1);
+	m_running = true;
+	m_thread = threadCreateAndStart(&cISPortRxThread::RxThread, this);
+}
+
+void cISPortRxThread::Stop()
+{
+	if (m_thread == NULL)
+	{
+		return;
+	}
+
+	m_running = false;
+	threadJoinAndFree(m_thread);
+	m_thread = NULL;
+}
+
+void cISPortRxThread::RxThread(void* info)
+{
+	cISPortRxThread* rx = (cISPortRxThread*)info;
+
+	while (rx->m_running.load(std::memory_order_relaxed))
+	{
+		if (rx->Step() == 0 && !serialPortIsOpen(rx->m_serialPort))
+		{	// Port closed, don't spin until stopped
+			SLEEP_MS(PORT_RX_READ_TIMEOUT_MS);
+		}
+	}
+}
+
+int cISPortRxThread::Step(int timeoutMs)
+{
+	// Get available size of comm buffer.  is_comm_free() modifies comm->rxBuf pointers, call it before using comm->rxBuf.tail.
+	int bytesFree = is_comm_free(&m_comm);
+
+	// Sleep until the first byte arrives, then take whatever else is already waiting
+	int n = serialPortReadTimeout(m_serialPort, m_comm.rxBuf.tail, 1, timeoutMs);
+	if (n <= 0)
+	{
+		return 0;
+	}
+	if (bytesFree > 1)
+	{
+		n += serialPortReadTimeout(m_serialPort, m_comm.rxBuf.tail + 1, bytesFree - 1, 0);
+	}
+	uint64_t timeUs = current_timeUs();
+
+	m_rxBytes.fetch_add(n, std::memory_order_relaxed);
+	if (n == bytesFree)
+	{
+		m_fullReadCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (m_rawEnabled.load(std::memory_order_relaxed))
+	{
+		for (int i = 0; i < n; i += MAX_DATASET_SIZE)
+		{
+			p_data_hdr_t hdr = {};
+			hdr.size = (uint16_t)_MIN(n - i, MAX_DATASET_SIZE);
+			m_rawQueue.Push(hdr, m_comm.rxBuf.tail + i);
+		}
+	}
+
+	// Update comm buffer tail pointer
+	m_comm.rxBuf.tail += n;
+
+	protocol_type_t ptype;
+	while ((ptype = is_comm_parse(&m_comm)) != _PTYPE_NONE)
+	{
+		QueuePacket(ptype, timeUs);
+	}
+
+	return n;
+}
+
+void cISPortRxThread::QueuePacket(protocol_type_t ptype, uint64_t timeUs)
+{
+	m_rxPacketCount.fetch_add(1, std::memory_order_relaxed);
+	if (ptype == _PTYPE_PARSE_ERROR)
+	{
+		m_parseErrorCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Record header followed by the packet data.  The queue header id holds the protocol type.
+	uint8_t buf[sizeof(port_rx_record_t) + PKT_BUF_SIZE];
+	port_rx_record_t rec = {};
+	rec.pkt = m_comm.rxPkt;
+	rec.pkt.data.ptr = NULL;
+	rec.timeUs = timeUs;
+	rec.rxErrorCount = m_comm.rxErrorCount;
+	rec.rxErrorType = (uint8_t)m_comm.rxErrorType;
+
+	// Parse errors have no packet data
+	uint32_t dataSize = 0;
+	if (ptype != _PTYPE_PARSE_ERROR && m_comm.rxPkt.data.ptr != NULL)
+	{
+		dataSize = _MIN(m_comm.rxPkt.data.size, (uint32_t)PKT_BUF_SIZE);
+	}
+	rec.pkt.data.size = dataSize;
+	memcpy(buf, &rec, sizeof(rec));
+	if (dataSize)
+	{
+		memcpy(buf + sizeof(rec), m_comm.rxPkt.data.ptr, dataSize);
+	}
+
+	p_data_hdr_t hdr = {};
+	hdr.id = (uint8_t)ptype;
+	hdr.size = (uint16_t)(sizeof(rec) + dataSize);
+	m_queue.Push(hdr, buf);
+}
+
+protocol_type_t cISPortRxThread::Front(is_comm_instance_t* comm)
+{
+	const uint8_t* buf;
+	p_data_hdr_t* hdr = m_queue.Front(&buf);
+	if (hdr == NULL)
+	{
+		return _PTYPE_NONE;
+	}
+
+	port_rx_record_t rec;
+	memcpy(&rec, buf, sizeof(rec));
+	comm->rxPkt = rec.pkt;
+	comm->rxPkt.data.ptr = (uint8_t*)buf + sizeof(rec);
+
+	protocol_type_t ptype = (protocol_type_t)hdr->id;
+	if (ptype == _PTYPE_PARSE_ERROR)
+	{
+		comm->rxErrorCount = rec.rxErrorCount;
+		comm->rxErrorType = (eParseErrorType)rec.rxErrorType;
+	}
+
+	m_frontTimeUs = rec.timeUs;
+	return ptype;
+}
+
+void cISPortRxThread::Pop()
+{
+	uint64_t latencyUs = current_timeUs() - m_frontTimeUs;
+	m_latencySumUs += latencyUs;
+	m_latencyMaxUs = _MAX(m_latencyMaxUs, (uint32_t)_MIN(latencyUs, UINT32_MAX));
+	m_dispatchCount++;
+	m_queue.Pop();
+}
+
+const uint8_t* cISPortRxThread::FrontRaw(int* size)
+{
+	const uint8_t* buf;
+	p_data_hdr_t* hdr = m_rawQueue.Front(&buf);
+	if (hdr == NULL)
+	{
+		return NULL;
+	}
+
+	*size = hdr->size;
+	return buf;
+}
+
+port_rx_stats_t cISPortRxThread::Stats() const
+{
+	log_queue_stats_t queue = m_queue.Stats();
+
+	port_rx_stats_t stats = {};
+	stats.rxBytes = m_rxBytes.load(std::memory_order_relaxed);
+	stats.rxPacketCount = m_rxPacketCount.load(std::memory_order_relaxed);
+	stats.dispatchCount = m_dispatchCount;
+	stats.dropCount = queue.dropCount;
+	stats.fullReadCount = m_fullReadCount.load(std::memory_order_relaxed);
+	stats.parseErrorCount = m_parseErrorCount.load(std::memory_order_relaxed);
+	stats.latencyMaxUs = m_latencyMaxUs;
+	stats.latencyAvgUs = (uint32_t)(m_dispatchCount ? m_latencySumUs / m_dispatchCount : 0);
+	stats.queueHighWaterBytes = queue.highWaterBytes;
+	return stats;
+}
@@ -0,0 +1,164 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_PORT_RX_THREAD_H
+#define IS_PORT_RX_THREAD_H
+
+#include <cstdint>
+#include <atomic>
+
+#include "ISComm.h"
+#include "ISLogQueue.h"
+#include "serialPort.h"
+
+// default size in bytes of the queue of parsed packets waiting to be dispatched
+#define PORT_RX_QUEUE_DEFAULT_SIZE      (256 * 1024)
+
+// default size in bytes of the queue of raw received data (raw logging only)
+#define PORT_RX_RAW_QUEUE_DEFAULT_SIZE  (64 * 1024)
+
+// max time the receive thread waits for data before checking whether it should stop
+#define PORT_RX_READ_TIMEOUT_MS         10
+
+typedef struct
+{
+	/** Bytes read from the port */
+	uint64_t rxBytes;
+
+	/** Packets parsed by the receive thread, including parse errors */
+	uint64_t rxPacketCount;
+
+	/** Packets delivered to the application */
+	uint64_t dispatchCount;
+
+	/** Packets dropped because the queue was full, i.e. the application is not calling Update() often enough */
+	uint64_t dropCount;
+
+	/** Reads that filled the parse buffer.  Data is backing up in the port, which risks a kernel or UART overrun. */
+	uint64_t fullReadCount;
+
+	/** Parse errors */
+	uint32_t parseErrorCount;
+
+	/** Max and average time from reading a packet to dispatching it, in microseconds */
+	uint32_t latencyMaxUs;
+	uint32_t latencyAvgUs;
+
+	/** Largest number of bytes held in the packet queue */
+	uint32_t queueHighWaterBytes;
+} port_rx_stats_t;
+
+/**
+* Reads and parses one serial port on a dedicated thread so slow application callbacks do not delay reading the
+* port.  Parsed packets are handed to the application thread through a lock-free queue (cLogPacketQueue).  The
+* receive thread is the producer, Front()/Pop() are called from the application thread.
+*/
+class cISPortRxThread
+{
+public:
+	/**
+	* Constructor
+	* @param port the port index passed to the application with each packet
+	* @param serialPort the open serial port to read, must stay valid until Stop()
+	* @param queueSize size in bytes of the packet queue, increased to hold at least two of the largest packets
+	*/
+	cISPortRxThread(int port, serial_port_t* serialPort, uint32_t queueSize = PORT_RX_QUEUE_DEFAULT_SIZE);
+	virtual ~cISPortRxThread();
+
+	/**
+	* Start the receive thread
+	* @param wakeEvent optional event signaled when packets are queued, i.e. to sleep until data arrives
+	*/
+	void Start(cLogQueueEvent* wakeEvent = NULL);
+
+	/**
+	* Stop and join the receive thread
+	*/
+	void Stop();
+
+	bool Running() { return m_thread != NULL; }
+
+	int Port() { return m_port; }
+
+	/**
+	* Get the oldest parsed packet (application thread).  comm->rxPkt, and the error state for parse errors,
+	* are set as if comm had parsed the packet, so it can be passed to is_comm_dispatch_packet().  The packet
+	* data is valid until Pop().
+	* @param comm the comm instance to copy the packet into
+	* @return the packet protocol type or _PTYPE_NONE if the queue is empty
+	*/
+	protocol_type_t Front(is_comm_instance_t* comm);
+
+	/**
+	* Remove the packet returned by Front() (application thread)
+	*/
+	void Pop();
+
+	/**
+	* Queue raw received data for FrontRaw(), i.e. for raw logging.  Can be changed while running.
+	*/
+	void SetRawEnabled(bool enabled) { m_rawEnabled.store(enabled, std::memory_order_relaxed); }
+
+	/**
+	* Get the oldest block of raw received data (application thread)
+	* @param size set to the number of bytes
+	* @return the data or NULL if none
+	*/
+	const uint8_t* FrontRaw(int* size);
+
+	/**
+	* Remove the data returned by FrontRaw() (application thread)
+	*/
+	void PopRaw() { m_rawQueue.Pop(); }
+
+	/**
+	* Get a snapshot of the port counters
+	*/
+	port_rx_stats_t Stats() const;
+
+	/**
+	* Read and parse whatever data is available, waiting up to timeoutMs for the first byte.  Called in a loop by
+	* the receive thread.
+	* @return number of bytes read
+	*/
+	int Step(int timeoutMs = PORT_RX_READ_TIMEOUT_MS);
+
+private:
+	cISPortRxThread(const cISPortRxThread& copy); // Disable copy constructor
+
+	static void RxThread(void* info);
+	void QueuePacket(protocol_type_t ptype, uint64_t timeUs);
+
+	int m_port;
+	serial_port_t* m_serialPort;
+	void* m_thread = NULL;
+	std::atomic<bool> m_running;
+	std::atomic<bool> m_rawEnabled;
+
+	// receive thread state
+	is_comm_instance_t m_comm;
+	uint8_t m_commBuffer[PKT_BUF_SIZE];
+	cLogPacketQueue m_queue;
+	cLogPacketQueue m_rawQueue;
+	std::atomic<uint64_t> m_rxBytes;
+	std::atomic<uint64_t> m_rxPacketCount;
+	std::atomic<uint64_t> m_fullReadCount;
+	std::atomic<uint32_t> m_parseErrorCount;
+
+	// application thread state
+	uint64_t m_frontTimeUs = 0;
+	uint64_t m_dispatchCount = 0;
+	uint64_t m_latencySumUs = 0;
+	uint32_t m_latencyMaxUs = 0;
+};
+
+#endif // IS_PORT_RX_THREAD_H
@@ -0,0 +1,175 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "ISReactor.h"
+
+#if PLATFORM_IS_LINUX
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+using namespace std;
+
+cISReactor::cISReactor()
+{
+	m_epfd = -1;
+	m_invalid = false;
+}
+
+cISReactor::~cISReactor()
+{
+	Close();
+}
+
+bool cISReactor::Open()
+{
+	Close();
+
+#if PLATFORM_IS_LINUX
+
+	m_epfd = epoll_create1(EPOLL_CLOEXEC);
+
+#endif
+
+	return IsOpen();
+}
+
+void cISReactor::Close()
+{
+#if PLATFORM_IS_LINUX
+
+	if (m_epfd >= 0)
+	{
+		close(m_epfd);
+	}
+
+#endif
+
+	m_epfd = -1;
+	m_watched.clear();
+	m_watchedWritable.clear();
+	m_invalid = false;
+}
+
+void cISReactor::Watch(const vector<int>& fds, const vector<uint8_t>& writable)
+{
+	vector<uint8_t> write(fds.size(), 0);
+	for (size_t i = 0; i < fds.size() && i < writable.size(); i++)
+	{
+		write[i] = (writable[i] != 0);
+	}
+
+	if (!IsOpen() || (!m_invalid && fds == m_watched && write == m_watchedWritable))
+	{
+		return;
+	}
+
+#if PLATFORM_IS_LINUX
+
+	for (size_t i = 0; i < m_watched.size(); i++)
+	{	// Remove descriptors that are no longer watched or moved to another slot
+		if (m_watched[i] >= 0 && (i >= fds.size() || fds[i] != m_watched[i]))
+		{
+			epoll_ctl(m_epfd, EPOLL_CTL_DEL, m_watched[i], NULLPTR);
+		}
+	}
+
+	for (size_t i = 0; i < fds.size(); i++)
+	{
+		bool registered = (i < m_watched.size() && fds[i] == m_watched[i]);
+		if (fds[i] < 0 || (!m_invalid && registered && write[i] == m_watchedWritable[i]))
+		{
+			continue;
+		}
+
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN | (write[i] ? (uint32_t)EPOLLOUT : 0);
+		ev.data.u64 = i;
+		if (!m_invalid && registered)
+		{	// Only the events changed
+			epoll_ctl(m_epfd, EPOLL_CTL_MOD, fds[i], &ev);
+		}
+		else if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, fds[i], &ev) != 0 && errno == EEXIST)
+		{	// Still registered from a previous set (i.e. after Invalidate())
+			epoll_ctl(m_epfd, EPOLL_CTL_MOD, fds[i], &ev);
+		}
+	}
+
+#endif
+
+	m_watched = fds;
+	m_watchedWritable.swap(write);
+	m_invalid = false;
+}
+
+void cISReactor::Unwatch(size_t slot)
+{
+	if (slot >= m_watched.size() || m_watched[slot] < 0)
+	{
+		return;
+	}
+
+#if PLATFORM_IS_LINUX
+
+	epoll_ctl(m_epfd, EPOLL_CTL_DEL, m_watched[slot], NULLPTR);
+
+#endif
+
+	m_watched[slot] = -1;
+}
+
+int cISReactor::Wait(uint32_t timeoutMs, vector<uint8_t>& ready)
+{
+	ready.assign(m_watched.size(), 0);
+	if (!IsOpen())
+	{
+		return -1;
+	}
+
+#if PLATFORM_IS_LINUX
+
+	struct epoll_event events[IS_REACTOR_MAX_EVENTS];
+	int n = epoll_wait(m_epfd, events, IS_REACTOR_MAX_EVENTS, (int)timeoutMs);
+	if (n < 0)
+	{
+		return (errno == EINTR ? 0 : -1);
+	}
+
+	int count = 0;
+	for (int i = 0; i < n; i++)
+	{
+		size_t slot = (size_t)events[i].data.u64;
+		if (slot >= ready.size())
+		{
+			continue;
+		}
+		uint8_t flags = 0;
+		if (events[i].events & (EPOLLHUP | EPOLLERR))
+		{	// Port closed or unplugged, make sure it is registered again if reopened.  Reported as readable so the error is read.
+			Invalidate();
+			flags |= IS_REACTOR_READABLE;
+		}
+		flags |= (events[i].events & EPOLLIN ? IS_REACTOR_READABLE : 0);
+		flags |= (events[i].events & EPOLLOUT ? IS_REACTOR_WRITABLE : 0);
+		count += !ready[slot];
+		ready[slot] |= flags;
+	}
+	return count;
+
+#else
+
+	(void)timeoutMs;
+	return -1;
+
+#endif
+}
@@ -0,0 +1,96 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_REACTOR_H
+#define IS_REACTOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "ISConstants.h"
+
+// max events returned by a single epoll_wait() call
+#define IS_REACTOR_MAX_EVENTS       64
+
+// Wait() ready flags
+#define IS_REACTOR_READABLE         0x01
+#define IS_REACTOR_WRITABLE         0x02
+
+/**
+* Waits on a set of file descriptors (serial ports, sockets) with a single system call and reports
+* which are readable, and optionally writable.  Uses epoll on Linux.  Open() fails on other platforms, in which case callers
+* should fall back to polling each port.
+*/
+class cISReactor
+{
+public:
+	cISReactor();
+	virtual ~cISReactor();
+
+	/**
+	* Create the epoll set
+	* @return true if success, false if not supported on this platform
+	*/
+	bool Open();
+
+	/**
+	* Close the epoll set and forget all watched descriptors
+	*/
+	void Close();
+
+	bool IsOpen() { return m_epfd >= 0; }
+
+	/**
+	* Get the epoll descriptor, which is readable when any watched descriptor is ready
+	* @return the descriptor or -1 if not open
+	*/
+	int Fd() { return m_epfd; }
+
+	/**
+	* Set the descriptors to watch for readability.  The epoll set is only modified for descriptors that
+	* changed since the last call.  The index of a descriptor in fds is its slot number in Wait().
+	* @param fds descriptors to watch, negative entries are empty slots
+	* @param writable non-zero for slots to also watch for writability, i.e. sockets with queued output.  Missing entries are zero.
+	*/
+	void Watch(const std::vector<int>& fds, const std::vector<uint8_t>& writable = std::vector<uint8_t>());
+
+	/**
+	* Stop watching the descriptor in a slot.  Call before closing it, so a new descriptor with the same
+	* number is registered by the next Watch().
+	* @param slot the slot to clear
+	*/
+	void Unwatch(size_t slot);
+
+	/**
+	* Re-register all descriptors on the next Watch().  Call after closing and reopening a port, as the
+	* kernel removes a closed descriptor from the set and the number may be reused.
+	*/
+	void Invalidate() { m_invalid = true; }
+
+	/**
+	* Wait for any watched descriptor to become readable (or writable)
+	* @param timeoutMs max time to wait in milliseconds, 0 to return immediately
+	* @param ready resized to the number of slots, set to IS_REACTOR_READABLE and/or IS_REACTOR_WRITABLE for each ready slot
+	* @return number of ready slots, 0 on timeout, -1 on error
+	*/
+	int Wait(uint32_t timeoutMs, std::vector<uint8_t>& ready);
+
+private:
+	cISReactor(const cISReactor& copy); // Disable copy constructor
+
+	int m_epfd;
+	std::vector<int> m_watched;
+	std::vector<uint8_t> m_watchedWritable;
+	bool m_invalid;
+};
+
+#endif // IS_REACTOR_H
@@ -0,0 +1,115 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <cstdlib>
+
+#include "ISRtcmFilter.h"
+#include "ISUtilities.h"
+
+using namespace std;
+
+// MSM messages are <base>1 to <base>7 for each constellation: GPS, GLONASS, Galileo, SBAS, QZSS, BeiDou, NavIC
+static const int s_msmBase[] = { 1070, 1080, 1090, 1100, 1110, 1120, 1130 };
+
+void cISRtcmFilter::SetRule(int id, int32_t periodMs)
+{
+	if (id < 0 || id >= RTCM_FILTER_MESSAGE_COUNT)
+	{
+		return;
+	}
+	if (m_rules.empty())
+	{	// Unlisted types are blocked
+		m_rules.assign(RTCM_FILTER_MESSAGE_COUNT, rtcm_filter_rule_t{ RTCM_FILTER_BLOCK, 0, false });
+	}
+	m_rules[id] = rtcm_filter_rule_t{ periodMs, 0, false };
+}
+
+bool cISRtcmFilter::SetRules(const string& rules)
+{
+	vector<string> items;
+	splitString(rules, ',', items);
+
+	cISRtcmFilter filter;
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		string item = items[i];
+		if (item.empty())
+		{
+			continue;
+		}
+
+		int32_t periodMs = RTCM_FILTER_PASS;
+		if (item[0] == '-')
+		{
+			periodMs = RTCM_FILTER_BLOCK;
+			item.erase(0, 1);
+		}
+		size_t slash = item.find('/');
+		if (slash != string::npos)
+		{
+			char* end;
+			long period = strtol(item.c_str() + slash + 1, &end, 10);
+			if (periodMs == RTCM_FILTER_BLOCK || *end != 0 || end == item.c_str() + slash + 1 || period < 0)
+			{
+				return false;
+			}
+			periodMs = (int32_t)period;
+			item.erase(slash);
+		}
+
+		if (item == "*")
+		{
+			for (int id = 0; id < RTCM_FILTER_MESSAGE_COUNT; id++)
+			{
+				filter.SetRule(id, periodMs);
+			}
+		}
+		else if (item.size() == 4 && item.compare(0, 3, "MSM") == 0 && item[3] >= '1' && item[3] <= '7')
+		{
+			for (size_t c = 0; c < _ARRAY_ELEMENT_COUNT(s_msmBase); c++)
+			{
+				filter.SetRule(s_msmBase[c] + (item[3] - '0'), periodMs);
+			}
+		}
+		else
+		{
+			char* end;
+			long id = strtol(item.c_str(), &end, 10);
+			if (*end != 0 || end == item.c_str() || id < 0 || id >= RTCM_FILTER_MESSAGE_COUNT)
+			{
+				return false;
+			}
+			filter.SetRule((int)id, periodMs);
+		}
+	}
+
+	m_rules.swap(filter.m_rules);
+	m_rulesString = rules;
+	return true;
+}
+
+bool cISRtcmFilter::Decimate(rtcm_filter_rule_t& rule, uint32_t timeMs)
+{
+	// Messages arriving a little early still count as on time, so jitter doesn't skip a period
+	int32_t jitterMs = _MIN(RTCM_FILTER_JITTER_MS, rule.periodMs / 4);
+	int32_t dtMs = (int32_t)(timeMs - rule.nextMs);
+	if (rule.started && dtMs < -jitterMs)
+	{
+		m_messagesDropped++;
+		return false;
+	}
+
+	// Keep to the schedule unless a whole period was missed, i.e. the message stopped
+	rule.nextMs = (rule.started && dtMs < rule.periodMs ? rule.nextMs : timeMs) + rule.periodMs;
+	rule.started = true;
+	return true;
+}
@@ -0,0 +1,111 @@
+/*
+MIT LICENSE
+
+Copyright (c) 2014-2024 Inertial Sense, Inc. - http://inertialsense.com
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files(the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef IS_RTCM_FILTER_H
+#define IS_RTCM_FILTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ISConstants.h"
+
+// RTCM3 message numbers are 12 bits
+#define RTCM_FILTER_MESSAGE_COUNT   4096
+
+// Period values for SetRule()
+#define RTCM_FILTER_PASS            0       // forward every message
+#define RTCM_FILTER_BLOCK           -1      // forward no messages
+
+// max early arrival of a decimated message that still counts as on time (ms)
+#define RTCM_FILTER_JITTER_MS       50
+
+/**
+* Selects and decimates RTCM3 messages by message number, i.e. to forward MSM4 instead of MSM7 or station
+* position (1005) every 10 s over a low bandwidth link.  Uses only the message number, no other decoding.
+* Without rules all messages pass.
+*/
+class cISRtcmFilter
+{
+public:
+	cISRtcmFilter() {}
+
+	/**
+	* Set the rules from a string, replacing any previous rules
+	* @param rules comma separated items [-]<type>[/<period ms>], where type is a message number, MSM<1-7>
+	*  (MSM messages of that type from all constellations) or * (all messages).  A leading - blocks the type
+	*  and /<period ms> forwards at most one message of the type per period.  Unlisted types are blocked
+	*  unless * is listed.  Later items override earlier ones.  Examples:
+	*  "MSM4,1005/10000,1033/10000,1230"   MSM4 observations, station info every 10 s
+	*  "*,-MSM7,MSM4/1000"                 everything except MSM7, MSM4 at 1 Hz
+	*  ""                                  no filtering
+	* @return true if success, false if the rules are invalid, in which case the rules are unchanged
+	*/
+	bool SetRules(const std::string& rules);
+
+	/**
+	* Set the rule for one message number
+	* @param id RTCM3 message number
+	* @param periodMs min time between forwarded messages, RTCM_FILTER_PASS or RTCM_FILTER_BLOCK
+	*/
+	void SetRule(int id, int32_t periodMs);
+
+	/**
+	* Remove all rules, all messages pass
+	*/
+	void Clear() { m_rules.clear(); m_rulesString.clear(); }
+
+	bool Enabled() { return m_rules.size() != 0; }
+
+	const std::string& Rules() { return m_rulesString; }
+
+	/**
+	* Get whether a message should be forwarded, updating the decimation state if so
+	* @param id RTCM3 message number
+	* @param timeMs current time
+	* @return true to forward, false to drop
+	*/
+	bool Pass(int id, uint32_t timeMs)
+	{
+		if (m_rules.empty())
+		{
+			return true;
+		}
+		if (id < 0 || id >= RTCM_FILTER_MESSAGE_COUNT || m_rules[id].periodMs < 0)
+		{
+			m_messagesDropped++;
+			return false;
+		}
+		return m_rules[id].periodMs == 0 || Decimate(m_rules[id], timeMs);
+	}
+
+	/**
+	* Number of messages dropped by the filter
+	*/
+	uint32_t MessagesDropped() { return m_messagesDropped; }
+
+private:
+	typedef struct
+	{
+		int32_t periodMs;
+		uint32_t nextMs;		// time the next message is due
+		bool started;
+	} rtcm_filter_rule_t;
+
+	bool Decimate(rtcm_filter_rule_t& rule, uint32_t timeMs);
+
+	std::vector<rtcm_filter_rule_t> m_rules;	// indexed by message number, empty if no rules
+	std::string m_rulesString;
+	uint32_t m_messagesDropped = 0;
+};
+
+#endif // IS_RTCM_FILTER_H
@@ -22,6 +22,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <unistd.h> /* Needed for close() */
 #include <fcntl.h>
 #include <errno.h>
+#include <sys/uio.h>
 
 #endif
 
@@ -122,6 +123,51 @@ int ISSocketWrite(socket_t socket, const uint8_t* data, int dataLength)
     return totalWriteCount;
 }
 
+int ISSocketWriteV(socket_t socket, const uint8_t* const* data, const int* dataLength, int count)
+{
+	count = _MIN(count, IS_SOCKET_MAX_WRITEV);
+
+#if PLATFORM_IS_WINDOWS
+
+	WSABUF bufs[IS_SOCKET_MAX_WRITEV];
+	for (int i = 0; i < count; i++)
+	{
+		bufs[i].buf = (char*)data[i];
+		bufs[i].len = (ULONG)dataLength[i];
+	}
+	DWORD writeCount = 0;
+	if (WSASend(socket, bufs, (DWORD)count, &writeCount, 0, NULL, NULL) == SOCKET_ERROR)
+	{
+		return (WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1);
+	}
+	return (int)writeCount;
+
+#else
+
+	struct iovec iov[IS_SOCKET_MAX_WRITEV];
+	for (int i = 0; i < count; i++)
+	{
+		iov[i].iov_base = (void*)data[i];
+		iov[i].iov_len = (size_t)dataLength[i];
+	}
+	struct msghdr msg = {};
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+	int flags = MSG_DONTWAIT;
+#if PLATFORM_IS_LINUX || PLATFORM_IS_APPLE
+	flags |= MSG_NOSIGNAL;
+#endif
+	ssize_t writeCount = sendmsg(socket, &msg, flags);
+	if (writeCount < 0)
+	{
+		return ((errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -1);
+	}
+	return (int)writeCount;
+
+#endif
+
+}
+
 int ISSocketRead(socket_t socket, uint8_t* data, int dataLength)
 {
 	int count = recv(socket, (char*)data, dataLength, 0);
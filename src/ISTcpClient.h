@@ -20,6 +20,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #define IS_SOCKET_DEFAULT_TIMEOUT_MS 5000
 
+// max buffers written by one ISSocketWriteV() call
+#define IS_SOCKET_MAX_WRITEV 64
+
 
 class cISTcpClient : public cISStream
 {
@@ -80,6 +83,12 @@ public:
 	*/
 	bool IsOpen() { return m_socket != 0; }
 
+	/**
+	* Get the client socket, i.e. to wait on for received data
+	* @return the socket, 0 if not open
+	*/
+	socket_t Socket() { return m_socket; }
+
 	/**
 	* Get whether the client socket is blocking - blocking reads do not return until the data is read or a timeout occurs. Default is false.
 	* @return whether the client is a blocking socket
@@ -142,6 +151,16 @@ int ISSocketCanRead(socket_t socket, int timeoutMilliseconds = IS_SOCKET_DEFAULT
 */
 int ISSocketWrite(socket_t socket, const uint8_t* data, int dataLength);
 
+/**
+* Write several buffers to a non-blocking socket with one system call (writev) without waiting
+* @param socket the socket to write to
+* @param data the buffers to write
+* @param dataLength the number of bytes in each buffer
+* @param count the number of buffers, at most IS_SOCKET_MAX_WRITEV are written
+* @return the number of bytes written, 0 if the socket is not ready for writing, or less than 0 if error, in which case the socket is probably disconnected
+*/
+int ISSocketWriteV(socket_t socket, const uint8_t* const* data, const int* dataLength, int count);
+
 /**
 * Read data from a socket
 * @param socket the socket to read from
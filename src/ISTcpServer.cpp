@@ -25,6 +25,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #endif
 
+#include <algorithm>
+
 #include "ISTcpServer.h"
 #include "ISUtilities.h"
 
@@ -37,6 +39,10 @@ cISTcpServer::cISTcpServer(iISTcpServerDelegate* delegate)
 	m_delegate = delegate;
 	m_socket = 0;
 	m_port = 0;
+	m_clientQueueMax = TCP_SERVER_CLIENT_QUEUE_MAX;
+	m_slowClientPolicy = SLOW_CLIENT_DROP;
+	m_slowClientDisconnects = 0;
+	m_casterMode = false;
 }
 
 cISTcpServer::~cISTcpServer()
@@ -102,6 +108,16 @@ int cISTcpServer::Open(const string& ipAddress, int port)
 
 	freeaddrinfo(result);
 
+	if (m_port == 0)
+	{	// Port chosen by the system
+		sockaddr_in addr = {};
+		socklen_t addrLength = sizeof(addr);
+		if (getsockname(m_socket, (sockaddr*)&addr, &addrLength) == 0)
+		{
+			m_port = ntohs(addr.sin_port);
+		}
+	}
+
 	status = listen(m_socket, SOMAXCONN);
 	if (status != 0)
 	{
@@ -109,6 +125,11 @@ int cISTcpServer::Open(const string& ipAddress, int port)
 		return -1;
 	}
 
+	if (m_casterMode)
+	{	// Accept until no connections are pending
+		ISSocketSetBlocking(m_socket, false);
+	}
+
 	return status;
 }
 
@@ -120,11 +141,76 @@ int cISTcpServer::Close()
 		status |= ISSocketClose(m_clients[i]);
 	}
 	m_clients.clear();
+	m_clientQueues.clear();
+	m_mountpointClients.assign(m_mountpoints.size(), 0);
+	m_reactor.Invalidate();
 	return status;
 }
 
+bool cISTcpServer::SetCasterMode(bool enable)
+{
+	if (enable)
+	{
+		m_casterMode = (m_reactor.IsOpen() || m_reactor.Open());
+		if (m_casterMode && IsOpen())
+		{
+			ISSocketSetBlocking(m_socket, false);
+		}
+	}
+	else
+	{
+		m_reactor.Close();
+		m_casterMode = false;
+	}
+	return m_casterMode;
+}
+
+void cISTcpServer::AddClient(socket_t socket)
+{
+	ISSocketSetBlocking(socket, false);
+	m_clients.push_back(socket);
+	m_clientQueues.emplace_back(new sClientQueue());
+	m_clientQueues.back()->stats.socket = socket;
+	m_clientQueues.back()->stats.connectTimeMs = current_timeMs();
+	m_clientQueues.back()->stats.mountpoint = -1;
+	if (m_mountpoints.empty())
+	{	// Otherwise subscribed once the NTRIP request is handled, so no data is sent before the response
+		Subscribe(*m_clientQueues.back(), 0);
+	}
+	if (m_delegate != NULLPTR)
+	{
+		m_delegate->OnClientConnected(this, socket);
+	}
+}
+
+void cISTcpServer::RemoveClient(size_t index)
+{
+	if (m_delegate != NULLPTR)
+	{
+		m_delegate->OnClientDisconnected(this, m_clients[index]);
+	}
+	if (m_casterMode)
+	{
+		m_reactor.Unwatch(index + 1);
+	}
+	ISSocketClose(m_clients[index]);
+	Subscribe(*m_clientQueues[index], -1);
+
+	// Move the last client into the slot so only one epoll slot changes
+	m_clients[index] = m_clients.back();
+	m_clients.pop_back();
+	m_clientQueues[index].swap(m_clientQueues.back());
+	m_clientQueues.pop_back();
+}
+
 void cISTcpServer::Update()
 {
+	if (m_casterMode)
+	{
+		UpdateCaster();
+		return;
+	}
+
 	uint8_t readBuff[8192];
 
 	// accept new sockets
@@ -137,12 +223,7 @@ void cISTcpServer::Update()
 		socket_t socket = accept(m_socket, NULLPTR, NULLPTR);
 		if (socket != 0)
 		{
-			ISSocketSetBlocking(socket, false);
-			m_clients.push_back(socket);
-			if (m_delegate != NULLPTR)
-			{
-				m_delegate->OnClientConnected(this, socket);
-			}
+			AddClient(socket);
 		}
 		else if (m_delegate != NULLPTR)
 		{
@@ -158,50 +239,418 @@ void cISTcpServer::Update()
 			if ((count = ISSocketRead(m_clients[i], readBuff, sizeof(readBuff))) < 0)
 			{
 				// remove the client
-				if (m_delegate != NULLPTR)
-				{
-					m_delegate->OnClientDisconnected(this, m_clients[i]);
-				}
-				ISSocketClose(m_clients[i]);
-				m_clients.erase(m_clients.begin() + i--);
+				RemoveClient(i--);
 			}
-			else if (count > 0 && m_delegate != NULLPTR)
+			else if (count > 0 && !ClientDataReceived(i, readBuff, count))
 			{
-				m_delegate->OnClientDataReceived(this, m_clients[i], readBuff, count);
+				RemoveClient(i--);
 			}
 		}
 	}
+
+	CheckRequestTimeouts();
+	Flush();
 }
 
-int cISTcpServer::Write(const void* data, int dataLength)
+void cISTcpServer::WatchClients()
 {
+	// Listening socket and clients, clients with queued data are also watched for writability.  Only changed
+	// slots are updated in the epoll set, so EventFd() wakes a waiting caller once a slow client can take more data.
+	m_reactorFds.assign(1, (int)m_socket);
+	m_reactorWritable.assign(1, 0);
 	for (size_t i = 0; i < m_clients.size(); i++)
 	{
-		int written = 0;
-		int count;
-		while (written < dataLength)
+		m_reactorFds.push_back((int)m_clients[i]);
+		m_reactorWritable.push_back(m_clientQueues[i]->frames.size() != 0);
+	}
+	m_reactor.Watch(m_reactorFds, m_reactorWritable);
+}
+
+void cISTcpServer::UpdateCaster()
+{
+	CheckRequestTimeouts();
+	WatchClients();
+	if (m_reactor.Wait(0, m_reactorReady) <= 0)
+	{
+		return;
+	}
+
+	// Last to first, so a client moved into the slot of a removed client has already been handled
+	uint8_t readBuff[8192];
+	for (size_t slot = m_reactorReady.size() - 1; slot > 0; slot--)
+	{
+		size_t i = slot - 1;
+		if (m_reactorReady[slot] & IS_REACTOR_READABLE)
 		{
-			count = ISSocketWrite(m_clients[i], ((uint8_t*)data) + written, dataLength - written);
-			if (count < 1)
+			int count = ISSocketRead(m_clients[i], readBuff, sizeof(readBuff));
+			if (count <= 0)
+			{	// Readable without data is the end of the stream
+				RemoveClient(i);
+				continue;
+			}
+			if (!ClientDataReceived(i, readBuff, count))
 			{
-				// remove the client
-				if (m_delegate != NULLPTR)
-				{
-					m_delegate->OnClientDisconnected(this, m_clients[i]);
-				}
-				ISSocketClose(m_clients[i]);
-				m_clients.erase(m_clients.begin() + i--);
-				break;
+				RemoveClient(i);
+				continue;
+			}
+		}
+		if ((m_reactorReady[slot] & IS_REACTOR_WRITABLE) && !FlushClient(*m_clientQueues[i]))
+		{
+			RemoveClient(i);
+		}
+	}
+
+	if (m_reactorReady[0])
+	{	// Accept all pending connections
+		socket_t socket;
+		while ((socket = accept(m_socket, NULLPTR, NULLPTR)) != (socket_t)-1 && socket != 0)
+		{
+			if (m_delegate != NULLPTR)
+			{
+				m_delegate->OnClientConnecting(this);
+			}
+			AddClient(socket);
+		}
+	}
+
+	// Clear write interest of clients whose queues were sent
+	WatchClients();
+}
+
+bool cISTcpServer::ClientDataReceived(size_t index, uint8_t* data, int dataLength)
+{
+	sClientQueue& client = *m_clientQueues[index];
+	if (client.requestPending && m_mountpoints.size())
+	{
+		client.request.append((const char*)data, dataLength);
+		size_t prefixSize = (client.request.size() < 4 ? client.request.size() : 4);
+		if (client.request.compare(0, prefixSize, "GET ", prefixSize) != 0)
+		{	// Not an NTRIP request, the client receives the first mountpoint
+			client.requestPending = false;
+			Subscribe(client, 0);
+			string received;
+			received.swap(client.request);
+			if (m_delegate != NULLPTR)
+			{
+				m_delegate->OnClientDataReceived(this, m_clients[index], (uint8_t*)&received[0], (int)received.size());
+			}
+			return true;
+		}
+
+		size_t end = client.request.find("\r\n\r\n");
+		if (end == string::npos)
+		{	// Wait for the rest of the header
+			return client.request.size() <= TCP_SERVER_REQUEST_MAX;
+		}
+		client.requestPending = false;
+		string received;
+		received.swap(client.request);
+		if (!HandleRequest(client, received.substr(0, end)))
+		{
+			return false;
+		}
+
+		// Anything after the header, i.e. GGA sentences from the rover
+		data = (uint8_t*)&received[end + 4];
+		dataLength = (int)(received.size() - end - 4);
+	}
+
+	if (dataLength > 0 && m_delegate != NULLPTR)
+	{
+		m_delegate->OnClientDataReceived(this, m_clients[index], data, dataLength);
+	}
+	return true;
+}
+
+bool cISTcpServer::HandleRequest(sClientQueue& client, const string& request)
+{
+	// GET /<mountpoint> HTTP/1.1
+	size_t start = request.find('/');
+	size_t end = request.find_first_of(" \r", start);
+	string name = (start == string::npos ? string() : request.substr(start + 1, end - start - 1));
+	int mountpoint = (int)(find(m_mountpoints.begin(), m_mountpoints.end(), name) - m_mountpoints.begin());
+
+	string response;
+	if (mountpoint < (int)m_mountpoints.size())
+	{
+		response = "ICY 200 OK\r\n\r\n";
+	}
+	else
+	{	// Unknown or no mountpoint, send the source table and disconnect
+		response = SourceTable();
+		mountpoint = -1;
+		client.closeWhenSent = true;
+	}
+
+	// Data queued after a request timeout is dropped so the response comes next, except a partially sent frame
+	while (client.frames.size() > (client.frontOffset ? 1u : 0u))
+	{
+		client.stats.bytesQueued -= client.frames.back()->size();
+		client.stats.lagBytes -= (uint32_t)client.frames.back()->size();
+		client.frames.pop_back();
+	}
+	Subscribe(client, mountpoint);
+
+	client.frames.push_back(NewFrame(response.data(), (int)response.size()));
+	client.stats.bytesQueued += response.size();
+	client.stats.lagBytes += (uint32_t)response.size();
+	return FlushClient(client);
+}
+
+void cISTcpServer::CheckRequestTimeouts()
+{
+	if (m_mountpoints.empty())
+	{
+		return;
+	}
+
+	// Clients that haven't started a request, i.e. plain TCP clients, receive the first mountpoint.  A later
+	// request still selects a mountpoint.
+	uint32_t timeMs = current_timeMs();
+	for (size_t i = 0; i < m_clientQueues.size(); i++)
+	{
+		sClientQueue& client = *m_clientQueues[i];
+		if (client.requestPending && client.request.empty() && client.stats.mountpoint < 0 && 
+			timeMs - client.stats.connectTimeMs >= TCP_SERVER_REQUEST_TIMEOUT_MS)
+		{
+			Subscribe(client, 0);
+		}
+	}
+}
+
+void cISTcpServer::Subscribe(sClientQueue& client, int mountpoint)
+{
+	if (client.stats.mountpoint >= 0 && client.stats.mountpoint < (int)m_mountpointClients.size())
+	{
+		m_mountpointClients[client.stats.mountpoint]--;
+	}
+	client.stats.mountpoint = mountpoint;
+	if (mountpoint >= 0 && mountpoint < (int)m_mountpointClients.size())
+	{
+		m_mountpointClients[mountpoint]++;
+	}
+}
+
+int cISTcpServer::AddMountpoint(const string& name)
+{
+	if (name.empty() || find(m_mountpoints.begin(), m_mountpoints.end(), name) != m_mountpoints.end())
+	{
+		return -1;
+	}
+	m_mountpoints.push_back(name);
+	m_mountpointClients.push_back(0);
+	if (m_mountpoints.size() == 1)
+	{	// Clients already connected are on the first mountpoint
+		for (size_t i = 0; i < m_clientQueues.size(); i++)
+		{
+			m_mountpointClients[0] += (m_clientQueues[i]->stats.mountpoint == 0);
+		}
+	}
+	return (int)m_mountpoints.size() - 1;
+}
+
+void cISTcpServer::ClearMountpoints()
+{
+	m_mountpoints.clear();
+	m_mountpointClients.clear();
+	for (size_t i = 0; i < m_clientQueues.size(); i++)
+	{
+		if (!m_clientQueues[i]->closeWhenSent)
+		{
+			m_clientQueues[i]->stats.mountpoint = 0;
+		}
+	}
+}
+
+string cISTcpServer::SourceTable()
+{
+	// https://igs.bkg.bund.de/root_ftp/NTRIP/documentation/NtripDocumentation.pdf
+	string table;
+	for (size_t i = 0; i < m_mountpoints.size(); i++)
+	{
+		table += "STR;" + m_mountpoints[i] + ";" + m_mountpoints[i] + ";RTCM 3;;2;GNSS;;;0.00;0.00;0;0;Inertial Sense;none;N;N;0;\r\n";
+	}
+	table += "ENDSOURCETABLE\r\n";
+	return "SOURCETABLE 200 OK\r\nServer: NTRIP Inertial Sense\r\nContent-Type: text/plain\r\nContent-Length: " + 
+		to_string(table.size()) + "\r\n\r\n" + table;
+}
+
+cISTcpServer::frame_ptr_t cISTcpServer::NewFrame(const void* data, int dataLength)
+{
+	shared_ptr<vector<uint8_t>> frame;
+	if (m_framePool.size() && m_framePool.front().use_count() == 1)
+	{	// All clients are done with the oldest frame, reuse it
+		frame.swap(m_framePool.front());
+		m_framePool.pop_front();
+	}
+	else
+	{
+		if (m_framePool.size() >= TCP_SERVER_FRAME_POOL_SIZE)
+		{	// Held by a slow client, freed once sent
+			m_framePool.pop_front();
+		}
+		frame = make_shared<vector<uint8_t>>();
+	}
+
+	// Only allocates if larger than any data previously held by the frame
+	frame->assign((const uint8_t*)data, (const uint8_t*)data + dataLength);
+	m_framePool.push_back(frame);
+	return frame;
+}
+
+int cISTcpServer::Write(const void* data, int dataLength)
+{
+	return Write(data, dataLength, -1);
+}
+
+int cISTcpServer::Write(const void* data, int dataLength, int mountpoint)
+{
+	if (dataLength <= 0 || m_clients.empty() || (mountpoint >= 0 && MountpointClients(mountpoint) == 0))
+	{
+		return dataLength;
+	}
+
+	// one copy shared by all client queues
+	frame_ptr_t frame = NewFrame(data, dataLength);
+
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		sClientQueue& client = *m_clientQueues[i];
+		if (client.stats.mountpoint < 0 || (mountpoint >= 0 && client.stats.mountpoint != mountpoint))
+		{	// Not subscribed
+			continue;
+		}
+		if (client.frames.size() && client.stats.lagBytes + (uint32_t)dataLength > m_clientQueueMax)
+		{	// Client is too far behind
+			if (m_slowClientPolicy == SLOW_CLIENT_DISCONNECT)
+			{
+				m_slowClientDisconnects++;
+				RemoveClient(i--);
 			}
 			else
 			{
-				written += count;
-				if (written == dataLength)
-				{
-					break;
-				}
+				client.stats.bytesDropped += dataLength;
+				client.stats.writesDropped++;
+			}
+			continue;
+		}
+
+		client.frames.push_back(frame);
+		client.stats.bytesQueued += dataLength;
+		client.stats.lagBytes += dataLength;
+		client.stats.lagMaxBytes = _MAX(client.stats.lagMaxBytes, client.stats.lagBytes);
+		if (!FlushClient(client))
+		{
+			RemoveClient(i--);
+		}
+	}
+
+	if (m_casterMode)
+	{	// Watch clients left with queued data for writability
+		WatchClients();
+	}
+	return dataLength;
+}
+
+int cISTcpServer::Flush()
+{
+	int queued = 0;
+	for (size_t i = 0; i < m_clients.size(); i++)
+	{
+		if (m_clientQueues[i]->frames.size() && !FlushClient(*m_clientQueues[i]))
+		{
+			RemoveClient(i--);
+			continue;
+		}
+		queued += m_clientQueues[i]->stats.lagBytes;
+	}
+
+	if (m_casterMode)
+	{
+		WatchClients();
+	}
+	return queued;
+}
+
+bool cISTcpServer::FlushClient(sClientQueue& client)
+{
+	const uint8_t* data[IS_SOCKET_MAX_WRITEV];
+	int dataLength[IS_SOCKET_MAX_WRITEV];
+
+	while (client.frames.size())
+	{
+		// Gather queued frames into one write
+		int count = 0;
+		int total = 0;
+		for (deque<frame_ptr_t>::const_iterator it = client.frames.begin(); it != client.frames.end() && count < IS_SOCKET_MAX_WRITEV; it++, count++)
+		{
+			uint32_t offset = (count == 0 ? client.frontOffset : 0);
+			data[count] = (*it)->data() + offset;
+			dataLength[count] = (int)((*it)->size() - offset);
+			total += dataLength[count];
+		}
+
+		int written = ISSocketWriteV(client.stats.socket, data, dataLength, count);
+		if (written < 0)
+		{
+			return false;
+		}
+		client.stats.bytesSent += written;
+		client.stats.lagBytes -= written;
+
+		// Release sent frames
+		for (int remaining = written; remaining > 0; )
+		{
+			int frontSize = (int)(client.frames.front()->size() - client.frontOffset);
+			if (remaining < frontSize)
+			{
+				client.frontOffset += remaining;
+				break;
 			}
+			remaining -= frontSize;
+			client.frames.pop_front();
+			client.frontOffset = 0;
 		}
+
+		if (written < total)
+		{	// Socket buffer is full, wait until it is writable
+			break;
+		}
+	}
+	return !(client.closeWhenSent && client.frames.empty());
+}
+
+vector<tcp_server_client_stats_t> cISTcpServer::ClientStats()
+{
+	vector<tcp_server_client_stats_t> stats;
+	for (size_t i = 0; i < m_clientQueues.size(); i++)
+	{
+		stats.push_back(m_clientQueues[i]->stats);
+	}
+	return stats;
+}
+
+string cISTcpServer::ClientStatsSummary()
+{
+	string str;
+	char buf[256];
+	uint32_t timeMs = current_timeMs();
+
+	SNPRINTF(buf, sizeof(buf), "TCP server clients: %d  (slow client disconnects %d) _____\n", (int)m_clients.size(), (int)m_slowClientDisconnects);
+	str.append(buf);
+	if (m_clients.empty())
+	{
+		return str;
+	}
+	str.append(" Socket     kB/s   Sent kB  Lag kB  Max lag kB  Dropped kB  Mountpoint\n");
+	for (size_t i = 0; i < m_clientQueues.size(); i++)
+	{
+		const tcp_server_client_stats_t& s = m_clientQueues[i]->stats;
+		uint32_t dtMs = _MAX(timeMs - s.connectTimeMs, 1u);
+		const char* mountpoint = (s.mountpoint >= 0 && s.mountpoint < (int)m_mountpoints.size() ? m_mountpoints[s.mountpoint].c_str() : "");
+		SNPRINTF(buf, sizeof(buf), "%7d %8.1f %9.1f %7.1f %11.1f %11.1f  %s\n", (int)s.socket, 
+			(double)s.bytesSent / dtMs, s.bytesSent * 0.001, s.lagBytes * 0.001, s.lagMaxBytes * 0.001, s.bytesDropped * 0.001, mountpoint);
+		str.append(buf);
 	}
-	return dataLength; // TODO: Maybe be smarter about detecting difference in bytes written for each client
+	return str;
 }
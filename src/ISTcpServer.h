@@ -16,8 +16,56 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <string>
 #include <inttypes.h>
 #include <vector>
+#include <deque>
+#include <memory>
 
 #include "ISTcpClient.h"
+#include "ISReactor.h"
+
+// default max bytes queued for a client before the slow client policy applies
+#define TCP_SERVER_CLIENT_QUEUE_MAX     (256 * 1024)
+
+// max frames kept for reuse by Write()
+#define TCP_SERVER_FRAME_POOL_SIZE      1024
+
+// max size of an NTRIP request header, larger requests disconnect the client
+#define TCP_SERVER_REQUEST_MAX          2048
+
+// time a client has to start an NTRIP request before it is subscribed to the first mountpoint
+#define TCP_SERVER_REQUEST_TIMEOUT_MS   1000
+
+/**
+* Per client output statistics
+*/
+typedef struct
+{
+	/** Client socket */
+	socket_t socket;
+
+	/** Time the client connected (ms) */
+	uint32_t connectTimeMs;
+
+	/** Bytes queued for the client */
+	uint64_t bytesQueued;
+
+	/** Bytes written to the client socket */
+	uint64_t bytesSent;
+
+	/** Bytes not queued because the client was too far behind */
+	uint64_t bytesDropped;
+
+	/** Writes not queued because the client was too far behind */
+	uint32_t writesDropped;
+
+	/** Bytes waiting in the queue, i.e. how far the client is behind */
+	uint32_t lagBytes;
+
+	/** Largest lagBytes */
+	uint32_t lagMaxBytes;
+
+	/** Index of the mountpoint the client is subscribed to, -1 if none */
+	int32_t mountpoint;
+} tcp_server_client_stats_t;
 
 class cISTcpServer;
 
@@ -85,6 +133,13 @@ protected:
 class cISTcpServer : public cISStream
 {
 public:
+	/** What Write() does when a client has more than the max bytes queued */
+	enum eSlowClientPolicy
+	{
+		SLOW_CLIENT_DROP = 0,		// drop the write for that client, it may catch up later
+		SLOW_CLIENT_DISCONNECT,		// disconnect the client
+	};
+
 	/**
 	* Constructor
 	*/
@@ -98,7 +153,7 @@ public:
 	/**
 	* Closes, then opens a tcp server
 	* @param ipAddress the ip address to bind to, empty for auto
-	* @param port the port to bind to
+	* @param port the port to bind to, 0 for any free port (see Port())
 	* @return 0 if success, otherwise an error code
 	*/
 	int Open(const std::string& ipAddress, int port);
@@ -110,18 +165,108 @@ public:
 	int Close();
 
 	/**
-	* Update the server, receive connections, etc. Any clients that are disconnected will be closed and removed.
+	* Caster mode waits on the listening socket and all clients with one epoll set instead of polling each
+	* socket, for serving hundreds of clients.
+	* @param enable true to enable caster mode
+	* @return true if caster mode is enabled, false if disabled or not supported on this platform
+	*/
+	bool SetCasterMode(bool enable);
+
+	bool CasterMode() { return m_casterMode; }
+
+	/**
+	* Get a descriptor that is readable when Update() has work to do, i.e. to wait on with other ports
+	* @return the caster mode epoll descriptor, or -1 if not in caster mode
+	*/
+	int EventFd() { return (m_casterMode ? m_reactor.Fd() : -1); }
+
+	/**
+	* Update the server, receive connections, send queued data, etc. Any clients that are disconnected will be closed and removed.
 	*/
 	void Update();
 
 	/**
-	* Write data to all connected clients - any clients that are disconnected will be closed and removed
+	* Queue data for all connected clients and send as much as each client socket accepts without blocking.
+	* The data is copied once into a pooled, reference counted frame shared by the client queues.  Any clients
+	* that are disconnected will be closed and removed.
 	* @param data the data to write
 	* @param dataLength the number of bytes in data
 	* @return the number of bytes written
 	*/
 	int Write(const void* data, int dataLength);
 
+	/**
+	* Queue data for the clients subscribed to a mountpoint, see Write(data, dataLength).  Nothing is copied
+	* if the mountpoint has no clients.
+	* @param data the data to write
+	* @param dataLength the number of bytes in data
+	* @param mountpoint the mountpoint index from AddMountpoint()
+	* @return the number of bytes written
+	*/
+	int Write(const void* data, int dataLength, int mountpoint);
+
+	/**
+	* Add an NTRIP mountpoint.  Clients select a mountpoint with an NTRIP request (GET /<mountpoint>), clients that
+	* request an unknown mountpoint receive the source table and are disconnected.  Clients receive no data until the
+	* response is sent.  Clients that send something other than a request, or nothing for TCP_SERVER_REQUEST_TIMEOUT_MS,
+	* receive the first mountpoint.  Without mountpoints all clients receive all data.
+	* @param name the mountpoint name, case sensitive
+	* @return the mountpoint index, -1 if the name is empty or already used
+	*/
+	int AddMountpoint(const std::string& name);
+
+	/**
+	* Remove all mountpoints, clients are moved to the first mountpoint added afterwards
+	*/
+	void ClearMountpoints();
+
+	const std::vector<std::string>& Mountpoints() { return m_mountpoints; }
+
+	/**
+	* Get the number of clients subscribed to a mountpoint
+	* @param mountpoint the mountpoint index from AddMountpoint()
+	*/
+	uint32_t MountpointClients(int mountpoint) { return (mountpoint >= 0 && mountpoint < (int)m_mountpointClients.size() ? m_mountpointClients[mountpoint] : 0); }
+
+	/**
+	* Get the NTRIP source table response listing the mountpoints
+	*/
+	std::string SourceTable();
+
+	/**
+	* Send queued data to clients whose sockets are ready, without blocking
+	* @return the number of bytes still queued for all clients
+	*/
+	int Flush() OVERRIDE;
+
+	/**
+	* Set the max bytes queued per client and what happens to clients that fall further behind
+	* @param maxBytes max bytes queued per client
+	* @param policy drop writes for or disconnect slow clients
+	*/
+	void SetClientQueueLimit(uint32_t maxBytes, eSlowClientPolicy policy = SLOW_CLIENT_DROP) { m_clientQueueMax = maxBytes; m_slowClientPolicy = policy; }
+
+	/**
+	* Get whether a client has queued data, i.e. should be watched for writability
+	* @param index the index of the client in Clients()
+	*/
+	bool ClientHasQueuedData(size_t index) { return index < m_clientQueues.size() && m_clientQueues[index]->frames.size(); }
+
+	/**
+	* Get output statistics for each client, in the same order as Clients()
+	*/
+	std::vector<tcp_server_client_stats_t> ClientStats();
+
+	/**
+	* Get a summary of the client output statistics
+	*/
+	std::string ClientStatsSummary();
+
+	/**
+	* Number of clients disconnected because they fell too far behind
+	*/
+	uint32_t SlowClientDisconnects() { return m_slowClientDisconnects; }
+
 	/**
 	* Get whether the server is open
 	* @return true if server open, false if not
@@ -136,15 +281,67 @@ public:
 
 	/**
 	* Get port number
-	* @return int port number
+	* @return int port number, the bound port if opened with port 0
 	*/
 	int32_t Port() { return m_port; }
 
+	/**
+	* Get the listening socket, i.e. to wait on for new connections
+	* @return the socket, 0 if not open
+	*/
+	socket_t Socket() { return m_socket; }
+
+	/**
+	* Get the connected client sockets.  When a client is removed the last client takes its place.
+	* @return the client sockets
+	*/
+	const std::vector<socket_t>& Clients() { return m_clients; }
+
 private:
 	cISTcpServer(const cISTcpServer& copy); // Disable copy constructor
 
+	typedef std::shared_ptr<const std::vector<uint8_t>> frame_ptr_t;
+
+	struct sClientQueue
+	{
+		std::deque<frame_ptr_t> frames;
+		uint32_t frontOffset = 0;		// bytes of the front frame already sent
+		tcp_server_client_stats_t stats = {};
+		bool requestPending = true;		// an NTRIP request may still be received
+		bool closeWhenSent = false;		// disconnect once the queue is sent, i.e. after the source table
+		std::string request;			// NTRIP request header received so far
+	};
+
+	void AddClient(socket_t socket);
+	void RemoveClient(size_t index);
+	void UpdateCaster();
+	void WatchClients();
+	frame_ptr_t NewFrame(const void* data, int dataLength);
+	void Subscribe(sClientQueue& client, int mountpoint);
+
+	// returns false if the client should be disconnected
+	bool ClientDataReceived(size_t index, uint8_t* data, int dataLength);
+	bool HandleRequest(sClientQueue& client, const std::string& request);
+	void CheckRequestTimeouts();
+
+	// returns false if the client disconnected
+	bool FlushClient(sClientQueue& client);
+
 	socket_t m_socket;
 	std::vector<socket_t> m_clients;
+	std::vector<std::unique_ptr<sClientQueue>> m_clientQueues;	// same order as m_clients
+	uint32_t m_clientQueueMax;
+	eSlowClientPolicy m_slowClientPolicy;
+	uint32_t m_slowClientDisconnects;
+	std::deque<std::shared_ptr<std::vector<uint8_t>>> m_framePool;	// oldest first, free when only the pool holds a reference
+	std::vector<std::string> m_mountpoints;
+	std::vector<uint32_t> m_mountpointClients;	// clients subscribed to each mountpoint
+
+	bool m_casterMode;
+	cISReactor m_reactor;
+	std::vector<int> m_reactorFds;				// slots: listening socket, clients
+	std::vector<uint8_t> m_reactorWritable;
+	std::vector<uint8_t> m_reactorReady;
 	std::string m_ipAddress;
 	int32_t m_port;
 	iISTcpServerDelegate* m_delegate;
@@ -162,13 +162,21 @@ InertialSense::~InertialSense()
 	DisableLogging();
 }
 
-bool InertialSense::EnableLogging(const string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const string& subFolder)
+bool InertialSense::EnableLogging(const string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const string& subFolder, cLogPacketQueue::eOverflowPolicy queuePolicy)
 {
-    cMutexLocker logMutexLocker(&m_logMutex);
     if (!m_logger.InitSaveTimestamp(subFolder, path, cISLogger::g_emptyString, logType, maxDiskSpacePercent, maxFileSize, subFolder.length() != 0))
     {
         return false;
     }
+
+    // Queues are created before logging is enabled, as StepLogger() starts pushing as soon as it is
+    {
+        cMutexLocker lock(&m_logQueuesMutex);
+        m_logQueues.clear();
+    }
+    m_logQueuePolicy = queuePolicy;
+    AddLogQueues();
+
     m_logger.EnableLogging(true);
     for (auto& d : m_comManagerState.devices)
     {
@@ -186,6 +194,7 @@ void InertialSense::DisableLogging()
 	if (m_logger.Enabled() || m_logThread != NULLPTR)
 	{
 		m_logger.EnableLogging(false);
+		m_logWakeEvent.Signal();
 		printf("Disabling logger...");
 		fflush(stdout);
 
@@ -196,6 +205,17 @@ void InertialSense::DisableLogging()
 	}
 }
 
+void InertialSense::AddLogQueues()
+{
+    // Devices opened after logging was enabled get a queue at their pHandle
+    cMutexLocker lock(&m_logQueuesMutex);
+    while (m_logQueues.size() < m_comManagerState.devices.size())
+    {
+        m_logQueues.push_back(std::unique_ptr<cLogPacketQueue>(new cLogPacketQueue(LOG_QUEUE_DEFAULT_SIZE, m_logQueuePolicy)));
+        m_logQueues.back()->SetWakeup(&m_logWakeEvent, m_logWakeBytes, m_logWakePackets);
+    }
+}
+
 void InertialSense::LogRawData(ISDevice* device, int dataSize, const uint8_t* data)
 {
     m_logger.LogData(device->devLogger, dataSize, data);
@@ -238,6 +258,10 @@ void InertialSense::RemoveDevice(size_t index)
         return;
     }
 
+    if (index < m_rxThreads.size())
+    {
+        m_rxThreads[index]->Stop();
+    }
     serialPortClose(&m_comManagerState.devices[index].serialPort);
 }
 
@@ -246,47 +270,36 @@ void InertialSense::LoggerThread(void* info)
     bool running = true;
     InertialSense* inertialSense = (InertialSense*)info;
 
-    // gather up packets in memory
-    map<int, vector<p_data_buf_t>> packets;
-
     while (running)
     {
-        SLEEP_MS(20);
-        {
-            // lock so we can read and clear m_logPackets
-            cMutexLocker logMutexLocker(&inertialSense->m_logMutex);
-            for (map<int, vector<p_data_buf_t>>::iterator i = inertialSense->m_logPackets.begin(); i != inertialSense->m_logPackets.end(); i++)
-            {
-                packets[i->first] = i->second;
-            }
-
-            // clear shared memory
-            inertialSense->m_logPackets.clear();
+        // sleep until a queue reaches its wake threshold, or timeout to flush data at low rates
+        inertialSense->m_logWakeEvent.Wait(LOG_QUEUE_WAKE_TIMEOUT_MS);
 
-            // update running state
-            running = inertialSense->m_logger.Enabled();
-        }
+        // update running state
+        running = inertialSense->m_logger.Enabled();
 
-        if (running)
+        log_queue_stats_t stats = {};
+        inertialSense->m_logQueuesMutex.Lock();
+        for (size_t i = 0; i < inertialSense->m_logQueues.size(); i++)
         {
-            // log the packets
-            for (map<int, vector<p_data_buf_t>>::iterator i = packets.begin(); i != packets.end(); i++)
-            {
-                if (inertialSense->m_logger.GetType() != cISLogger::LOGTYPE_RAW) {
-                    size_t numPackets = i->second.size();
-                    for (size_t j = 0; j < numPackets; j++) {
-                        auto device = inertialSense->m_comManagerState.devices[i->first];
-                        if (!inertialSense->m_logger.LogData(device.devLogger, &i->second[j].hdr, i->second[j].buf)) {
-                            // Failed to write to log
-                            SLEEP_MS(20); // FIXME:  This maybe problematic, as it may unnecessarily delay the thread, leading run-away memory usage.
-                        }
-                    }
-                }
+            cLogPacketQueue& queue = *inertialSense->m_logQueues[i];
 
-                // clear all log data for this pHandle
-                i->second.clear();
+            // log the packets, resolving the device logger once per batch
+            if (running && i < inertialSense->m_comManagerState.devices.size())
+            {
+                std::shared_ptr<cDeviceLog> devLogger = inertialSense->m_comManagerState.devices[i].devLogger;
+                inertialSense->m_logger.LogQueuedData(devLogger, queue);
             }
+
+            log_queue_stats_t s = queue.Stats();
+            stats.pushCount += s.pushCount;
+            stats.dropCount += s.dropCount;
+            stats.blockCount += s.blockCount;
+            stats.highWaterBytes = _MAX(stats.highWaterBytes, s.highWaterBytes);
+            stats.capacityBytes = _MAX(stats.capacityBytes, s.capacityBytes);
         }
+        inertialSense->m_logQueuesMutex.Unlock();
+        inertialSense->m_logger.LogQueueStats(stats);
 
         inertialSense->m_logger.Update();
     }
@@ -296,14 +309,14 @@ void InertialSense::LoggerThread(void* info)
 
 void InertialSense::StepLogger(InertialSense* i, const p_data_t* data, int pHandle)
 {
-    cMutexLocker logMutexLocker(&i->m_logMutex);
-    if (i->m_logger.Enabled())
+    // Called from the thread calling Update().  When the queue is full:
+    //  OVERFLOW_DROP_NEWEST - this packet is dropped and counted, never blocks.
+    //  OVERFLOW_DROP_OLDEST - the oldest queued packets are dropped and counted to make room, never blocks.
+    //  OVERFLOW_BLOCK - waits for the logger thread up to LOG_QUEUE_BLOCK_TIMEOUT_MS, then drops this packet.
+    // LOGTYPE_RAW is written directly from the serial read in LogRawData().
+    if (i->m_logger.Enabled() && i->m_logger.GetType() != cISLogger::LOGTYPE_RAW && (size_t)pHandle < i->m_logQueues.size())
     {
-        p_data_buf_t d;
-        d.hdr = data->hdr;
-        memcpy(d.buf, data->ptr, d.hdr.size);
-        vector<p_data_buf_t>& vec = i->m_logPackets[pHandle];
-        vec.push_back(d);
+        i->m_logQueues[pHandle]->Push(data->hdr, data->ptr);
     }
 }
 
@@ -315,7 +328,8 @@ bool InertialSense::SetLoggerEnabled(
         uint32_t rmcOptions,
         float maxDiskSpacePercent,
         uint32_t maxFileSize,
-        const string& subFolder)
+        const string& subFolder,
+        cLogPacketQueue::eOverflowPolicy queuePolicy)
 {
     if (enable)
     {
@@ -329,7 +343,7 @@ bool InertialSense::SetLoggerEnabled(
         {
             BroadcastBinaryDataRmcPreset(rmcPreset, rmcOptions);
         }
-        return EnableLogging(path, logType, maxDiskSpacePercent, maxFileSize, subFolder);
+        return EnableLogging(path, logType, maxDiskSpacePercent, maxFileSize, subFolder, queuePolicy);
     }
 
     // !enable, shutdown logger gracefully
@@ -387,8 +401,40 @@ bool InertialSense::CreateHost(const string& connectionString)
         return false;
     }
 
+    // One mountpoint per device when mountpoints are named.  Otherwise the first device is sent to all clients
+    // without NTRIP request handling, so rovers requesting any mountpoint receive it.
+    vector<string> mountpoints;
+    if (pieces.size() > 3)
+    {
+        splitString(pieces[3], ',', mountpoints);
+    }
+    m_tcpServer.ClearMountpoints();
+    m_serverStreams.clear();
+    size_t streamCount = (mountpoints.size() ? m_comManagerState.devices.size() : 1);
+    for (size_t i = 0; i < streamCount; i++)
+    {
+        if (mountpoints.size())
+        {
+            string name = (i < mountpoints.size() ? mountpoints[i] : "");
+            if (name.empty())
+            {
+                uint32_t serialNumber = m_comManagerState.devices[i].devInfo.serialNumber;
+                name = (serialNumber ? "IS" + to_string(serialNumber) : "IS_PORT" + to_string(i));
+            }
+            if (m_tcpServer.AddMountpoint(name) < 0)
+            {   // Names must be unique
+                return false;
+            }
+        }
+        m_serverStreams.emplace_back(new sServerStream());
+        is_comm_init(&m_serverStreams.back()->comm, m_serverStreams.back()->buffer, sizeof(m_serverStreams.back()->buffer));
+    }
+
     StopBroadcasts();
 
+    // Wait on all clients with one epoll set where supported
+    m_tcpServer.SetCasterMode(true);
+
     return (m_tcpServer.Open(host, atoi(port.c_str())) == 0);
 }
 
@@ -415,6 +461,8 @@ bool InertialSense::Update()
 
     if (m_tcpServer.IsOpen() && m_comManagerState.devices.size() > 0)
     {
+        // The server reads the serial ports directly
+        StopRxThreads();
         UpdateServer();
     }
     else
@@ -426,44 +474,245 @@ bool InertialSense::Update()
         // task system with serial port read function that does NOT incorporate a timeout.
         if (m_comManagerState.devices.size() > 0)
         {
-            comManagerStep();
-            SyncFlashConfig(m_timeMs);
+            if (m_rxThreadsEnabled)
+            {   // Ports are read by the receive threads, only dispatch and send here
+                StartRxThreads();
+                DispatchRxThreads();
+                comManagerStepTxInstance(comManagerGetGlobal());
+            }
+            else
+            {
+                comManagerStep();
+            }
+            UpdateDevices();
+        }
+    }
+
+    return CloseDisconnectedPorts();
+}
+
+bool InertialSense::Update(uint32_t timeoutMs)
+{
+    if (m_rxThreadsEnabled && !m_tcpServer.IsOpen() && m_comManagerState.devices.size() > 0)
+    {   // Receive threads signal when packets are queued
+        StartRxThreads();
+        m_rxWakeEvent.Wait(timeoutMs);
+        return Update();
+    }
+
+    if (!m_reactor.IsOpen())
+    {
+        return Update();
+    }
+
+    size_t deviceCount = m_comManagerState.devices.size();
+    cISTcpClient* tcpClient = dynamic_cast<cISTcpClient*>(m_clientStream);
+
+    // Ports that cannot be waited on (i.e. serial or file client streams) are read every call, so don't sleep
+    bool pollPorts = (m_clientStream != NULLPTR && tcpClient == NULLPTR);
+
+    m_reactorFds.clear();
+    for (size_t i = 0; i < deviceCount; i++)
+    {
+        if (m_tcpServer.IsOpen() && i >= m_serverStreams.size())
+        {   // Not read by the server, i.e. without mountpoints only the first device is served
+            m_reactorFds.push_back(-1);
+            continue;
+        }
+        serial_port_t* serialPort = &m_comManagerState.devices[i].serialPort;
+        int fd = serialPortPlatformGetFd(serialPort);
+        pollPorts |= (fd < 0 && serialPortIsOpen(serialPort));
+        m_reactorFds.push_back(fd);
+    }
+    m_reactorFds.push_back(tcpClient && tcpClient->IsOpen() ? (int)tcpClient->Socket() : -1);
+    m_reactorWritable.assign(m_reactorFds.size() + 1, 0);
+    if (m_tcpServer.IsOpen() && m_tcpServer.EventFd() >= 0)
+    {   // Caster mode, the server waits on its listening socket and clients with its own epoll set
+        m_reactorFds.push_back(m_tcpServer.EventFd());
+    }
+    else
+    {
+        m_reactorFds.push_back(m_tcpServer.IsOpen() ? (int)m_tcpServer.Socket() : -1);
+        for (size_t i = 0; i < m_tcpServer.Clients().size(); i++)
+        {   // Clients with queued output are drained when their socket is writable
+            m_reactorFds.push_back((int)m_tcpServer.Clients()[i]);
+            m_reactorWritable.push_back(m_tcpServer.ClientHasQueuedData(i));
+        }
+    }
+    m_reactor.Watch(m_reactorFds, m_reactorWritable);
+
+    if (m_reactor.Wait(pollPorts ? 0 : timeoutMs, m_reactorReady) < 0)
+    {
+        return Update();
+    }
+    m_timeMs = current_timeMs();
+
+    if (m_tcpServer.IsOpen() && deviceCount > 0)
+    {   // A device or server socket is readable, or a client socket with queued output is writable
+        if (std::find_if(m_reactorReady.begin(), m_reactorReady.end(), [](uint8_t ready) { return ready != 0; }) != m_reactorReady.end())
+        {
+            UpdateServer();
+        }
+    }
+    else
+    {
+        if (m_reactorReady[deviceCount] || m_clientBufferBytesToSend > 0 || (m_clientStream != NULLPTR && tcpClient == NULLPTR))
+        {
+            UpdateClient();
+        }
+
+        if (deviceCount > 0)
+        {   // Only read ports that have data
+            for (size_t port = 0; port < deviceCount; port++)
+            {
+                if (m_reactorReady[port] || m_reactorFds[port] < 0)
+                {
+                    comManagerStepRxPort((int)port);
+                }
+            }
+            comManagerStepTxInstance(comManagerGetGlobal());
+            UpdateDevices();
+        }
+    }
+
+    return CloseDisconnectedPorts();
+}
+
+void InertialSense::EnableRxThreads(bool enable, uint32_t queueSize)
+{
+    if (!enable || queueSize != m_rxQueueSize)
+    {   // Restarted on the next Update()
+        StopRxThreads();
+    }
+    m_rxThreadsEnabled = enable;
+    m_rxQueueSize = queueSize;
+}
+
+port_rx_stats_t InertialSense::RxThreadStats(int pHandle)
+{
+    if (pHandle < 0 || (size_t)pHandle >= m_rxThreads.size())
+    {
+        return {};
+    }
+    return m_rxThreads[pHandle]->Stats();
+}
+
+void InertialSense::StartRxThreads()
+{
+    if (m_rxThreads.size() == m_comManagerState.devices.size())
+    {
+        return;
+    }
+
+    StopRxThreads();
+    for (size_t i = 0; i < m_comManagerState.devices.size(); i++)
+    {
+        serial_port_t* serialPort = &m_comManagerState.devices[i].serialPort;
+        m_rxThreads.push_back(std::unique_ptr<cISPortRxThread>(new cISPortRxThread((int)i, serialPort, m_rxQueueSize)));
+        if (serialPortIsOpen(serialPort))
+        {
+            m_rxThreads.back()->Start(&m_rxWakeEvent);
+        }
+    }
+}
+
+void InertialSense::StopRxThreads()
+{
+    for (auto& rx : m_rxThreads)
+    {
+        rx->Stop();
+    }
+    m_rxThreads.clear();
+}
 
-            // check if we have an valid instance of the FirmareUpdate class, and if so, call it's Step() function
-            for (auto& device : m_comManagerState.devices) {
-                if (serialPortIsOpen(&(device.serialPort)) && device.fwUpdate.fwUpdater != nullptr) {
-                    device.fwUpdate.fwUpdater->fwUpdate_step();
+void InertialSense::DispatchRxThreads()
+{
+    bool logRaw = m_logger.Enabled() && m_logger.GetType() == cISLogger::LOGTYPE_RAW;
 
-                    if (!device.fwUpdate.inProgress()) {
-                        fwUpdate::update_status_e status = device.fwUpdate.lastStatus;
-                        if (status < fwUpdate::NOT_STARTED) {
-                            // TODO: Report a REAL error
-                            // printf("Error starting firmware update: %s\n", fwUpdater->getSessionStatusName());
-                        }
+    for (auto& rx : m_rxThreads)
+    {
+        int port = rx->Port();
+        rx->SetRawEnabled(logRaw);
+
+        // Raw data is logged here rather than on the receive threads, which would share the logger
+        int size;
+        const uint8_t* raw;
+        while ((raw = rx->FrontRaw(&size)) != NULLPTR)
+        {
+            LogRawData(&m_comManagerState.devices[port], size, raw);
+            rx->PopRaw();
+        }
+
+        // Packets are copied into the com manager port comm instance and processed as if parsed there
+        is_comm_instance_t* comm = comManagerGetIsComm(port);
+        protocol_type_t ptype;
+        while ((ptype = rx->Front(comm)) != _PTYPE_NONE)
+        {
+            comManagerDispatchPacket(port, ptype);
+            rx->Pop();
+        }
+    }
+}
+
+bool InertialSense::EnableReactor(bool enable)
+{
+    if (!enable)
+    {
+        m_reactor.Close();
+        return false;
+    }
+
+    return m_reactor.IsOpen() || m_reactor.Open();
+}
+
+void InertialSense::UpdateDevices()
+{
+    SyncFlashConfig(m_timeMs);
+
+    // check if we have an valid instance of the FirmareUpdate class, and if so, call it's Step() function
+    for (auto& device : m_comManagerState.devices) {
+        if (serialPortIsOpen(&(device.serialPort)) && device.fwUpdate.fwUpdater != nullptr) {
+            device.fwUpdate.fwUpdater->fwUpdate_step();
+
+            if (!device.fwUpdate.inProgress()) {
+                fwUpdate::update_status_e status = device.fwUpdate.lastStatus;
+                if (status < fwUpdate::NOT_STARTED) {
+                    // TODO: Report a REAL error
+                    // printf("Error starting firmware update: %s\n", fwUpdater->getSessionStatusName());
+                }
 
 
 #ifdef DEBUG_CONSOLELOGGING
-                        } else if ((fwUpdater->getNextChunkID() != lastChunk) || (status != lastStatus)) {
-                        int serialNo = m_comManagerState.devices[devIdx].devInfo.serialNumber;
-                        float pcnt = fwUpdater->getTotalChunks() == 0 ? 0.f : ((float)fwUpdater->getNextChunkID() / (float)fwUpdater->getTotalChunks() * 100.f);
-                        float errRt = fwUpdater->getResendRate() * 100.f;
-                        const char *status = fwUpdater->getSessionStatusName();
-                        printf("SN%d :: %s : [%d of %d] %0.1f%% complete (%u, %0.1f%% resend)\n", serialNo, status, fwUpdater->getNextChunkID(), fwUpdater->getTotalChunks(), pcnt, fwUpdater->getResendCount(), errRt);
+                } else if ((fwUpdater->getNextChunkID() != lastChunk) || (status != lastStatus)) {
+                int serialNo = m_comManagerState.devices[devIdx].devInfo.serialNumber;
+                float pcnt = fwUpdater->getTotalChunks() == 0 ? 0.f : ((float)fwUpdater->getNextChunkID() / (float)fwUpdater->getTotalChunks() * 100.f);
+                float errRt = fwUpdater->getResendRate() * 100.f;
+                const char *status = fwUpdater->getSessionStatusName();
+                printf("SN%d :: %s : [%d of %d] %0.1f%% complete (%u, %0.1f%% resend)\n", serialNo, status, fwUpdater->getNextChunkID(), fwUpdater->getTotalChunks(), pcnt, fwUpdater->getResendCount(), errRt);
 #endif
-                    }
-                }
             }
         }
     }
+}
 
+bool InertialSense::CloseDisconnectedPorts()
+{
     // if any serial ports have closed, shutdown
     bool anyOpen = false;
     for (size_t i = 0; i < m_comManagerState.devices.size(); i++)
     {
         if (!serialPortIsOpen(&m_comManagerState.devices[i].serialPort))
         {
+            if (i < m_rxThreads.size())
+            {
+                m_rxThreads[i]->Stop();
+            }
+
             // Make sure its closed..
-            serialPortClose(&m_comManagerState.devices[i].serialPort);
+            if (serialPortClose(&m_comManagerState.devices[i].serialPort))
+            {   // The descriptor may be reused if the port is reopened
+                m_reactor.Invalidate();
+            }
         } else
             anyOpen = true;
     }
@@ -473,80 +722,120 @@ bool InertialSense::Update()
 
 bool InertialSense::UpdateServer()
 {
-    // as a tcp server, only the first serial port is read from
-    is_comm_instance_t *comm = &(m_gpComm);
-    protocol_type_t ptype = _PTYPE_NONE;
+    for (size_t i = 0; i < m_serverStreams.size() && i < m_comManagerState.devices.size(); i++)
+    {
+        UpdateServerStream(i);
+    }
+    m_tcpServer.Update();
+
+    return true;
+}
+
+void InertialSense::UpdateServerStream(size_t index)
+{
+    // Each device is parsed separately and forwarded only to clients of its mountpoint, or to all clients without mountpoints
+    sServerStream &stream = *m_serverStreams[index];
+    is_comm_instance_t *comm = &(stream.comm);
+    is_comm_pkt_desc_t pkts[32];
+    int mountpoint = (m_tcpServer.Mountpoints().size() ? (int)index : -1);
+    bool subscribed = (mountpoint < 0 ? m_tcpServer.Clients().size() > 0 : m_tcpServer.MountpointClients(mountpoint) > 0);
 
     // Get available size of comm buffer.  is_comm_free() modifies comm->rxBuf pointers, call it before using comm->rxBuf.tail.
     int n = is_comm_free(comm);
 
-    // Read data directly into comm buffer
-    if ((n = serialPortReadTimeout(&m_comManagerState.devices[0].serialPort, comm->rxBuf.tail, n, 0)))
+    // Read data directly into comm buffer, ports without clients are still read to keep the data current
+    if ((n = serialPortReadTimeout(&m_comManagerState.devices[index].serialPort, comm->rxBuf.tail, n, 0)))
     {
         // Update comm buffer tail pointer
         comm->rxBuf.tail += n;
 
-        // Search comm buffer for valid packets
-        while ((ptype = is_comm_parse(comm)) != _PTYPE_NONE)
+        // Parse packets from the comm buffer in batches
+        int count;
+        while ((count = is_comm_parse_batch(comm, pkts, _ARRAY_ELEMENT_COUNT(pkts))) > 0)
         {
-            int id = 0;	// len = 0;
-            string str;
-
-            switch (ptype)
+            // Record message info, the message ids are also used by the RTCM3 filter
+            int ids[_ARRAY_ELEMENT_COUNT(pkts)];
+            for (int i = 0; i < count; i++)
             {
-                case _PTYPE_RTCM3:
-                case _PTYPE_UBLOX:
-                    // forward data on to connected clients
-                    m_clientServerByteCount += comm->rxPkt.data.size;
-                    if (m_tcpServer.Write(comm->rxPkt.data.ptr, comm->rxPkt.data.size) != (int)comm->rxPkt.data.size)
-                    {
-                        cout << endl << "Failed to write bytes to tcp server!" << endl;
-                    }
-                    if (ptype == _PTYPE_RTCM3)
-                    {
-                        // len = messageStatsGetbitu(comm->rxPkt.data.ptr, 14, 10);
-                        id = messageStatsGetbitu(comm->rxPkt.data.ptr, 24, 12);
-                        if ((id == 1029) && (comm->rxPkt.data.size < 1024))
-                        {
-                            str = string().assign(reinterpret_cast<char*>(comm->rxPkt.data.ptr + 12), comm->rxPkt.data.size - 12);
-                        }
-                    }
-                    else if (ptype == _PTYPE_UBLOX)
-                    {
-                        id = *((uint16_t*)(&comm->rxPkt.data.ptr[2]));
+                is_comm_pkt_desc_t *pkt = &pkts[i];
+                int id = 0;
+
+                switch (pkt->ptype)
+                {
+                    case _PTYPE_RTCM3:
+                        id = messageStatsGetbitu(pkt->ptr, 24, 12);
+                        break;
+
+                    case _PTYPE_UBLOX:
+                        id = *((uint16_t*)(&pkt->ptr[2]));
+                        break;
+
+                    case _PTYPE_INERTIAL_SENSE_DATA:
+                    case _PTYPE_INERTIAL_SENSE_CMD:
+                        id = pkt->did;
+                        break;
+
+                    case _PTYPE_NMEA:
+                    {	// Use first four characters before comma (e.g. PGGA in $GPGGA,...)
+                        uint8_t *pStart = pkt->ptr + 2;
+                        uint8_t *pEnd = std::find(pStart, pStart + 8, ',');
+                        pStart = _MAX(pStart, pEnd - 8);
+                        memcpy(&id, pStart, (pEnd - pStart));
                     }
-                    break;
+                        break;
 
-                case _PTYPE_PARSE_ERROR:
-                    break;
+                    default:
+                        break;
+                }
 
-                case _PTYPE_INERTIAL_SENSE_DATA:
-                case _PTYPE_INERTIAL_SENSE_CMD:
-                    id = comm->rxPkt.hdr.id;
-                    break;
+                messageStatsAppend(m_serverMessageStats, pkt->ptype, id, m_timeMs, pkt->ptr, pkt->size);
+                ids[i] = id;
+            }
 
-                case _PTYPE_NMEA:
-                {	// Use first four characters before comma (e.g. PGGA in $GPGGA,...)
-                    uint8_t *pStart = comm->rxPkt.data.ptr + 2;
-                    uint8_t *pEnd = std::find(pStart, pStart + 8, ',');
-                    pStart = _MAX(pStart, pEnd - 8);
-                    memcpy(&id, pStart, (pEnd - pStart));
+            // Forward data on to connected clients.  Adjacent packets in the comm buffer are written together.
+            uint8_t *fwdPtr = NULL;
+            int fwdSize = 0;
+            for (int i = 0; i <= count; i++)
+            {
+                is_comm_pkt_desc_t *pkt = &pkts[i];
+                bool forward = subscribed && i < count && (pkt->ptype == _PTYPE_UBLOX ||
+                    (pkt->ptype == _PTYPE_RTCM3 && stream.rtcmFilter.Pass(ids[i], m_timeMs)));
+                if (forward && fwdPtr + fwdSize == pkt->ptr)
+                {
+                    fwdSize += pkt->size;
+                    continue;
                 }
-                    break;
 
-                default:
-                    break;
+                if (fwdSize)
+                {
+                    m_clientServerByteCount += fwdSize;
+                    if (m_tcpServer.Write(fwdPtr, fwdSize, mountpoint) != fwdSize)
+                    {
+                        cout << endl << "Failed to write bytes to tcp server!" << endl;
+                    }
+                }
+                fwdPtr = forward ? pkt->ptr : NULL;
+                fwdSize = forward ? pkt->size : 0;
             }
+        }
+    }
+}
 
-            if (ptype != _PTYPE_NONE)
-            {	// Record message info
-                messageStatsAppend(str, m_serverMessageStats, ptype, id, m_timeMs);
+bool InertialSense::SetServerRtcmFilter(const string& rules, int mountpoint)
+{
+    bool found = false;
+    for (size_t i = 0; i < m_serverStreams.size(); i++)
+    {
+        if (mountpoint < 0 || (size_t)mountpoint == i)
+        {
+            if (!m_serverStreams[i]->rtcmFilter.SetRules(rules))
+            {
+                return false;
             }
+            found = true;
         }
     }
-    m_tcpServer.Update();
-
-    return true;
+    return found;
 }
 
 bool InertialSense::UpdateClient()
@@ -574,7 +863,6 @@ bool InertialSense::UpdateClient()
         while ((ptype = is_comm_parse(comm)) != _PTYPE_NONE)
         {
             int id = 0;
-            string str;
 
             switch (ptype)
             {
@@ -586,10 +874,6 @@ bool InertialSense::UpdateClient()
                     if (ptype == _PTYPE_RTCM3)
                     {
                         id = messageStatsGetbitu(comm->rxPkt.data.ptr, 24, 12);
-                        if ((id == 1029) && (comm->rxPkt.data.size < 1024))
-                        {
-                            str = string().assign(reinterpret_cast<char*>(comm->rxPkt.data.ptr + 12), comm->rxPkt.data.size - 12);
-                        }
                     }
                     else if (ptype == _PTYPE_UBLOX)
                     {
@@ -625,7 +909,7 @@ bool InertialSense::UpdateClient()
 
             if (ptype != _PTYPE_NONE)
             {	// Record message info
-                messageStatsAppend(str, m_clientMessageStats, ptype, id, m_timeMs);
+                messageStatsAppend(m_clientMessageStats, ptype, id, m_timeMs, comm->rxPkt.data.ptr, comm->rxPkt.data.size);
             }
         }
     }
@@ -1451,18 +1735,28 @@ bool InertialSense::OpenSerialPorts(const char* port, int baudRate)
             device.portHandle = i;
             device.serialPort = serial;
             device.sysParams.flashCfgChecksum = 0xFFFFFFFF;		// Invalidate flash config checksum to trigger sync event
+            cMutexLocker lock(&m_logQueuesMutex);   // the logger thread reads the devices
             m_comManagerState.devices.push_back(device);
         }
     }
 
+    if (m_logger.Enabled())
+    {   // Logging was enabled before these ports were opened
+        AddLogQueues();
+        for (auto& d : m_comManagerState.devices)
+        {
+            m_logger.registerDevice(d);
+        }
+    }
+
     // [C COMM INSTRUCTION]  1.) Setup com manager.  Specify number of serial ports and register callback functions for
     // serial port read and write and for successfully parsed data.  Ensure appropriate buffer memory allocation.
     if (m_cmPorts) { delete[] m_cmPorts; }
     m_cmPorts = new com_manager_port_t[m_comManagerState.devices.size()];
 
     if (m_cmInit.broadcastMsg) { delete[] m_cmInit.broadcastMsg; }
-    m_cmInit.broadcastMsgSize = COM_MANAGER_BUF_SIZE_BCAST_MSG(MAX_NUM_BCAST_MSGS);
-    m_cmInit.broadcastMsg = new broadcast_msg_t[MAX_NUM_BCAST_MSGS];
+    m_cmInit.broadcastMsgSize = COM_MANAGER_BUF_SIZE_BCAST_MSG(m_broadcastCapacity);
+    m_cmInit.broadcastMsg = new broadcast_msg_t[m_broadcastCapacity];
 
     // Register message hander callback functions: RealtimeMessageController (RMC) handler, NMEA, ublox, and RTCM3.
     is_comm_callbacks_t callbacks = {};
@@ -1560,6 +1854,7 @@ bool InertialSense::OpenSerialPorts(const char* port, int baudRate)
 
 void InertialSense::CloseSerialPorts(bool drainBeforeClose)
 {
+    StopRxThreads();
     for (auto& device : m_comManagerState.devices)
     {
         if (drainBeforeClose)
@@ -1567,7 +1862,11 @@ void InertialSense::CloseSerialPorts(bool drainBeforeClose)
 
         serialPortClose(&device.serialPort);
     }
-    m_comManagerState.devices.clear();
+    {
+        cMutexLocker lock(&m_logQueuesMutex);
+        m_comManagerState.devices.clear();
+    }
+    m_reactor.Invalidate();
 }
 
 void InertialSense::SaveFlashConfigFile(std::string path, int pHandle)
@@ -23,11 +23,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <memory>
 
 #include "ISConstants.h"
 #include "ISTcpClient.h"
 #include "ISTcpServer.h"
 #include "ISLogger.h"
+#include "ISLogQueue.h"
+#include "ISReactor.h"
+#include "ISRtcmFilter.h"
+#include "ISPortRxThread.h"
 #include "ISDisplay.h"
 #include "ISUtilities.h"
 #include "ISSerialPort.h"
@@ -156,6 +161,50 @@ public:
     */
     bool Update();
 
+    /**
+    * Same as Update() but in reactor mode (see EnableReactor) sleeps until a port or socket is readable or the
+    * timeout elapses, and only reads ports that have data.  Without reactor mode this is the same as Update().
+    * The timeout bounds how often messages are sent and firmware updates are stepped, keep it at or below the
+    * com manager step period if the host broadcasts data.
+    * @param timeoutMs max time to wait for data in milliseconds
+    * @return true if updating should continue, false if the process should be shutdown
+    */
+    bool Update(uint32_t timeoutMs);
+
+    /**
+    * Enable reactor mode, where Update(timeoutMs) waits on all serial ports and the tcp client/server sockets
+    * with a single epoll set.  Only supported on Linux.
+    * @param enable true to enable, false to return to polling each port
+    * @return true if reactor mode is active
+    */
+    bool EnableReactor(bool enable = true);
+
+    /**
+    * Get whether reactor mode is active
+    */
+    bool ReactorEnabled() { return m_reactor.IsOpen(); }
+
+    /**
+    * Read and parse each device serial port on its own thread.  Update() then only dispatches the parsed packets,
+    * so slow callbacks do not delay reading the ports, and Update(timeoutMs) sleeps until packets are queued.
+    * Not used in tcp server mode, or with reactor mode which is ignored while receive threads are enabled.
+    * @param enable true to enable, false to read the ports from Update()
+    * @param queueSize size in bytes of each device packet queue
+    */
+    void EnableRxThreads(bool enable = true, uint32_t queueSize = PORT_RX_QUEUE_DEFAULT_SIZE);
+
+    /**
+    * Get whether receive threads are enabled
+    */
+    bool RxThreadsEnabled() { return m_rxThreadsEnabled; }
+
+    /**
+    * Get the receive thread counters for a device, i.e. to monitor overruns and latency.  Call from the thread that calls Update().
+    * @param pHandle the device port handle
+    * @return the counters, zero if the receive thread is not running
+    */
+    port_rx_stats_t RxThreadStats(int pHandle);
+
     /**
      * Register a callback handler for data stream errors.
      */
@@ -171,6 +220,7 @@ public:
     * @param maxFileSize the max file size for each log file in bytes
     * @param chunkSize the max data to keep in RAM before flushing to disk in bytes
     * @param subFolder timestamp sub folder or empty for none
+    * @param queuePolicy what to do with received packets when the logger falls behind and its queue is full
     * @return true if success, false if failure
     */
     bool SetLoggerEnabled(
@@ -181,7 +231,15 @@ public:
             uint32_t rmcOptions = RMC_OPTIONS_PRESERVE_CTRL,
             float maxDiskSpacePercent = 0.5f,
             uint32_t maxFileSize = 1024 * 1024 * 5,
-            const std::string& subFolder = cISLogger::g_emptyString);
+            const std::string& subFolder = cISLogger::g_emptyString,
+            cLogPacketQueue::eOverflowPolicy queuePolicy = cLogPacketQueue::OVERFLOW_DROP_NEWEST);
+
+    /**
+    * Set the amount of queued data at which the logger thread is woken to write it.  Takes effect the next time logging is enabled.
+    * @param bytes queued byte count per device
+    * @param packets queued packet count per device
+    */
+    void SetLoggerWakeThreshold(uint32_t bytes, uint32_t packets) { m_logWakeBytes = bytes; m_logWakePackets = packets; }
 
     /**
     * Gets whether logging is enabled
@@ -214,11 +272,22 @@ public:
 
     /**
     * Create a server that will stream data from the IMX to connected clients. Open must be called first to connect to the IMX unit.
-    * @param connectionString ip address followed by colon followed by port. Ip address is optional and can be blank to auto-detect.
+    * With mountpoints, each device is served as an NTRIP mountpoint.  Without mountpoints, all clients receive the first device
+    * whatever mountpoint they request.
+    * @param connectionString TCP:[ip address]:[port]:[mountpoint,...]. Ip address is optional and can be blank to auto-detect.
+    *  Mountpoints are optional, devices without a name in the list default to IS<serial number>.
     * @return true if success, false if error
     */
     bool CreateHost(const std::string& connectionString);
 
+    /**
+    * Select and decimate the RTCM3 messages forwarded to a server mountpoint, see cISRtcmFilter::SetRules().  Call after CreateHost().
+    * @param rules comma separated filter rules, i.e. "MSM4,1005/10000,1230".  Empty to forward all messages.
+    * @param mountpoint the mountpoint (device) index, -1 for all mountpoints
+    * @return true if success, false if the rules are invalid or there is no such mountpoint
+    */
+    bool SetServerRtcmFilter(const std::string& rules, int mountpoint = -1);
+
     /**
     * Close any open connection to a server
     */
@@ -473,6 +542,15 @@ public:
     */
     void EnableDeviceValidation(bool enable) { m_enableDeviceValidation = enable; }
 
+    /**
+    * Set the number of data streams the com manager can broadcast at once, i.e. data set requests that are not handled
+    * by the RMC.  Applies to the next Open().
+    * @param count the number of broadcast slots, limited to MAX_NUM_BCAST_MSGS - MAX_NUM_BCAST_MSGS_LIMIT
+    */
+    void SetBroadcastCapacity(uint32_t count) { m_broadcastCapacity = _CLAMP(count, (uint32_t)MAX_NUM_BCAST_MSGS, (uint32_t)MAX_NUM_BCAST_MSGS_LIMIT); }
+
+    uint32_t BroadcastCapacity() { return m_broadcastCapacity; }
+
     /**
     * Bootload a file - if the bootloader fails, the device stays in bootloader mode and you must call BootloadFile again until it succeeds. If the bootloader gets stuck or has any issues, power cycle the device.
     * Please ensure that all other connections to the com port are closed before calling this function.
@@ -579,6 +657,7 @@ public:
     void SaveFlashConfigFile(std::string path, int pHandle = 0);
 
     std::string ServerMessageStatsSummary() { return messageStatsSummary(m_serverMessageStats); }
+    std::string ServerClientStatsSummary() { return m_tcpServer.ClientStatsSummary(); }
     std::string ClientMessageStatsSummary() { return messageStatsSummary(m_clientMessageStats); }
 
     // Used for testing
@@ -603,8 +682,12 @@ private:
     pfnIsCommParseErrorHandler m_handlerError = NULLPTR;
     cISLogger m_logger;
     void* m_logThread;
-    cMutex m_logMutex;
-    std::map<int, std::vector<p_data_buf_t>> m_logPackets;
+    std::vector<std::unique_ptr<cLogPacketQueue>> m_logQueues;     // per device (pHandle) packets waiting for the logger thread
+    cMutex m_logQueuesMutex;                // held by the logger thread while reading m_logQueues and the devices, and while they are changed
+    cLogPacketQueue::eOverflowPolicy m_logQueuePolicy = cLogPacketQueue::OVERFLOW_DROP_NEWEST;
+    cLogQueueEvent m_logWakeEvent;
+    uint32_t m_logWakeBytes = LOG_QUEUE_WAKE_BYTES;
+    uint32_t m_logWakePackets = LOG_QUEUE_WAKE_PACKETS;
     time_t m_lastLogReInit;
 
     char m_clientBuffer[512];
@@ -620,19 +703,42 @@ private:
     mul_msg_stats_t m_clientMessageStats = {};
 
     bool m_enableDeviceValidation = true;
+    uint32_t m_broadcastCapacity = MAX_NUM_BCAST_MSGS;
     bool m_disableBroadcastsOnClose;
     com_manager_init_t m_cmInit;
     com_manager_port_t *m_cmPorts;
     is_comm_instance_t m_gpComm;
     uint8_t m_gpCommBuffer[PKT_BUF_SIZE];
     mul_msg_stats_t m_serverMessageStats = {};
+    struct sServerStream
+    {
+        is_comm_instance_t comm;
+        uint8_t buffer[PKT_BUF_SIZE];
+        cISRtcmFilter rtcmFilter;
+    };
+    std::vector<std::unique_ptr<sServerStream>> m_serverStreams;   // per device, forwarded to the mountpoint of the same index
     unsigned int m_syncCheckTimeMs = 0;
+    cISReactor m_reactor;
+    std::vector<int> m_reactorFds;          // slots: serial port per device, tcp client, tcp server (caster mode epoll set, or listening socket then clients)
+    std::vector<uint8_t> m_reactorWritable; // slots to also watch for writability, tcp server clients with queued output
+    std::vector<uint8_t> m_reactorReady;
+    std::vector<std::unique_ptr<cISPortRxThread>> m_rxThreads;     // per device (pHandle) receive threads
+    bool m_rxThreadsEnabled = false;
+    uint32_t m_rxQueueSize = PORT_RX_QUEUE_DEFAULT_SIZE;
+    cLogQueueEvent m_rxWakeEvent;
 
     // returns false if logger failed to open
     bool UpdateServer();
+    void UpdateServerStream(size_t index);
     bool UpdateClient();
-    bool EnableLogging(const std::string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const std::string& subFolder);
+    void UpdateDevices();
+    bool CloseDisconnectedPorts();
+    void StartRxThreads();
+    void StopRxThreads();
+    void DispatchRxThreads();
+    bool EnableLogging(const std::string& path, cISLogger::eLogType logType, float maxDiskSpacePercent, uint32_t maxFileSize, const std::string& subFolder, cLogPacketQueue::eOverflowPolicy queuePolicy);
     void DisableLogging();
+    void AddLogQueues();
     bool HasReceivedDeviceInfo(size_t index);
     bool HasReceivedDeviceInfoFromAllDevices();
     void RemoveDevice(size_t index);
@@ -57,6 +57,8 @@ int processIsb(unsigned int pHandle, is_comm_instance_t *comm);
 void enableBroadcastMsg(com_manager_t* cmInstance, broadcast_msg_t *msg, int periodMultiple);
 void disableBroadcastMsg(com_manager_t* cmInstance, broadcast_msg_t *msg);
 void disableDidBroadcast(com_manager_t* cmInstance, int pHandle, uint16_t did);
+void scheduleBroadcastMsg(com_manager_t* cmInstance, int slot, uint32_t nextStep);
+static broadcast_msg_t* findBroadcastMsg(com_manager_t* cmInstance, int pHandle, uint16_t did, uint16_t size, uint16_t offset);
 int sendDataPacket(com_manager_t* cmInstance, int pHandle, packet_t *pkt);
 void sendAck(com_manager_t* cmInstance, int pHandle, packet_t *pkt, uint8_t pTypeFlags);
 int findAsciiMessage(const void * a, const void * b);
@@ -179,7 +181,20 @@ int initComManagerInstanceInternal
         return -1;
     }
     cmInstance->broadcastMessages = (broadcast_msg_t*)buffers->broadcastMsg;
+    cmInstance->numBroadcastMsgs = (int32_t)_MIN(buffers->broadcastMsgSize / sizeof(broadcast_msg_t), MAX_NUM_BCAST_MSGS_LIMIT);
     memset(cmInstance->broadcastMessages, 0, buffers->broadcastMsgSize);
+    for (i = 0; i < (int32_t)DID_COUNT; i++)
+    {
+        cmInstance->bcastDidHead[i] = -1;
+    }
+    for (i = 0; i < cmInstance->numBroadcastMsgs; i++)
+    {   // All slots unused
+        cmInstance->broadcastMessages[i].heap = (int16_t)i;
+        cmInstance->broadcastMessages[i].heapPos = (int16_t)i;
+        cmInstance->broadcastMessages[i].didNext = -1;
+    }
+    cmInstance->bcastHeapCount = 0;
+    cmInstance->bcastStep = 0;
         
     // Port specific info
     cmInstance->ports = cmPorts;
@@ -280,6 +295,45 @@ void comManagerStepRxInstance(CMHANDLE cmInstance_, uint32_t timeMs)
     }
 }
 
+void comManagerStepRxPort(int port)
+{
+    comManagerStepRxPortInstance(&s_cm, port);
+}
+
+void comManagerStepRxPortInstance(CMHANDLE cmInstance_, int port)
+{
+    com_manager_t* cmInstance = (com_manager_t*)cmInstance_;
+
+    if (!cmInstance->portRead || port < 0 || port >= cmInstance->numPorts)
+    {
+        return;
+    }
+
+    s_cmPtr = cmInstance;
+
+    com_manager_port_t *cmPort = &(cmInstance->ports[port]);
+    is_comm_port_parse_messages(cmInstance->portRead, port, &(cmPort->comm), &(cmInstance->callbacks));
+}
+
+void comManagerDispatchPacket(int port, protocol_type_t ptype)
+{
+    comManagerDispatchPacketInstance(&s_cm, port, ptype);
+}
+
+void comManagerDispatchPacketInstance(CMHANDLE cmInstance_, int port, protocol_type_t ptype)
+{
+    com_manager_t* cmInstance = (com_manager_t*)cmInstance_;
+
+    if (port < 0 || port >= cmInstance->numPorts)
+    {
+        return;
+    }
+
+    s_cmPtr = cmInstance;
+
+    is_comm_dispatch_packet(port, &(cmInstance->ports[port].comm), ptype, &(cmInstance->callbacks));
+}
+
 void comManagerStepTxInstance(CMHANDLE cmInstance_)
 {
     com_manager_t* cmInstance = (com_manager_t*)cmInstance_;
@@ -294,10 +348,20 @@ void stepComManagerSendMessages(void)
 void stepComManagerSendMessagesInstance(CMHANDLE cmInstance_)
 {
     com_manager_t* cmInstance = cmInstance_;
-    
-    // Send data (if necessary)
-    for (broadcast_msg_t* bcPtr = cmInstance->broadcastMessages, *ptrEnd = (cmInstance->broadcastMessages + MAX_NUM_BCAST_MSGS); bcPtr < ptrEnd; bcPtr++)
+    uint32_t step = ++cmInstance->bcastStep;
+
+    // Send data (if necessary).  Only messages that are due are visited, soonest first.
+    while (cmInstance->bcastHeapCount > 0)
     {
+        int slot = cmInstance->broadcastMessages[0].heap;
+        broadcast_msg_t* bcPtr = &(cmInstance->broadcastMessages[slot]);
+
+        // Nothing else due this step
+        if ((int32_t)(bcPtr->nextStep - step) > 0)
+        {
+            break;
+        }
+
         // If send buffer does not have space, exit out
         if (cmInstance->txFree && (bcPtr->pkt.size > (uint32_t)cmInstance->txFree(bcPtr->pHandle)))
         {
@@ -310,24 +374,20 @@ void stepComManagerSendMessagesInstance(CMHANDLE cmInstance_)
             disableBroadcastMsg(cmInstance, bcPtr);
         }
         // Broadcast messages
-        else if (bcPtr->period > 0)
+        else
         {
-            // Check if counter has expired
-            if (++bcPtr->counter >= bcPtr->period)
+            scheduleBroadcastMsg(cmInstance, slot, step + bcPtr->period);
+
+            // Prep data if callback exists
+            unsigned int id = bcPtr->pkt.hdr.id;
+            int sendData = 1;
+            if (id<DID_COUNT && cmInstance->regData[id].preTxFnc)
+            {					
+                sendData = cmInstance->regData[id].preTxFnc(bcPtr->pHandle, &bcPtr->pkt.dataHdr);
+            }
+            if (sendData)
             {
-                bcPtr->counter = 0;    // reset counter
-
-                // Prep data if callback exists
-                unsigned int id = bcPtr->pkt.hdr.id;
-                int sendData = 1;
-                if (id<DID_COUNT && cmInstance->regData[id].preTxFnc)
-                {					
-                    sendData = cmInstance->regData[id].preTxFnc(bcPtr->pHandle, &bcPtr->pkt.dataHdr);
-                }
-                if (sendData)
-                {
-                    sendDataPacket(cmInstance, bcPtr->pHandle, &(bcPtr->pkt));
-                }
+                sendDataPacket(cmInstance, bcPtr->pHandle, &(bcPtr->pkt));
             }
         }
     }
@@ -727,32 +787,17 @@ int comManagerGetDataRequestInstance(CMHANDLE _cmInstance, int pHandle, p_data_g
     }
 
     // Search for matching message (i.e. matches pHandle, id, size, and offset)...
-    for (broadcast_msg_t* bcPtr = cmInstance->broadcastMessages, *ptrEnd = (cmInstance->broadcastMessages + MAX_NUM_BCAST_MSGS); bcPtr < ptrEnd; bcPtr++)
-    {
-        if (bcPtr->pHandle == pHandle && bcPtr->pkt.hdr.id == req->id && bcPtr->pkt.hdr.payloadSize == req->size && bcPtr->pkt.offset == req->offset)
-        {
-            msg = bcPtr;
-            break;
-        }
-    }
+    msg = findBroadcastMsg(cmInstance, pHandle, req->id, req->size, req->offset);
 
-    // otherwise use the first available (period=0) message.
+    // otherwise use an available (unscheduled) message.
     if (msg == 0)
     {
-        for (broadcast_msg_t* bcPtr = cmInstance->broadcastMessages, *ptrEnd = (cmInstance->broadcastMessages + MAX_NUM_BCAST_MSGS); bcPtr < ptrEnd; bcPtr++)
-        {
-            if (bcPtr->period <= MSG_PERIOD_DISABLED)
-            {
-                msg = bcPtr;
-                break;
-            }
-        }
-
-        if (msg == 0)
+        if (cmInstance->bcastHeapCount >= cmInstance->numBroadcastMsgs)
         {
             // use last slot, force overwrite
-            msg = cmInstance->broadcastMessages + MAX_NUM_BCAST_MSGS - 1;
+            disableBroadcastMsg(cmInstance, cmInstance->broadcastMessages + cmInstance->numBroadcastMsgs - 1);
         }
+        msg = cmInstance->broadcastMessages + cmInstance->broadcastMessages[cmInstance->bcastHeapCount].heap;
     }
 
     msg->pHandle = pHandle;
@@ -827,6 +872,87 @@ int comManagerGetDataRequestInstance(CMHANDLE _cmInstance, int pHandle, p_data_g
     return 0;
 }
 
+// True if message slot a is due before slot b.  Ties are sent in slot order.
+static inline int broadcastMsgBefore(com_manager_t* cmInstance, int a, int b)
+{
+    int32_t dt = (int32_t)(cmInstance->broadcastMessages[a].nextStep - cmInstance->broadcastMessages[b].nextStep);
+    return dt < 0 || (dt == 0 && a < b);
+}
+
+static inline void setBroadcastHeap(com_manager_t* cmInstance, int pos, int slot)
+{
+    cmInstance->broadcastMessages[pos].heap = (int16_t)slot;
+    cmInstance->broadcastMessages[slot].heapPos = (int16_t)pos;
+}
+
+static void siftBroadcastHeap(com_manager_t* cmInstance, int pos)
+{
+    broadcast_msg_t* msgs = cmInstance->broadcastMessages;
+    int slot = msgs[pos].heap;
+
+    // Up
+    while (pos > 0 && broadcastMsgBefore(cmInstance, slot, msgs[(pos - 1) / 2].heap))
+    {
+        setBroadcastHeap(cmInstance, pos, msgs[(pos - 1) / 2].heap);
+        pos = (pos - 1) / 2;
+    }
+
+    // Down
+    while (1)
+    {
+        int child = 2 * pos + 1;
+        if (child >= cmInstance->bcastHeapCount)
+        {
+            break;
+        }
+        if (child + 1 < cmInstance->bcastHeapCount && broadcastMsgBefore(cmInstance, msgs[child + 1].heap, msgs[child].heap))
+        {
+            child++;
+        }
+        if (!broadcastMsgBefore(cmInstance, msgs[child].heap, slot))
+        {
+            break;
+        }
+        setBroadcastHeap(cmInstance, pos, msgs[child].heap);
+        pos = child;
+    }
+
+    setBroadcastHeap(cmInstance, pos, slot);
+}
+
+// Add a message slot to the schedule, or move it if already scheduled
+void scheduleBroadcastMsg(com_manager_t* cmInstance, int slot, uint32_t nextStep)
+{
+    broadcast_msg_t* msg = &(cmInstance->broadcastMessages[slot]);
+    msg->nextStep = nextStep;
+
+    if (msg->heapPos >= cmInstance->bcastHeapCount)
+    {   // Swap into the first unused heap position and list by DID
+        int pos = cmInstance->bcastHeapCount++;
+        int other = cmInstance->broadcastMessages[pos].heap;
+        setBroadcastHeap(cmInstance, msg->heapPos, other);
+        setBroadcastHeap(cmInstance, pos, slot);
+
+        msg->didNext = cmInstance->bcastDidHead[msg->pkt.hdr.id];
+        cmInstance->bcastDidHead[msg->pkt.hdr.id] = (int16_t)slot;
+    }
+
+    siftBroadcastHeap(cmInstance, msg->heapPos);
+}
+
+static broadcast_msg_t* findBroadcastMsg(com_manager_t* cmInstance, int pHandle, uint16_t did, uint16_t size, uint16_t offset)
+{
+    for (int slot = cmInstance->bcastDidHead[did]; slot >= 0; slot = cmInstance->broadcastMessages[slot].didNext)
+    {
+        broadcast_msg_t* bcPtr = &(cmInstance->broadcastMessages[slot]);
+        if (bcPtr->pHandle == pHandle && bcPtr->pkt.hdr.payloadSize == size && bcPtr->pkt.offset == offset)
+        {
+            return bcPtr;
+        }
+    }
+    return NULL;
+}
+
 void enableBroadcastMsg(com_manager_t* cmInstance, broadcast_msg_t* msg, int periodMultiple)
 {
     // Update broadcast period
@@ -838,15 +964,50 @@ void enableBroadcastMsg(com_manager_t* cmInstance, broadcast_msg_t* msg, int per
     {
         msg->period = MSG_PERIOD_SEND_ONCE;
     }
-    msg->counter = -1;   // Keeps broadcast from sending for at least one period
+
+    if (msg->period == MSG_PERIOD_DISABLED)
+    {   // Period shorter than the step period
+        disableBroadcastMsg(cmInstance, msg);
+        return;
+    }
+
+    // Keeps broadcast from sending for at least one period.  Send once messages go out on the next step.
+    uint32_t steps = (msg->period > 0 ? msg->period + 1 : 1);
+    scheduleBroadcastMsg(cmInstance, (int)(msg - cmInstance->broadcastMessages), cmInstance->bcastStep + steps);
 }
 
 void disableBroadcastMsg(com_manager_t* cmInstance, broadcast_msg_t *msg)
 {
-    (void)cmInstance;
-
-    // Remove item from linked list
     msg->period = MSG_PERIOD_DISABLED;
+
+    int slot = (int)(msg - cmInstance->broadcastMessages);
+    int pos = msg->heapPos;
+    if (pos >= cmInstance->bcastHeapCount)
+    {   // Not scheduled
+        return;
+    }
+
+    // Remove from DID list
+    int16_t *link = &(cmInstance->bcastDidHead[msg->pkt.hdr.id]);
+    while (*link >= 0 && *link != slot)
+    {
+        link = &(cmInstance->broadcastMessages[*link].didNext);
+    }
+    if (*link == slot)
+    {
+        *link = msg->didNext;
+    }
+    msg->didNext = -1;
+
+    // Swap with the last scheduled message and shrink the heap
+    int last = --cmInstance->bcastHeapCount;
+    int lastSlot = cmInstance->broadcastMessages[last].heap;
+    setBroadcastHeap(cmInstance, last, slot);
+    if (pos != last)
+    {
+        setBroadcastHeap(cmInstance, pos, lastSlot);
+        siftBroadcastHeap(cmInstance, pos);
+    }
 }
 
 void comManagerDisableBroadcasts(int pHandle)
@@ -857,22 +1018,31 @@ void comManagerDisableBroadcasts(int pHandle)
 void comManagerDisableBroadcastsInstance(CMHANDLE cmInstance_, int pHandle)
 {
     com_manager_t* cmInstance = (com_manager_t*)cmInstance_;
-    for (broadcast_msg_t* bcPtr = cmInstance->broadcastMessages, *ptrEnd = (cmInstance->broadcastMessages + MAX_NUM_BCAST_MSGS); bcPtr < ptrEnd; bcPtr++)
+
+    // Visit slots rather than heap positions, which move as messages are removed
+    for (int slot = 0; slot < cmInstance->numBroadcastMsgs; slot++)
     {
-        if (pHandle < 0 || bcPtr->pHandle == pHandle)
+        broadcast_msg_t* bcPtr = &(cmInstance->broadcastMessages[slot]);
+        if (bcPtr->heapPos < cmInstance->bcastHeapCount && (pHandle < 0 || bcPtr->pHandle == pHandle))
         {
-            bcPtr->period = MSG_PERIOD_DISABLED;
+            disableBroadcastMsg(cmInstance, bcPtr);
         }
     }
 }
 
 void disableDidBroadcast(com_manager_t* cmInstance, int pHandle, uint16_t did)
 {
-    for (broadcast_msg_t* bcPtr = cmInstance->broadcastMessages, *ptrEnd = (cmInstance->broadcastMessages + MAX_NUM_BCAST_MSGS); bcPtr < ptrEnd; bcPtr++)
+    if (did < DID_COUNT)
     {
-        if ((pHandle < 0 || pHandle == bcPtr->pHandle) && bcPtr->pkt.hdr.id == did)
+        int slot = cmInstance->bcastDidHead[did];
+        while (slot >= 0)
         {
-            bcPtr->period = MSG_PERIOD_DISABLED;
+            broadcast_msg_t* bcPtr = &(cmInstance->broadcastMessages[slot]);
+            slot = bcPtr->didNext;
+            if (pHandle < 0 || pHandle == bcPtr->pHandle)
+            {
+                disableBroadcastMsg(cmInstance, bcPtr);
+            }
         }
     }
     
@@ -27,14 +27,23 @@ typedef struct
 {
 	packet_t                pkt;
 
-	/* Broadcast period counter */
-	int32_t                 counter;
+	/* Broadcast step at which the message is next sent */
+	uint32_t                nextStep;
 
 	/* Millisecond broadcast period intervals.  -1 = send once.  0 = disabled/unused/don't send. */
 	int32_t                 period;
 
 	/* Port to broadcast on. */
 	int32_t                 pHandle;
+
+	/* Next active message slot with the same DID, -1 for none (com manager internal) */
+	int16_t                 didNext;
+
+	/* Position of this message in the schedule heap (com manager internal) */
+	int16_t                 heapPos;
+
+	/* Message slot at heap position equal to this slot index (com manager internal) */
+	int16_t                 heap;
 } broadcast_msg_t;
 
 /** Contains status for the com manager */
@@ -57,7 +66,7 @@ typedef struct
 typedef struct
 {
 	broadcast_msg_t* broadcastMsg;
-	uint32_t broadcastMsgSize;			// MAX_NUM_BCAST_MSGS * sizeof(broadcast_msg_t)
+	uint32_t broadcastMsgSize;			// number of slots * sizeof(broadcast_msg_t), at least MAX_NUM_BCAST_MSGS slots
 } com_manager_init_t;
 
 enum eComManagerErrorType
@@ -66,10 +75,13 @@ enum eComManagerErrorType
 	CM_ERROR_RX_PARSE = -2,
 };
 
-/** Maximum number of messages that may be broadcast simultaneously, per port.
-Since most messages use the RMC (real-time message controller) now, this can be fairly low */
+/** Default and minimum number of messages that may be broadcast simultaneously.  Since most messages use the RMC
+(real-time message controller) now, this can be fairly low.  Pass a larger com_manager_init_t buffer for more. */
 #define MAX_NUM_BCAST_MSGS 12
 
+/** Upper limit on the number of broadcast message slots */
+#define MAX_NUM_BCAST_MSGS_LIMIT 32767
+
 // Convenience macros for creating Com Manager buffers
 #define COM_MANAGER_BUF_SIZE_BCAST_MSG(max_num_bcast_msgs)		((max_num_bcast_msgs)*sizeof(broadcast_msg_t))
 
@@ -154,7 +166,18 @@ typedef struct
 	// Number of communication ports
 	int32_t numPorts;
 
-	broadcast_msg_t* broadcastMessages; // MAX_NUM_BCAST_MSGS slots
+	broadcast_msg_t* broadcastMessages; // numBroadcastMsgs slots
+
+	// Number of broadcast message slots, from the com_manager_init_t buffer size
+	int32_t numBroadcastMsgs;
+
+	// Active broadcast messages are listed by DID (first slot, -1 for none) and kept in a min-heap ordered by the 
+	// step they are next due.  Heap positions bcastHeapCount and above hold the unused slots.
+	int16_t bcastDidHead[DID_COUNT];
+	int16_t bcastHeapCount;
+
+	// Number of broadcast steps, the time base of the schedule
+	uint32_t bcastStep;
 
 	// processing interval
 	int32_t stepPeriodMilliseconds;
@@ -232,6 +255,24 @@ void comManagerStepInstance(CMHANDLE cmInstance_);
 void comManagerStepRxInstance(CMHANDLE cmInstance, uint32_t timeMs);
 void comManagerStepTxInstance(CMHANDLE cmInstance);
 
+/**
+* Read and parse data from a single port, i.e. one reported readable by poll or epoll, instead of all ports.
+* 
+* @param port the port to read from
+*/
+void comManagerStepRxPort(int port);
+void comManagerStepRxPortInstance(CMHANDLE cmInstance, int port);
+
+/**
+* Process a packet that was parsed outside the com manager, i.e. on a receive thread.  The packet must already be
+* copied into the port comm instance rxPkt (see comManagerGetIsComm).
+* 
+* @param port the port the packet was received on
+* @param ptype the packet protocol type
+*/
+void comManagerDispatchPacket(int port, protocol_type_t ptype);
+void comManagerDispatchPacketInstance(CMHANDLE cmInstance, int port, protocol_type_t ptype);
+
 /**
 * Make a request to a port handle to broadcast a piece of data at a set interval.
 * 
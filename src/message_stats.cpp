@@ -10,7 +10,9 @@ The above copyright notice and this permission notice shall be included in all c
 THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-#include <map>
+#include <algorithm>
+#include <vector>
+#include <cstring>
 
 #include "ISComm.h"
 #include "ISDataMappings.h"
@@ -93,14 +95,6 @@ unsigned int messageStatsGetbitu(const unsigned char *buff, int pos, int len)
 	return bits;
 }
 
-static msg_stats_t createNewMsgStats(int timeMs, string description = "")
-{
-	msg_stats_t s = {};
-	s.prevTimeMs = s.timeMs = timeMs;
-	s.description = description;
-	return s;
-}
-
 static void updateTimeMs(msg_stats_t &s, int timeMs)
 {
 	s.count++;
@@ -108,60 +102,58 @@ static void updateTimeMs(msg_stats_t &s, int timeMs)
 	s.timeMs = timeMs;
 }
 
-void messageStatsAppend(string message, mul_msg_stats_t &msgStats, unsigned int ptype, int id, int timeMs)
+static msg_stats_t& tableStats(msg_stats_table_t &table, int id)
+{
+	// Fibonacci hash, then linear probe.  Entries are never removed.
+	unsigned int slot = ((unsigned int)id * 2654435769u) >> (32 - MSG_STATS_TABLE_BITS);
+	for (int i = 0; i < MSG_STATS_TABLE_SIZE; i++, slot = (slot + 1) & (MSG_STATS_TABLE_SIZE - 1))
+	{
+		msg_stats_entry_t &e = table.entries[slot];
+		if (e.stats.count == 0)
+		{	// Empty
+			if (table.size >= MSG_STATS_TABLE_SIZE * 3 / 4)
+			{	// Keep probes short
+				break;
+			}
+			e.id = id;
+			table.size++;
+			return e.stats;
+		}
+		if (e.id == id)
+		{
+			return e.stats;
+		}
+	}
+	return table.other;
+}
+
+void messageStatsAppend(mul_msg_stats_t &msgStats, unsigned int ptype, int id, int timeMs, const uint8_t *pkt, int pktSize)
 {
 	switch (ptype)
 	{
 	case _PTYPE_INERTIAL_SENSE_CMD:
 	case _PTYPE_INERTIAL_SENSE_DATA:
-		if (msgStats.isb.find(id) == msgStats.isb.end())
-		{	// Create new 
-			msgStats.isb[id] = createNewMsgStats(timeMs, cISDataMappings::GetDataSetName(id));
-		}
-
-		{	// Update count and timestamps
+		if (id >= 0 && id < (int)DID_COUNT)
+		{
 			updateTimeMs(msgStats.isb[id], timeMs);
 		}
 		break;
 
 	case _PTYPE_NMEA:
-		if (msgStats.nmea.find(id) == msgStats.nmea.end())
-		{	// Create new 
-			msgStats.nmea[id] = createNewMsgStats(timeMs);
-		}
-
-		{	// Update count and timestamps
-			updateTimeMs(msgStats.nmea[id], timeMs);
-		}
+		updateTimeMs(tableStats(msgStats.nmea, id), timeMs);
 		break;
 
 	case _PTYPE_UBLOX:
-		if (msgStats.ublox.find(id) == msgStats.ublox.end())
-		{	// Create new 
-			uint8_t msgClass = (uint8_t)id;
-			uint8_t msgID = (uint8_t)(id >> 8);
-			msgStats.ublox[id] = createNewMsgStats(timeMs, messageDescriptionUblox(msgClass, msgID));
-		}
-
-		{	// Update count and timestamps
-			updateTimeMs(msgStats.ublox[id], timeMs);
-		}
+		updateTimeMs(tableStats(msgStats.ublox, id), timeMs);
 		break;
 
 	case _PTYPE_RTCM3:
-		if (msgStats.rtcm3.find(id) == msgStats.rtcm3.end())
-		{	// Create new 
-			msgStats.rtcm3[id] = createNewMsgStats(timeMs, messageDescriptionRtcm3(id));
-		}
-
-		{	// Update count and timestamps
-			msg_stats_t &s = msgStats.rtcm3[id];
-			updateTimeMs(s, timeMs);
-
-			if (id == 1029)
-			{
-				s.description = string("Text String: ") + message;
-			}
+		updateTimeMs(tableStats(msgStats.rtcm3, id), timeMs);
+		if (id == 1029 && pkt != NULL && pktSize > 12 && pktSize < 1024)
+		{	// Text follows the 9 byte message header
+			int n = _MIN(pktSize - 12, MSG_STATS_TEXT_SIZE - 1);
+			memcpy(msgStats.rtcm1029Text, pkt + 12, n);
+			msgStats.rtcm1029Text[n] = 0;
 		}
 		break;
 
@@ -180,88 +172,107 @@ void messageStatsAppend(string message, mul_msg_stats_t &msgStats, unsigned int
 	}
 }
 
+// Recorded entries sorted by id
+static vector<const msg_stats_entry_t*> sortedEntries(const msg_stats_table_t &table)
+{
+	vector<const msg_stats_entry_t*> entries;
+	for (int i = 0; i < MSG_STATS_TABLE_SIZE; i++)
+	{
+		if (table.entries[i].stats.count)
+		{
+			entries.push_back(&table.entries[i]);
+		}
+	}
+	sort(entries.begin(), entries.end(), [](const msg_stats_entry_t *a, const msg_stats_entry_t *b) { return a->id < b->id; });
+	return entries;
+}
+
+static int dtMs(const msg_stats_t &s)
+{
+	return (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
+}
+
 string messageStatsSummary(mul_msg_stats_t &msgStats)
 {
 	string str;
 #define BUF_SIZE 512
 	char buf[BUF_SIZE];
 
-	if (!msgStats.isb.empty())
+	bool header = false;
+	for (int did = 0; did < (int)DID_COUNT; did++)
 	{
-		str.append("Inertial Sense Binary: __________________\n");
-		str.append(" DID   Count  dtMs  Description\n");
-		std::map<int, msg_stats_t>::iterator it;
-		for (it = msgStats.isb.begin(); it != msgStats.isb.end(); it++)
+		msg_stats_t &s = msgStats.isb[did];
+		if (s.count == 0)
 		{
-			int did = it->first;
-			msg_stats_t &s = it->second;
-			int dtMs = (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
-
-			SNPRINTF(buf, BUF_SIZE, "%4d %7d %5d  %s\n", did, s.count, dtMs, s.description.c_str());
-            str.append(string(buf));
+			continue;
 		}
+		if (!header)
+		{
+			str.append("Inertial Sense Binary: __________________\n");
+			str.append(" DID   Count  dtMs  Description\n");
+			header = true;
+		}
+		SNPRINTF(buf, BUF_SIZE, "%4d %7d %5d  %s\n", did, s.count, dtMs(s), cISDataMappings::GetDataSetName(did));
+		str.append(buf);
 	}
 
-	if (!msgStats.nmea.empty())
+	if (msgStats.nmea.size)
 	{
 		str.append("NMEA: __________________________________\n");
 		str.append("  ID   Count  dtMs  Description\n");
-		std::map<int, msg_stats_t>::iterator it;
-		for (it = msgStats.nmea.begin(); it != msgStats.nmea.end(); it++)
+		for (const msg_stats_entry_t *e : sortedEntries(msgStats.nmea))
 		{
-			msg_stats_t &s = it->second;
-			int dtMs = (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
 			union
 			{
 				int id;
 				char str[8];
 			} val = {};
-			val.id = it->first;
-			SNPRINTF(buf, BUF_SIZE, "%s %7d %5d  %s\n", val.str, s.count, dtMs, s.description.c_str());
-            str.append(string(buf));
+			val.id = e->id;
+			SNPRINTF(buf, BUF_SIZE, "%s %7d %5d  \n", val.str, e->stats.count, dtMs(e->stats));
+			str.append(buf);
 		}
 	}
 
-	if (!msgStats.ublox.empty())
+	if (msgStats.ublox.size)
 	{
 		str.append("Ublox: __________________________________\n");
 		str.append("(Class  ID)   Count  dtMs  Description\n");
-		std::map<int, msg_stats_t>::iterator it;
-		for (it = msgStats.ublox.begin(); it != msgStats.ublox.end(); it++)
+		for (const msg_stats_entry_t *e : sortedEntries(msgStats.ublox))
 		{
-			int id = it->first;
-			msg_stats_t &s = it->second;
-			uint8_t msgClass = (uint8_t)id;
-			uint8_t msgID = (uint8_t)(id >> 8);
-			int dtMs = (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
-			SNPRINTF(buf, BUF_SIZE, "(0x%02x 0x%02x) %7d %5d  %s\n", msgClass, msgID, s.count, dtMs, s.description.c_str());
-            str.append(string(buf));
+			uint8_t msgClass = (uint8_t)e->id;
+			uint8_t msgID = (uint8_t)(e->id >> 8);
+			SNPRINTF(buf, BUF_SIZE, "(0x%02x 0x%02x) %7d %5d  %s\n", msgClass, msgID, e->stats.count, dtMs(e->stats), messageDescriptionUblox(msgClass, msgID).c_str());
+			str.append(buf);
 		}
 	}
 
-	if (!msgStats.rtcm3.empty())
+	if (msgStats.rtcm3.size)
 	{
 		str.append("RTCM3: __________________________________\n");
 		str.append("  ID   Count  dtMs  Description\n");
-		std::map<int, msg_stats_t>::iterator it;
-		for (it = msgStats.rtcm3.begin(); it != msgStats.rtcm3.end(); it++)
+		for (const msg_stats_entry_t *e : sortedEntries(msgStats.rtcm3))
 		{
-			int id = it->first;
-			msg_stats_t &s = it->second;
-			int dtMs = (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
-			SNPRINTF(buf, BUF_SIZE, "%3d %7d %5d  %s\n", id, s.count, dtMs, s.description.c_str());
-            str.append(string(buf));
+			string description = (e->id == 1029 ? string("Text String: ") + msgStats.rtcm1029Text : messageDescriptionRtcm3(e->id));
+			SNPRINTF(buf, BUF_SIZE, "%3d %7d %5d  %s\n", e->id, e->stats.count, dtMs(e->stats), description.c_str());
+			str.append(buf);
 		}
 	}
 
+	// Messages of protocols with more ids than fit in the tables
+	int otherCount = msgStats.nmea.other.count + msgStats.ublox.other.count + msgStats.rtcm3.other.count;
+	if (otherCount)
+	{
+		SNPRINTF(buf, BUF_SIZE, "Other message ids: %d\n", otherCount);
+		str.append(buf);
+	}
+
 	if (msgStats.ack.count>5)
 	{
 		str.append("Acknowledge: ____________________________\n");
 		str.append("   Count  dtMs\n");
 		msg_stats_t &s = msgStats.ack;
-		int dtMs = (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
-		SNPRINTF(buf, BUF_SIZE, "%8d %5d\n", s.count, dtMs);
-		str.append(string(buf));
+		SNPRINTF(buf, BUF_SIZE, "%8d %5d\n", s.count, dtMs(s));
+		str.append(buf);
 	}
 
 #ifdef DEBUG
@@ -270,9 +281,8 @@ string messageStatsSummary(mul_msg_stats_t &msgStats)
 		str.append("Parse Error: ____________________________\n");
 		str.append("   Count   dtMs\n");
 		msg_stats_t &s = msgStats.parseError;
-		int dtMs = (s.prevTimeMs ? (s.timeMs - s.prevTimeMs) : 0);
-		SNPRINTF(buf, BUF_SIZE, "%8d %5d\n", s.count, dtMs);
-		str.append(string(buf));
+		SNPRINTF(buf, BUF_SIZE, "%8d %5d\n", s.count, dtMs(s));
+		str.append(buf);
 	}
 #endif
 	return str;
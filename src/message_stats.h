@@ -15,30 +15,63 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <string>
 
+#include "data_sets.h"
+
+// message ids recorded per protocol, up to 3/4 of the table is used and other ids are counted together
+#define MSG_STATS_TABLE_BITS    6
+#define MSG_STATS_TABLE_SIZE    (1 << MSG_STATS_TABLE_BITS)
+
+// max RTCM3 1029 text recorded
+#define MSG_STATS_TEXT_SIZE     128
+
 
 typedef struct
 {
     int count;
     int timeMs;
     int prevTimeMs;
-    std::string description;
 } msg_stats_t;
 
 typedef struct
 {
-    std::map<int, msg_stats_t> isb;
-    std::map<int, msg_stats_t> nmea;
-    std::map<int, msg_stats_t> ublox;
-    std::map<int, msg_stats_t> rtcm3;
+    int id;
+    msg_stats_t stats;          // count 0 if the entry is empty
+} msg_stats_entry_t;
+
+/** Fixed size table of message stats, open addressing by message id */
+typedef struct
+{
+    msg_stats_entry_t entries[MSG_STATS_TABLE_SIZE];
+    int size;
+    msg_stats_t other;          // messages not recorded because the table is full
+} msg_stats_table_t;
+
+typedef struct
+{
+    msg_stats_t isb[DID_COUNT];
+    msg_stats_table_t nmea;
+    msg_stats_table_t ublox;
+    msg_stats_table_t rtcm3;
     msg_stats_t ack;
     msg_stats_t parseError;
+    char rtcm1029Text[MSG_STATS_TEXT_SIZE];
 } mul_msg_stats_t;
 
 
 unsigned int messageStatsGetbitu(const unsigned char *buff, int pos, int len);
 std::string messageDescriptionUblox(uint8_t msgClass, uint8_t msgID);
 std::string messageDescriptionRtcm3(int id);
-void messageStatsAppend(std::string message, mul_msg_stats_t &msgStats, unsigned int ptype, int id, int timeMs);
+
+/**
+* Count a received message.  Does not allocate, descriptions are looked up by messageStatsSummary().
+* @param msgStats the stats to update
+* @param ptype the packet type
+* @param id the message id: ISB DID, NMEA message id characters, UBX class | id << 8, or RTCM3 message number
+* @param timeMs the current time
+* @param pkt the packet, used for the RTCM3 1029 text
+* @param pktSize the number of bytes in pkt
+*/
+void messageStatsAppend(mul_msg_stats_t &msgStats, unsigned int ptype, int id, int timeMs, const uint8_t *pkt = NULL, int pktSize = 0);
 std::string messageStatsSummary(mul_msg_stats_t &msgStats);
 
 
@@ -842,3 +842,22 @@ int serialPortPlatformInit(serial_port_t* serialPort)
     serialPort->pfnSleep = serialPortSleepPlatform;
     return 0;
 }
+
+int serialPortPlatformGetFd(serial_port_t* serialPort)
+{
+    if (serialPort == NULL || serialPort->handle == NULL || serialPort->pfnRead != serialPortReadTimeoutPlatform)
+    {
+        return -1;
+    }
+
+#if PLATFORM_IS_WINDOWS
+
+    return -1;
+
+#else
+
+    return ((serialPortHandle*)serialPort->handle)->fd;
+
+#endif
+
+}
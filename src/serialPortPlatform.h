@@ -23,6 +23,10 @@ extern "C" {
 // returns non-zero if success, 0 if platform not implemented
 int serialPortPlatformInit(serial_port_t* serialPort);
 
+// get the file descriptor of an open port initialized by serialPortPlatformInit, i.e. to wait on with poll or epoll
+// returns -1 if the port is not open, is not a platform port or the platform does not use file descriptors (Windows)
+int serialPortPlatformGetFd(serial_port_t* serialPort);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <deque>
+#include <vector>
+#include <chrono>
+#include <functional>
 #include "ISComm.h"
 #include "ring_buffer.h"
 #include "protocol_nmea.h"
@@ -24,6 +27,10 @@ extern "C"
 #define BLAST_RX_TEST                        	1
 #define TEST_ALTERNATING_ISB_NMEA_PARSE_ERRORS  1
 #define TEST_TRUNCATED_PACKETS                  1
+#define TEST_PACKET_START_SCAN                  1
+#define TEST_RING_BUFFER_RX                     1
+#define TEST_PARSE_BATCH                        1
+#define TEST_CHECKSUM_KERNELS                   1
 
 // Protocols
 #define TEST_PROTO_ISB		1
@@ -1319,3 +1326,426 @@ TEST(ISComm, TruncatedPackets)
 	EXPECT_EQ(g_comm.rxErrorCount, badPktCount);
 }
 #endif
+
+
+#if TEST_PACKET_START_SCAN
+typedef struct
+{
+	protocol_type_t		ptype;
+	std::vector<uint8_t> data;
+} parse_result_t;
+
+// Encoded test packets separated by random garbage, which includes stray start bytes
+static std::vector<uint8_t> generateNoisyStream(uint32_t seed)
+{
+	std::deque<data_holder_t> testDeque;
+	generateData(testDeque);
+
+	is_comm_instance_t comm;
+	uint8_t commBuf[2048];
+	is_comm_init(&comm, commBuf, sizeof(commBuf));
+
+	std::vector<uint8_t> stream;
+	for (size_t i = 0; i < testDeque.size(); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		int garbage = (seed >> 16) % 300;
+		for (int j = 0; j < garbage; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			stream.push_back((uint8_t)(seed >> 16));
+		}
+
+		data_holder_t &td = testDeque[i];
+		if (td.ptype == _PTYPE_INERTIAL_SENSE_DATA)
+		{
+			uint8_t buf[COM_BUFFER_SIZE];
+			int n = is_comm_set_data_to_buf(buf, sizeof(buf), &comm, td.did, td.size, 0, (void*)&(td.data));
+			stream.insert(stream.end(), buf, buf + n);
+		}
+		else
+		{
+			stream.insert(stream.end(), td.data.buf, td.data.buf + td.size);
+		}
+	}
+	return stream;
+}
+
+static void addParseResult(std::vector<parse_result_t> &results, is_comm_instance_t &comm, protocol_type_t ptype)
+{
+	parse_result_t r;
+	r.ptype = ptype;
+	if (ptype != _PTYPE_PARSE_ERROR)
+	{
+		r.data.assign(comm.rxPkt.data.ptr, comm.rxPkt.data.ptr + comm.rxPkt.data.size);
+	}
+	results.push_back(r);
+}
+
+// Parse one byte at a time, the reference byte by byte scan
+static std::vector<parse_result_t> parseStreamByte(const std::vector<uint8_t> &stream, uint32_t enabledMask, is_comm_instance_t &comm, uint8_t *commBuf, int commBufSize)
+{
+	std::vector<parse_result_t> results;
+	is_comm_init(&comm, commBuf, commBufSize);
+	comm.config.enabledMask = enabledMask;
+
+	protocol_type_t ptype;
+	for (uint8_t c : stream)
+	{
+		if ((ptype = is_comm_parse_byte(&comm, c)) != _PTYPE_NONE)
+		{
+			addParseResult(results, comm, ptype);
+			while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+			{
+				addParseResult(results, comm, ptype);
+			}
+		}
+	}
+	return results;
+}
+
+// Parse blocks of bytes, which uses the vectorized packet start scan
+static std::vector<parse_result_t> parseStreamMultiByte(const std::vector<uint8_t> &stream, uint32_t enabledMask, is_comm_instance_t &comm, uint8_t *commBuf, int commBufSize, int blockSize)
+{
+	std::vector<parse_result_t> results;
+	is_comm_init(&comm, commBuf, commBufSize);
+	comm.config.enabledMask = enabledMask;
+
+	protocol_type_t ptype;
+	size_t pos = 0;
+	while (pos < stream.size())
+	{
+		int n = _MIN(_MIN((int)(stream.size() - pos), blockSize), is_comm_free(&comm));
+		memcpy(comm.rxBuf.tail, &stream[pos], n);
+		comm.rxBuf.tail += n;
+		pos += n;
+
+		while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+		{
+			addParseResult(results, comm, ptype);
+		}
+	}
+	return results;
+}
+
+TEST(ISComm, PacketStartScanMatchesByteParse)
+{
+	static uint8_t bufA[16384], bufB[16384];
+	is_comm_instance_t commA, commB;
+
+	std::vector<uint8_t> stream = generateNoisyStream(1234);
+
+	const uint32_t masks[] = 
+	{
+		ENABLE_PROTOCOL_ISB | ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_UBLOX | ENABLE_PROTOCOL_RTCM3 | ENABLE_PROTOCOL_SONY,
+		ENABLE_PROTOCOL_ISB | ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_UBLOX | ENABLE_PROTOCOL_RTCM3 | ENABLE_PROTOCOL_SONY | ENABLE_PROTOCOL_SPARTN,
+		ENABLE_PROTOCOL_ISB,
+		ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_RTCM3,
+		0,
+	};
+	const int blockSizes[] = { 7, 64, 1000, 16384 };
+
+	for (uint32_t mask : masks)
+	{
+		std::vector<parse_result_t> ref = parseStreamByte(stream, mask, commA, bufA, sizeof(bufA));
+		if (mask & ENABLE_PROTOCOL_ISB)
+		{
+			EXPECT_GT(commA.rxPktCount, 0u);
+		}
+
+		for (int blockSize : blockSizes)
+		{
+			std::vector<parse_result_t> results = parseStreamMultiByte(stream, mask, commB, bufB, sizeof(bufB), blockSize);
+
+			ASSERT_EQ(results.size(), ref.size()) << "mask " << mask << " block " << blockSize;
+			for (size_t i = 0; i < ref.size(); i++)
+			{
+				ASSERT_EQ(results[i].ptype, ref[i].ptype) << "mask " << mask << " block " << blockSize << " packet " << i;
+				ASSERT_TRUE(results[i].data == ref[i].data) << "mask " << mask << " block " << blockSize << " packet " << i;
+			}
+			EXPECT_EQ(commB.rxPktCount, commA.rxPktCount);
+			EXPECT_EQ(commB.rxErrorCount, commA.rxErrorCount);
+			EXPECT_EQ(memcmp(commB.rxErrorTypeCount, commA.rxErrorTypeCount, sizeof(commA.rxErrorTypeCount)), 0);
+		}
+	}
+}
+
+TEST(ISComm, PacketStartScanThroughput)
+{
+	static uint8_t commBuf[16384];
+	is_comm_instance_t comm;
+	const uint32_t mask = ENABLE_PROTOCOL_ISB | ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_UBLOX | ENABLE_PROTOCOL_RTCM3;
+
+	// Noise without any start bytes, as seen when attaching to a port with the wrong baud rate
+	std::vector<uint8_t> noise(8 * 1024 * 1024);
+	uint32_t seed = 1;
+	for (size_t i = 0; i < noise.size(); i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		uint8_t c = (uint8_t)(seed >> 16);
+		switch (c)
+		{
+		case PSC_ISB_PREAMBLE_BYTE1: case PSC_NMEA_START_BYTE: case UBLOX_START_BYTE1: case RTCM3_START_BYTE:
+			c = 0;
+			break;
+		}
+		noise[i] = c;
+	}
+
+	// Packets mixed with garbage
+	std::vector<uint8_t> mixed;
+	for (uint32_t i = 0; mixed.size() < noise.size(); i++)
+	{
+		std::vector<uint8_t> s = generateNoisyStream(i);
+		mixed.insert(mixed.end(), s.begin(), s.end());
+	}
+
+	auto bytesPerSec = [&](const std::vector<uint8_t> &stream, int blockSize)
+	{
+		auto start = std::chrono::steady_clock::now();
+		std::vector<parse_result_t> results = parseStreamMultiByte(stream, mask, comm, commBuf, sizeof(commBuf), blockSize);
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return stream.size() / _MAX(sec, 1.0e-6);
+	};
+
+	double noiseByte = bytesPerSec(noise, 1);
+	double noiseBlock = bytesPerSec(noise, 4096);
+	EXPECT_EQ(comm.rxPktCount, 0u);
+	double mixedByte = bytesPerSec(mixed, 1);
+	double mixedBlock = bytesPerSec(mixed, 4096);
+	EXPECT_GT(comm.rxPktCount, 0u);
+
+	printf("Parse throughput (MB/s)  noise byte: %.1f  block: %.1f   mixed byte: %.1f  block: %.1f\n", 
+		noiseByte * 1.0e-6, noiseBlock * 1.0e-6, mixedByte * 1.0e-6, mixedBlock * 1.0e-6);
+}
+#endif
+
+
+#if TEST_RING_BUFFER_RX
+// Parse randomly sized fragments, reading as much as is_comm_free() allows or less
+static std::vector<parse_result_t> parseStreamFragmented(const std::vector<uint8_t> &stream, uint32_t enabledMask, is_comm_instance_t &comm, uint8_t *commBuf, int commBufSize, eRxBufMode mode, uint32_t seed)
+{
+	std::vector<parse_result_t> results;
+	is_comm_init_mode(&comm, commBuf, commBufSize, mode);
+	comm.config.enabledMask = enabledMask;
+
+	protocol_type_t ptype;
+	size_t pos = 0;
+	while (pos < stream.size())
+	{
+		seed = seed * 1103515245 + 12345;
+		int fragment = 1 + (seed >> 16) % ((seed & 0x100) ? 3000 : 20);
+		int n = _MIN(_MIN((int)(stream.size() - pos), fragment), is_comm_free(&comm));
+		EXPECT_GT(n, 0);
+		memcpy(comm.rxBuf.tail, &stream[pos], n);
+		comm.rxBuf.tail += n;
+		pos += n;
+
+		while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+		{
+			addParseResult(results, comm, ptype);
+		}
+	}
+	return results;
+}
+
+TEST(ISComm, RingBufferFragmentedStress)
+{
+	static uint8_t refBuf[16384], ringBuf[8192];
+	is_comm_instance_t refComm, comm;
+
+	// UBX is not enabled because a false start in the garbage can claim up to 64K, which is then flushed depending on buffer size
+	const uint32_t mask = ENABLE_PROTOCOL_ISB | ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_RTCM3;
+
+	for (uint32_t seed = 1; seed <= 20; seed++)
+	{
+		std::vector<uint8_t> stream = generateNoisyStream(seed);
+		std::vector<parse_result_t> ref = parseStreamByte(stream, mask, refComm, refBuf, sizeof(refBuf));
+		std::vector<parse_result_t> results = parseStreamFragmented(stream, mask, comm, ringBuf, sizeof(ringBuf), RXBUF_MODE_RING, seed);
+
+		// Same packets as a buffer that never fills, without shifting or flushing
+		ASSERT_EQ(results.size(), ref.size()) << "seed " << seed;
+		for (size_t i = 0; i < ref.size(); i++)
+		{
+			ASSERT_EQ(results[i].ptype, ref[i].ptype) << "seed " << seed << " packet " << i;
+			ASSERT_TRUE(results[i].data == ref[i].data) << "seed " << seed << " packet " << i;
+		}
+		EXPECT_GT(comm.rxPktCount, 0u);
+		EXPECT_EQ(comm.rxPktCount, refComm.rxPktCount);
+		EXPECT_EQ(comm.rxErrorTypeCount[EPARSE_RXBUFFER_FLUSHED], 0u);
+		EXPECT_EQ(memcmp(comm.rxErrorTypeCount, refComm.rxErrorTypeCount, sizeof(comm.rxErrorTypeCount)), 0);
+	}
+}
+
+TEST(ISComm, RingBufferPacketsOnly)
+{
+	static uint8_t ringBuf[4096];
+	is_comm_instance_t comm;
+	const uint32_t mask = ENABLE_PROTOCOL_ISB | ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_UBLOX | ENABLE_PROTOCOL_RTCM3 | ENABLE_PROTOCOL_SONY;
+
+	std::deque<data_holder_t> testDeque;
+	generateData(testDeque);
+
+	// Repeat the test data many times so the ring wraps
+	ring_buf_t rbuf;
+	static uint8_t rbufBuffer[PORT_BUFFER_SIZE];
+	ringBufInit(&rbuf, rbufBuffer, sizeof(rbufBuffer), 1);
+	addDequeToRingBuf(testDeque, &rbuf);
+	std::vector<uint8_t> once(ringBufUsed(&rbuf));
+	ringBufRead(&rbuf, once.data(), (int)once.size());
+	std::vector<uint8_t> stream;
+	for (int i = 0; i < 50; i++)
+	{
+		stream.insert(stream.end(), once.begin(), once.end());
+	}
+
+	std::vector<parse_result_t> results = parseStreamFragmented(stream, mask, comm, ringBuf, sizeof(ringBuf), RXBUF_MODE_RING, 5);
+	ASSERT_EQ(results.size(), 50 * testDeque.size());
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		data_holder_t &td = testDeque[i % testDeque.size()];
+		ASSERT_EQ(results[i].data.size(), td.size) << "packet " << i;
+		EXPECT_EQ(memcmp(results[i].data.data(), td.data.buf, td.size), 0) << "packet " << i;
+	}
+	EXPECT_EQ(comm.rxErrorCount, 0u);
+	EXPECT_EQ(comm.rxPktCount, results.size());
+}
+#endif
+
+
+#if TEST_PARSE_BATCH
+TEST(ISComm, ParseBatchMatchesParse)
+{
+	static uint8_t refBuf[16384], batchBuf[16384];
+	is_comm_instance_t refComm, comm;
+	const uint32_t mask = ENABLE_PROTOCOL_ISB | ENABLE_PROTOCOL_NMEA | ENABLE_PROTOCOL_UBLOX | ENABLE_PROTOCOL_RTCM3 | ENABLE_PROTOCOL_SONY;
+
+	std::vector<uint8_t> stream = generateNoisyStream(42);
+	std::vector<parse_result_t> ref = parseStreamMultiByte(stream, mask, refComm, refBuf, sizeof(refBuf), 1000);
+
+	const int maxCounts[] = { 1, 3, 64 };
+	for (int maxCount : maxCounts)
+	{
+		is_comm_init(&comm, batchBuf, sizeof(batchBuf));
+		comm.config.enabledMask = mask;
+
+		std::vector<is_comm_pkt_desc_t> pkts(maxCount);
+		std::vector<parse_result_t> results;
+		int isbCount = 0;
+		size_t pos = 0;
+		while (pos < stream.size())
+		{
+			int n = _MIN(_MIN((int)(stream.size() - pos), 1000), is_comm_free(&comm));
+			memcpy(comm.rxBuf.tail, &stream[pos], n);
+			comm.rxBuf.tail += n;
+			pos += n;
+
+			int count;
+			while ((count = is_comm_parse_batch(&comm, pkts.data(), maxCount)) > 0)
+			{
+				ASSERT_LE(count, maxCount);
+				for (int i = 0; i < count; i++)
+				{
+					is_comm_pkt_desc_t &pkt = pkts[i];
+					parse_result_t r;
+					r.ptype = pkt.ptype;
+					if (pkt.ptype == _PTYPE_PARSE_ERROR)
+					{
+						EXPECT_EQ(pkt.ptr, nullptr);
+					}
+					else
+					{	// Data is in place in the comm buffer
+						EXPECT_GE(pkt.ptr, comm.rxBuf.start);
+						EXPECT_LE(pkt.ptr + pkt.size, comm.rxBuf.tail);
+						r.data.assign(pkt.ptr, pkt.ptr + pkt.size);
+					}
+					if (pkt.ptype == _PTYPE_INERTIAL_SENSE_DATA)
+					{
+						EXPECT_NE(pkt.did, 0);
+						isbCount++;
+					}
+					results.push_back(r);
+				}
+			}
+		}
+
+		ASSERT_EQ(results.size(), ref.size()) << "maxCount " << maxCount;
+		for (size_t i = 0; i < ref.size(); i++)
+		{
+			ASSERT_EQ(results[i].ptype, ref[i].ptype) << "maxCount " << maxCount << " packet " << i;
+			ASSERT_TRUE(results[i].data == ref[i].data) << "maxCount " << maxCount << " packet " << i;
+		}
+		EXPECT_GT(isbCount, 0);
+		EXPECT_EQ(comm.rxPktCount, refComm.rxPktCount);
+	}
+}
+#endif
+
+
+#if TEST_CHECKSUM_KERNELS
+static std::vector<uint8_t> randomBytes(size_t size, uint32_t seed)
+{
+	std::vector<uint8_t> data(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = (uint8_t)(seed >> 16);
+	}
+	return data;
+}
+
+TEST(ISComm, ChecksumKernelsMatchReference)
+{
+	std::vector<uint8_t> data = randomBytes(4096 + 64, 7);
+
+	// Every size and alignment up to a few SIMD blocks, then every size up to the max packet size
+	for (uint32_t size = 0; size <= 4096; size++)
+	{
+		int alignments = (size <= 256 ? 32 : 1);
+		for (int align = 0; align < alignments; align++)
+		{
+			uint8_t *ptr = &data[align];
+			uint16_t init = (uint16_t)(size * 7919 + align);
+			ASSERT_EQ(is_comm_fletcher16(init, ptr, size), is_comm_fletcher16_ref(init, ptr, size)) << "size " << size << " align " << align;
+			ASSERT_EQ(calculate24BitCRCQ(ptr, size), calculate24BitCRCQ_ref(ptr, size)) << "size " << size << " align " << align;
+		}
+	}
+
+	// Worst case sums
+	std::vector<uint8_t> ones(65536, 0xFF);
+	EXPECT_EQ(is_comm_fletcher16(0xFFFF, ones.data(), (uint32_t)ones.size()), is_comm_fletcher16_ref(0xFFFF, ones.data(), (uint32_t)ones.size()));
+	EXPECT_EQ(calculate24BitCRCQ(ones.data(), (unsigned int)ones.size()), calculate24BitCRCQ_ref(ones.data(), (unsigned int)ones.size()));
+
+	// CRC-24Q check value
+	uint8_t check[] = "123456789";
+	EXPECT_EQ(calculate24BitCRCQ(check, 9), 0xCDE703u);
+}
+
+TEST(ISComm, ChecksumKernelsThroughput)
+{
+	const int packetSize = 1024;
+	const int iterations = 20000;
+	std::vector<uint8_t> data = randomBytes(packetSize, 3);
+	uint32_t sum = 0;
+
+	auto mbPerSec = [&](std::function<uint32_t()> fn)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++)
+		{
+			data[0] = (uint8_t)i;
+			sum += fn();
+		}
+		double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return (double)packetSize * iterations / _MAX(sec, 1.0e-6) * 1.0e-6;
+	};
+
+	double fletcherRef = mbPerSec([&]() { return (uint32_t)is_comm_fletcher16_ref(0, data.data(), packetSize); });
+	double fletcher    = mbPerSec([&]() { return (uint32_t)is_comm_fletcher16(0, data.data(), packetSize); });
+	double crcRef      = mbPerSec([&]() { return (uint32_t)calculate24BitCRCQ_ref(data.data(), packetSize); });
+	double crc         = mbPerSec([&]() { return (uint32_t)calculate24BitCRCQ(data.data(), packetSize); });
+	EXPECT_NE(sum, 0u);
+
+	printf("Checksum throughput (MB/s)  fletcher16 ref: %.0f  fast: %.0f   crc24q ref: %.0f  fast: %.0f\n", fletcherRef, fletcher, crcRef, crc);
+}
+#endif
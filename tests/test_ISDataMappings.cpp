@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <deque>
+#include <algorithm>
 #include "ISDataMappings.h"
+#include "ISUtilities.h"
+#include "DataCSV.h"
 
 using namespace std;
 
@@ -53,3 +56,215 @@ TEST(ISDataMappings, StringToDataToString)
 	}
 }
 
+TEST(ISDataMappings, FieldTableLookup)
+{
+	for (uint32_t id = 0; id < DID_COUNT; id++)
+	{
+		const map_name_to_info_t& infoMap = *cISDataMappings::GetMapInfo(id);
+		uint32_t count;
+		const data_info_t* fields = cISDataMappings::GetFields(id, count);
+		ASSERT_EQ(count, infoMap.size());
+		ASSERT_TRUE(count == 0 || fields != nullptr);
+
+		uint32_t i = 0;
+		for (map_name_to_info_t::const_iterator it = infoMap.begin(); it != infoMap.end(); it++, i++)
+		{
+			// same order as the map
+			EXPECT_EQ(fields[i].name, it->first);
+			EXPECT_EQ(fields[i].dataOffset, it->second.dataOffset);
+
+			// case-insensitive, like the map
+			string upper = it->first;
+			transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+			EXPECT_EQ(cISDataMappings::GetFieldInfo(id, it->first), &fields[i]);
+			EXPECT_EQ(cISDataMappings::GetFieldInfo(id, upper), &fields[i]);
+			EXPECT_EQ(cISDataMappings::GetFieldInfo(id, it->first + "x"), nullptr);
+
+			// name need not be null terminated
+			string padded = it->first + "[0]";
+			EXPECT_EQ(cISDataMappings::GetFieldInfo(id, padded.c_str(), it->first.size()), &fields[i]);
+		}
+		EXPECT_EQ(cISDataMappings::GetFieldInfo(id, ""), nullptr);
+
+		const char* name = cISDataMappings::GetDataSetName(id);
+		if (name[0] != '\0')
+		{
+			EXPECT_EQ(cISDataMappings::GetDataSetId(name), id);
+		}
+	}
+
+	uint32_t count;
+	EXPECT_EQ(cISDataMappings::GetFields(DID_COUNT, count), nullptr);
+	EXPECT_EQ(count, 0u);
+	EXPECT_EQ(cISDataMappings::GetFieldInfo(DID_COUNT, "week"), nullptr);
+	EXPECT_EQ(cISDataMappings::GetDataSetId("DID_INS_2"), (uint32_t)DID_INS_2);
+	EXPECT_EQ(cISDataMappings::GetDataSetId("did_ins_2"), 0u);
+	EXPECT_EQ(cISDataMappings::GetDataSetId("DID_NOT_A_DATA_SET"), 0u);
+
+	// lookup time against the map
+	const map_name_to_info_t& flashMap = *cISDataMappings::GetMapInfo(DID_FLASH_CONFIG);
+	vector<string> names;
+	for (map_name_to_info_t::const_iterator it = flashMap.begin(); it != flashMap.end(); it++)
+	{
+		names.push_back(it->first);
+	}
+	const int loops = 2000;
+	uint64_t found = 0;
+	uint64_t startUs = current_timeUs();
+	for (int n = 0; n < loops; n++)
+	{
+		for (const string& fieldName : names)
+		{
+			found += flashMap.find(fieldName)->second.dataSize;
+		}
+	}
+	double mapUs = (double)(current_timeUs() - startUs);
+	startUs = current_timeUs();
+	for (int n = 0; n < loops; n++)
+	{
+		for (const string& fieldName : names)
+		{
+			found += cISDataMappings::GetFieldInfo(DID_FLASH_CONFIG, fieldName)->dataSize;
+		}
+	}
+	double tableUs = (double)(current_timeUs() - startUs);
+	double lookups = (double)loops * names.size();
+	printf("DID_FLASH_CONFIG %d fields  map find: %.1f ns  field table: %.1f ns  (%.1fx)\n",
+		(int)names.size(), 1000.0 * mapUs / lookups, 1000.0 * tableUs / lookups, mapUs / tableUs);
+	EXPECT_GT(found, 0u);
+}
+
+// Reference csv row built one field at a time with cISDataMappings::DataToString
+static string referenceCsvRow(const p_data_hdr_t& hdr, const uint8_t* buf)
+{
+	uint32_t size = cISDataMappings::GetSize(hdr.id);
+	uint8_t full[MAX_DATASET_SIZE] = {};
+	memcpy(full + hdr.offset, buf, _MIN(hdr.size, size - hdr.offset));
+	p_data_hdr_t hdrCopy = hdr;
+	hdrCopy.offset = 0;
+	hdrCopy.size = size;
+
+	string csv;
+	data_mapping_string_t tmp;
+	const map_name_to_info_t& infoMap = *cISDataMappings::GetMapInfo(hdr.id);
+	for (map_name_to_info_t::const_iterator it = infoMap.begin(); it != infoMap.end(); it++)
+	{
+		cISDataMappings::DataToString(it->second, &hdrCopy, full, tmp);
+		csv += (csv.length() ? "," : "");
+		csv += tmp;
+	}
+	return csv + "\n";
+}
+
+static bool hasBinaryField(uint32_t id)
+{
+	const map_name_to_info_t& infoMap = *cISDataMappings::GetMapInfo(id);
+	for (map_name_to_info_t::const_iterator it = infoMap.begin(); it != infoMap.end(); it++)
+	{
+		if (it->second.dataType == DataTypeBinary)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TEST(ISDataMappings, CsvRowFormatter)
+{
+	cDataCSV csv;
+	string row;
+	uint8_t buf[MAX_DATASET_SIZE];
+	srand(1234);
+
+	for (uint32_t id = 1; id < DID_COUNT; id++)
+	{
+		uint32_t size = cISDataMappings::GetSize(id);
+		if (cISDataMappings::GetMapInfo(id) == NULLPTR || size == 0 || size > MAX_DATASET_SIZE || hasBinaryField(id))
+		{	// binary fields include a stray leading character from DataToString
+			continue;
+		}
+		cDataCSVRowFormatter* formatter = csv.RowFormatter(id);
+		ASSERT_NE(formatter, nullptr);
+
+		for (int n = 0; n < 50; n++)
+		{
+			// random bytes cover nan, inf, denormals, negative hex and unterminated strings
+			for (uint32_t i = 0; i < size; i++)
+			{
+				buf[i] = (uint8_t)rand();
+			}
+			p_data_hdr_t hdr = { (uint8_t)id, (uint16_t)size, 0 };
+			if (n % 5 == 4)
+			{	// partial packet
+				hdr.offset = (uint16_t)(rand() % size);
+				hdr.size = (uint16_t)(1 + rand() % (size - hdr.offset));
+			}
+
+			ASSERT_TRUE(csv.DataToStringCSV(hdr, buf, row));
+			ASSERT_EQ(row, referenceCsvRow(hdr, buf)) << "DID " << id;
+			ASSERT_LE(row.length() + 21, formatter->MaxLength());
+
+			int length;
+			uint64_t orderId = 18446744073709551615ULL;
+			const char* idRow = formatter->Format(hdr, buf, length, &orderId);
+			ASSERT_NE(idRow, nullptr);
+			EXPECT_EQ(string(idRow, length), "18446744073709551615," + row);
+		}
+	}
+
+	EXPECT_EQ(csv.RowFormatter(DID_COUNT), nullptr);
+	EXPECT_FALSE(csv.DataToStringCSV({ DID_COUNT, 4, 0 }, buf, row));
+}
+
+TEST(ISDataMappings, CsvRowFormatterBenchmark)
+{
+	const uint32_t ids[] = { DID_INS_2, DID_PIMU, DID_GPS1_POS };
+	const int rows = 100000;
+	cDataCSV csv;
+	string row;
+	uint8_t buf[MAX_DATASET_SIZE];
+
+	for (uint32_t id : ids)
+	{
+		uint32_t size = cISDataMappings::GetSize(id);
+		p_data_hdr_t hdr = { (uint8_t)id, (uint16_t)size, 0 };
+
+		// realistic values rather than random bytes
+		const map_name_to_info_t& infoMap = *cISDataMappings::GetMapInfo(id);
+		memset(buf, 0, sizeof(buf));
+		int n = 1;
+		for (map_name_to_info_t::const_iterator it = infoMap.begin(); it != infoMap.end(); it++, n++)
+		{
+			string value = to_string(n * 12.3456789);
+			if (it->second.dataType != DataTypeFloat && it->second.dataType != DataTypeDouble)
+			{
+				value = to_string(n * 1234567);
+			}
+			cISDataMappings::StringToData(value.c_str(), (int)value.length(), &hdr, buf, it->second);
+		}
+		ASSERT_EQ(referenceCsvRow(hdr, buf), (csv.DataToStringCSV(hdr, buf, row), row));
+
+		uint64_t startUs = current_timeUs();
+		size_t bytes = 0;
+		for (int i = 0; i < rows; i++)
+		{
+			bytes += referenceCsvRow(hdr, buf).length();
+		}
+		double referenceS = (current_timeUs() - startUs) * 0.000001;
+
+		cDataCSVRowFormatter* formatter = csv.RowFormatter(id);
+		startUs = current_timeUs();
+		for (int i = 0; i < rows; i++)
+		{
+			int length;
+			uint64_t orderId = i;
+			formatter->Format(hdr, buf, length, &orderId);
+			bytes += length;
+		}
+		double formatterS = (current_timeUs() - startUs) * 0.000001;
+
+		printf("%-10s %3d fields  DataToString: %9.0f rows/s  row formatter: %9.0f rows/s  (%.1fx)\n",
+			cISDataMappings::GetDataSetName(id), (int)infoMap.size(), rows / referenceS, rows / formatterS, referenceS / formatterS);
+		EXPECT_GT(bytes, 0u);
+	}
+}
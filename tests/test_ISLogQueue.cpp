@@ -0,0 +1,321 @@
+#include <gtest/gtest.h>
+#include <deque>
+#include <vector>
+#include <thread>
+#include "ISLogQueue.h"
+
+static p_data_buf_t makePacket(uint32_t n)
+{
+	p_data_buf_t d = {};
+	d.hdr.id = 1 + (n % 100);
+	d.hdr.size = (uint16_t)(4 + (n * 13) % (MAX_DATASET_SIZE - 4));
+	d.hdr.offset = 0;
+	for (int i = 0; i < d.hdr.size; i++)
+	{
+		d.buf[i] = (uint8_t)(n + i);
+	}
+	return d;
+}
+
+static void expectFrontPacket(cLogPacketQueue& queue, const p_data_buf_t& ref)
+{
+	const uint8_t* buf = nullptr;
+	p_data_hdr_t* hdr = queue.Front(&buf);
+	ASSERT_NE(hdr, nullptr);
+	EXPECT_TRUE(hdr->id == ref.hdr.id);
+	EXPECT_TRUE(hdr->size == ref.hdr.size);
+	EXPECT_TRUE(hdr->offset == ref.hdr.offset);
+	EXPECT_EQ(memcmp(buf, ref.buf, ref.hdr.size), 0);
+	queue.Pop();
+}
+
+TEST(ISLogQueue, PushPopWrap)
+{
+	cLogPacketQueue queue(8 * 1024);
+	std::deque<p_data_buf_t> myDeque;
+	const uint8_t* buf;
+
+	// Keep a few packets in the queue so records wrap around the end of the buffer many times
+	for (uint32_t n = 0; n < 10000; n++)
+	{
+		p_data_buf_t d = makePacket(n);
+		if (queue.Push(d.hdr, d.buf))
+		{
+			myDeque.push_back(d);
+		}
+
+		while (myDeque.size() > 3)
+		{
+			expectFrontPacket(queue, myDeque.front());
+			myDeque.pop_front();
+		}
+	}
+
+	while (myDeque.size())
+	{
+		expectFrontPacket(queue, myDeque.front());
+		myDeque.pop_front();
+	}
+	EXPECT_EQ(queue.Front(&buf), nullptr);
+	EXPECT_TRUE(queue.Empty());
+	EXPECT_EQ(queue.Stats().dropCount, 0u);
+}
+
+TEST(ISLogQueue, DropWhenFull)
+{
+	cLogPacketQueue queue(4 * 1024);
+	p_data_buf_t d = makePacket(0);
+	d.hdr.size = 100;
+
+	uint32_t pushed = 0;
+	while (queue.Push(d.hdr, d.buf))
+	{
+		pushed++;
+	}
+	EXPECT_GT(pushed, 0u);
+	EXPECT_FALSE(queue.Push(d.hdr, d.buf));
+
+	log_queue_stats_t stats = queue.Stats();
+	EXPECT_EQ(stats.pushCount, pushed);
+	EXPECT_EQ(stats.dropCount, 2u);
+	EXPECT_LE(stats.highWaterBytes, stats.capacityBytes);
+	EXPECT_GE(stats.highWaterBytes, pushed * 100u);
+
+	// Only hdr.size bytes are stored per packet
+	EXPECT_GT(pushed, queue.Capacity() / sizeof(p_data_buf_t));
+
+	// Space is available again once the consumer catches up
+	const uint8_t* buf;
+	ASSERT_NE(queue.Front(&buf), nullptr);
+	queue.Pop();
+	EXPECT_TRUE(queue.Push(d.hdr, d.buf));
+}
+
+TEST(ISLogQueue, LargeRecordsFitSmallQueue)
+{
+	// Records larger than MAX_DATASET_SIZE, i.e. the receive thread packets, always fit an empty queue
+	const uint32_t maxDataSize = 3000;
+	cLogPacketQueue queue(1024, cLogPacketQueue::OVERFLOW_DROP_NEWEST, maxDataSize);
+	EXPECT_GE(queue.Capacity(), 2 * maxDataSize);
+
+	std::vector<uint8_t> data(maxDataSize);
+	for (uint32_t n = 0; n < 100; n++)
+	{
+		// Varying sizes so the records end at different offsets and wrap
+		p_data_hdr_t hdr = {};
+		hdr.id = (uint8_t)n;
+		hdr.size = (uint16_t)(maxDataSize - (n * 157) % 2000);
+		memset(data.data(), (int)n, hdr.size);
+		ASSERT_TRUE(queue.Push(hdr, data.data()));
+
+		const uint8_t* buf = nullptr;
+		p_data_hdr_t* front = queue.Front(&buf);
+		ASSERT_NE(front, nullptr);
+		EXPECT_EQ(front->size, hdr.size);
+		EXPECT_EQ(memcmp(buf, data.data(), hdr.size), 0);
+		queue.Pop();
+	}
+	EXPECT_EQ(queue.Stats().dropCount, 0u);
+}
+
+TEST(ISLogQueue, ProducerConsumerThreads)
+{
+	cLogPacketQueue queue(16 * 1024);
+	const uint32_t count = 200000;
+
+	std::thread producer([&]()
+	{
+		for (uint32_t n = 0; n < count; n++)
+		{
+			p_data_buf_t d = makePacket(n);
+			d.hdr.size = (uint16_t)(8 + n % 64);
+			memcpy(d.buf, &n, sizeof(n));
+			while (!queue.Push(d.hdr, d.buf))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	uint32_t expected = 0;
+	while (expected < count)
+	{
+		const uint8_t* buf;
+		p_data_hdr_t* hdr = queue.Front(&buf);
+		if (hdr == nullptr)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		uint32_t n;
+		memcpy(&n, buf, sizeof(n));
+		ASSERT_EQ(n, expected);
+		ASSERT_TRUE(hdr->size == 8 + n % 64);
+		queue.Pop();
+		expected++;
+	}
+	producer.join();
+
+	EXPECT_TRUE(queue.Empty());
+	EXPECT_EQ(queue.Stats().pushCount, count);
+}
+
+TEST(ISLogQueue, DropOldestWhenFull)
+{
+	cLogPacketQueue queue(4 * 1024, cLogPacketQueue::OVERFLOW_DROP_OLDEST);
+	const uint32_t count = 1000;
+
+	for (uint32_t n = 0; n < count; n++)
+	{
+		p_data_buf_t d = makePacket(n);
+		d.hdr.size = 100;
+		memcpy(d.buf, &n, sizeof(n));
+		EXPECT_TRUE(queue.Push(d.hdr, d.buf));
+	}
+
+	// Only the newest packets remain, in order
+	log_queue_stats_t stats = queue.Stats();
+	uint32_t remaining = queue.Count();
+	EXPECT_GT(remaining, 0u);
+	EXPECT_EQ(stats.pushCount, count);
+	EXPECT_EQ(stats.dropCount, count - remaining);
+
+	const uint8_t* buf;
+	for (uint32_t n = count - remaining; n < count; n++)
+	{
+		p_data_hdr_t* hdr = queue.Front(&buf);
+		ASSERT_NE(hdr, nullptr);
+		uint32_t val;
+		memcpy(&val, buf, sizeof(val));
+		EXPECT_EQ(val, n);
+		queue.Pop();
+	}
+	EXPECT_EQ(queue.Front(&buf), nullptr);
+	EXPECT_EQ(queue.Count(), 0u);
+}
+
+TEST(ISLogQueue, DropOldestProducerConsumerThreads)
+{
+	cLogPacketQueue queue(4 * 1024, cLogPacketQueue::OVERFLOW_DROP_OLDEST);
+	const uint32_t count = 200000;
+	std::atomic<bool> done(false);
+
+	std::thread producer([&]()
+	{
+		for (uint32_t n = 0; n < count; n++)
+		{
+			p_data_buf_t d = makePacket(n);
+			d.hdr.size = (uint16_t)(8 + n % 64);
+			memcpy(d.buf, &n, sizeof(n));
+			memcpy(d.buf + d.hdr.size - sizeof(n), &n, sizeof(n));
+			queue.Push(d.hdr, d.buf);
+		}
+		done = true;
+	});
+
+	// Packets may be dropped but are never torn or out of order
+	int64_t last = -1;
+	uint64_t received = 0;
+	while (!done || !queue.Empty())
+	{
+		const uint8_t* buf;
+		p_data_hdr_t* hdr = queue.Front(&buf);
+		if (hdr == nullptr)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		uint32_t first, last4;
+		memcpy(&first, buf, sizeof(first));
+		memcpy(&last4, buf + hdr->size - sizeof(last4), sizeof(last4));
+		ASSERT_EQ(first, last4);
+		ASSERT_TRUE(hdr->size == 8 + first % 64);
+		ASSERT_GT((int64_t)first, last);
+		last = first;
+		received++;
+		queue.Pop();
+	}
+	producer.join();
+
+	EXPECT_EQ(last, (int64_t)count - 1);
+	EXPECT_GE(received + queue.Stats().dropCount, (uint64_t)count);
+}
+
+TEST(ISLogQueue, BlockUntilConsumed)
+{
+	cLogPacketQueue queue(4 * 1024, cLogPacketQueue::OVERFLOW_BLOCK);
+	cLogQueueEvent dataReady;
+	queue.SetWakeup(&dataReady, 1024, 1000);
+	const uint32_t count = 5000;
+
+	std::thread producer([&]()
+	{
+		for (uint32_t n = 0; n < count; n++)
+		{
+			p_data_buf_t d = makePacket(n);
+			d.hdr.size = 100;
+			memcpy(d.buf, &n, sizeof(n));
+			queue.Push(d.hdr, d.buf);
+		}
+	});
+
+	// Slow consumer only runs when woken by the queue, nothing is dropped
+	uint32_t expected = 0;
+	while (expected < count)
+	{
+		dataReady.Wait(LOG_QUEUE_WAKE_TIMEOUT_MS);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		const uint8_t* buf;
+		while (queue.Front(&buf) != nullptr)
+		{
+			uint32_t n;
+			memcpy(&n, buf, sizeof(n));
+			ASSERT_EQ(n, expected);
+			expected++;
+			queue.Pop();
+		}
+	}
+	producer.join();
+
+	log_queue_stats_t stats = queue.Stats();
+	EXPECT_EQ(stats.pushCount, count);
+	EXPECT_EQ(stats.dropCount, 0u);
+	EXPECT_GT(stats.blockCount, 0u);
+}
+
+TEST(ISLogQueue, WakeupThreshold)
+{
+	cLogPacketQueue queue;
+	cLogQueueEvent dataReady;
+	queue.SetWakeup(&dataReady, 100000, 10);
+	p_data_buf_t d = makePacket(0);
+	d.hdr.size = 16;
+
+	for (int i = 0; i < 9; i++)
+	{
+		queue.Push(d.hdr, d.buf);
+	}
+	EXPECT_FALSE(dataReady.Wait(0));
+
+	// Signaled once at the threshold
+	queue.Push(d.hdr, d.buf);
+	queue.Push(d.hdr, d.buf);
+	EXPECT_TRUE(dataReady.Wait(0));
+	queue.Push(d.hdr, d.buf);
+	EXPECT_FALSE(dataReady.Wait(0));
+
+	// Rearmed once the consumer empties the queue
+	const uint8_t* buf;
+	while (queue.Front(&buf) != nullptr)
+	{
+		queue.Pop();
+	}
+	for (int i = 0; i < 10; i++)
+	{
+		queue.Push(d.hdr, d.buf);
+	}
+	EXPECT_TRUE(dataReady.Wait(0));
+}
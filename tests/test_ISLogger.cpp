@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include "ISLogger.h"
 #include "ISDataMappings.h"
 #include "ISFileManager.h"
+#include "ISDevice.h"
+#include "ISUtilities.h"
 #include "test_data_utils.h"
 
 #if 1
@@ -84,8 +87,8 @@ static void TestConvertLog(string inputPath, cISLogger::eLogType inputLogType, c
 
 		if (data1 != NULL && 
 			cISDataMappings::GetSize(data1->hdr.id) == 0 &&
-			convertLogType == cISLogger::eLogType::LOGTYPE_CSV)
-		{	// CSV logs don't save DIDs not defined in ISDataMapping.  Skip this one.
+			(convertLogType == cISLogger::eLogType::LOGTYPE_CSV || convertLogType == cISLogger::eLogType::LOGTYPE_COLUMNAR))
+		{	// CSV and columnar logs don't save DIDs not defined in ISDataMapping.  Skip this one.
 			continue;
 		}
 
@@ -127,6 +130,12 @@ static void TestConvertLog(string inputPath, cISLogger::eLogType inputLogType, c
 			continue;
 		}
 
+		if (convertLogType == cISLogger::eLogType::LOGTYPE_COLUMNAR &&
+			(data1->hdr.offset != 0 || data1->hdr.size != data2->hdr.size))
+		{	// Columnar logs save partial packets as full rows
+			continue;
+		}
+
 		uint32_t i1 = 0;
 		uint32_t i2 = 0;
 
@@ -206,6 +215,7 @@ TEST(ISLogger, dat_conversion)
 	TestConvertLog(logPath, cISLogger::eLogType::LOGTYPE_DAT, cISLogger::eLogType::LOGTYPE_DAT);
 	TestConvertLog(logPath, cISLogger::eLogType::LOGTYPE_DAT, cISLogger::eLogType::LOGTYPE_SDAT);
 	TestConvertLog(logPath, cISLogger::eLogType::LOGTYPE_DAT, cISLogger::eLogType::LOGTYPE_CSV);
+	TestConvertLog(logPath, cISLogger::eLogType::LOGTYPE_DAT, cISLogger::eLogType::LOGTYPE_COLUMNAR);
 	DELETE_DIRECTORY(logPath);
 }
 
@@ -237,6 +247,798 @@ TEST(ISLogger, raw_conversion_with_garbage)
 	DELETE_DIRECTORY(logPath);
 }
 
+// Packets/second written from the receive queue by the logger thread, before and after resolving the device log once per batch
+TEST(ISLogger, log_queue_throughput)
+{
+	string logPath = "test_log_throughput";
+	const int numPackets = 200000;
+	const int batchSize = 100;
+
+	std::vector<ISDevice> devices(1);
+	devices[0].devInfo.serialNumber = 12345;
+
+	cISLogger logger;
+	EXPECT_TRUE(logger.InitSave(cISLogger::eLogType::LOGTYPE_DAT, logPath, s_maxDiskSpacePercent, s_maxFileSize, s_useTimestampSubFolder));
+	logger.registerDevice(devices[0]);
+	logger.EnableLogging(true);
+
+	cLogPacketQueue queue;
+	pimu_t pimu = {};
+	p_data_hdr_t hdr = { DID_PIMU, sizeof(pimu_t), 0 };
+
+	// Before: ISDevice copied and device log shared_ptr passed by value for every packet
+	uint64_t startUs = current_timeUs();
+	for (int n = 0; n < numPackets; n += batchSize)
+	{
+		for (int i = 0; i < batchSize; i++)
+		{
+			pimu.time = (n + i) * 0.001;
+			queue.Push(hdr, (uint8_t*)&pimu);
+		}
+
+		p_data_hdr_t* qHdr;
+		const uint8_t* buf;
+		while ((qHdr = queue.Front(&buf)) != NULL)
+		{
+			auto device = devices[0];
+			std::shared_ptr<cDeviceLog> devLogger = device.devLogger;
+			logger.LogData(devLogger, qHdr, buf);
+			queue.Pop();
+		}
+	}
+	double beforeSec = (current_timeUs() - startUs) * 1.0e-6;
+
+	// After: device log resolved once per batch, packets written in place from the queue
+	int count = 0;
+	startUs = current_timeUs();
+	for (int n = 0; n < numPackets; n += batchSize)
+	{
+		for (int i = 0; i < batchSize; i++)
+		{
+			pimu.time = (n + i) * 0.001;
+			queue.Push(hdr, (uint8_t*)&pimu);
+		}
+		count += logger.LogQueuedData(devices[0].devLogger, queue);
+	}
+	double afterSec = (current_timeUs() - startUs) * 1.0e-6;
+	EXPECT_EQ(count, numPackets);
+	EXPECT_EQ(logger.GetStats().isbStats.at(DID_PIMU).count, (uint64_t)(2 * numPackets));
+
+	printf("Logger throughput (packets/sec)  before: %.0f  after: %.0f\n", numPackets / _MAX(beforeSec, 1.0e-6), numPackets / _MAX(afterSec, 1.0e-6));
+
+	logger.CloseAllFiles();
+	DELETE_DIRECTORY(logPath);
+}
+
+// Chunks written by the I/O thread, across several files, read back identical to what was logged
+TEST(ISLogger, dat_async_write)
+{
+	string logPath = "test_log_async";
+	const int numPackets = 50000;
+	const uint32_t maxChunksInFlight = 2;
+	ISFileManager::DeleteDirectory(logPath);
+
+	std::vector<ISDevice> devices(1);
+	devices[0].devInfo.serialNumber = 23456;
+
+	cISLogger logger;
+	logger.SetAsyncWriteChunks(maxChunksInFlight);
+	EXPECT_TRUE(logger.InitSave(cISLogger::eLogType::LOGTYPE_DAT, logPath, s_maxDiskSpacePercent, 1024 * 1024, s_useTimestampSubFolder));
+	logger.registerDevice(devices[0]);
+	logger.EnableLogging(true);
+
+	std::shared_ptr<cDeviceLogSerial> devLog = std::dynamic_pointer_cast<cDeviceLogSerial>(devices[0].devLogger);
+	ASSERT_NE(devLog, nullptr);
+	EXPECT_TRUE(devLog->AsyncWriteEnabled());
+
+	pimu_t pimu = {};
+	for (int n = 0; n < numPackets; n++)
+	{
+		pimu.time = n * 0.001;
+		pimu.status = n;
+		EXPECT_TRUE(LogData(logger, devLog, DID_PIMU, 0, sizeof(pimu_t), &pimu));
+	}
+	EXPECT_GT(devLog->FileCount(), 1u);
+	// Queued writes are finished on return
+	logger.CloseAllFiles();
+	log_chunk_writer_stats_t stats = devLog->AsyncWriteStats();
+	EXPECT_EQ(stats.queueDepth, 0u);
+	EXPECT_EQ(stats.bytesWritten, devLog->LogSize());
+
+	EXPECT_EQ(stats.writeErrorCount, 0u);
+	EXPECT_LE(stats.queueDepthMax, maxChunksInFlight + 1);
+	printf("Async chunk write  chunks: %llu  latency avg: %u us  max: %u us  waits: %u\n", (unsigned long long)stats.chunkCount, stats.latencyAvgUs, stats.latencyMaxUs, stats.waitCount);
+
+	cISLogger reader;
+	ASSERT_TRUE(reader.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT));
+	int count = 0;
+	size_t devIndex = 0;
+	p_data_buf_t* data;
+	while ((data = reader.ReadNextData(devIndex)) != NULL)
+	{
+		ASSERT_EQ(data->hdr.id, (uint32_t)DID_PIMU);
+		pimu_t* p = (pimu_t*)data->buf;
+		ASSERT_EQ(p->status, (uint32_t)count);
+		count++;
+	}
+	EXPECT_EQ(count, numPackets);
+	reader.CloseAllFiles();
+
+	DELETE_DIRECTORY(logPath);
+}
+
+// Memory mapped reads return the same packets as streamed reads
+TEST(ISLogger, dat_mapped_read)
+{
+	string logPath = "test_log_mapped";
+	GenerateDataLogFiles(2, logPath, cISLogger::eLogType::LOGTYPE_DAT, 10);
+
+	cISLogger streamLogger;
+	cISLogger mappedLogger;
+	ASSERT_TRUE(streamLogger.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT));
+	ASSERT_TRUE(mappedLogger.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT, {}, cISLogger::READMODE_MAPPED));
+
+	size_t devIndex1 = 0;
+	size_t devIndex2 = 0;
+	int count = 0;
+	while (1)
+	{
+		p_data_buf_t* data1 = streamLogger.ReadNextData(devIndex1);
+		p_data_buf_t* data2 = mappedLogger.ReadNextData(devIndex2);
+		ASSERT_EQ(devIndex1, devIndex2);
+		if (data1 == NULL || data2 == NULL)
+		{
+			EXPECT_TRUE(data1 == data2);
+			break;
+		}
+		ASSERT_EQ(data1->hdr.id, data2->hdr.id);
+		ASSERT_EQ(data1->hdr.size, data2->hdr.size);
+		ASSERT_EQ(data1->hdr.offset, data2->hdr.offset);
+		ASSERT_EQ(memcmp(data1->buf, data2->buf, data1->hdr.size), 0) << "packet " << count;
+		count++;
+	}
+	EXPECT_GT(count, 0);
+	streamLogger.CloseAllFiles();
+	mappedLogger.CloseAllFiles();
+
+	// Read time for each mode
+	for (int mode = cISLogger::READMODE_STREAM; mode <= cISLogger::READMODE_MAPPED; mode++)
+	{
+		cISLogger logger;
+		ASSERT_TRUE(logger.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT, {}, (cISLogger::eReadMode)mode));
+		uint64_t startUs = current_timeUs();
+		size_t devIndex = 0;
+		int n = 0;
+		while (logger.ReadNextData(devIndex) != NULL)
+		{
+			n++;
+		}
+		EXPECT_EQ(n, count);
+		printf("Read %d packets %s: %.1f ms\n", n, (mode == cISLogger::READMODE_MAPPED ? "mapped" : "streamed"), (current_timeUs() - startUs) * 0.001);
+		logger.CloseAllFiles();
+	}
+
+	DELETE_DIRECTORY(logPath);
+}
+
+// First packet at or after a time, read sequentially
+static bool FindFirstAtTime(const string& logPath, double timestamp, p_data_buf_t& found)
+{
+	cISLogger logger;
+	EXPECT_TRUE(logger.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT));
+	size_t devIndex = 0;
+	p_data_buf_t* data;
+	while ((data = logger.ReadNextData(devIndex)) != NULL)
+	{
+		if (cISDataMappings::GetTimestamp(&data->hdr, data->buf) >= timestamp)
+		{
+			found.hdr = data->hdr;
+			memcpy(found.buf, data->buf, data->hdr.size);
+			return true;
+		}
+	}
+	return false;
+}
+
+// Chunk index sidecar files are used to seek to a time and to skip chunks when reading a subset of DIDs
+TEST(ISLogger, dat_chunk_index)
+{
+	string logPath = "test_log_index";
+	const int numPackets = 60000;
+	ISFileManager::DeleteDirectory(logPath);
+
+	std::vector<ISDevice> devices(1);
+	devices[0].devInfo.serialNumber = 34567;
+	{
+		cISLogger logger;
+		EXPECT_TRUE(logger.InitSave(cISLogger::eLogType::LOGTYPE_DAT, logPath, s_maxDiskSpacePercent, 512 * 1024, s_useTimestampSubFolder));
+		logger.registerDevice(devices[0]);
+		logger.EnableLogging(true);
+
+		pimu_t pimu = {};
+		ins_1_t ins = {};
+		sys_params_t sys = {};
+		for (int n = 0; n < numPackets; n++)
+		{
+			pimu.time = 100.0 + n * 0.001;
+			pimu.status = n;
+			EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_PIMU, 0, sizeof(pimu_t), &pimu));
+			if (n % 10 == 0)
+			{
+				ins.timeOfWeek = pimu.time;
+				EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_INS_1, 0, sizeof(ins_1_t), &ins));
+			}
+			if (n % 1000 == 0)
+			{
+				sys.timeOfWeekMs = n;
+				EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_SYS_PARAMS, 0, sizeof(sys_params_t), &sys));
+			}
+		}
+		logger.CloseAllFiles();
+		devices[0].devLogger = nullptr;
+	}
+
+	vector<ISFileManager::file_info_t> datFiles, idxFiles;
+	ISFileManager::GetDirectorySpaceUsed(logPath, "\\.dat$", datFiles, false, false);
+	ISFileManager::GetDirectorySpaceUsed(logPath, "\\.idx$", idxFiles, false, false);
+	EXPECT_GT(datFiles.size(), 2u);
+	EXPECT_EQ(datFiles.size(), idxFiles.size());
+
+	for (int mode = cISLogger::READMODE_STREAM; mode <= cISLogger::READMODE_MAPPED; mode++)
+	{
+		// Seek matches a sequential search
+		double times[] = { 0.0, 100.0, 100.5, 123.4567, 140.0, 159.999 };
+		for (double t : times)
+		{
+			p_data_buf_t expected;
+			ASSERT_TRUE(FindFirstAtTime(logPath, t, expected));
+
+			cISLogger reader;
+			ASSERT_TRUE(reader.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT, {}, (cISLogger::eReadMode)mode));
+			EXPECT_TRUE(reader.Seek(t));
+			size_t devIndex = 0;
+			p_data_buf_t* data = reader.ReadNextData(devIndex);
+			ASSERT_NE(data, nullptr);
+			EXPECT_EQ(data->hdr.id, expected.hdr.id) << "time " << t;
+			EXPECT_EQ(memcmp(data->buf, expected.buf, expected.hdr.size), 0) << "time " << t;
+
+			// Reading continues in order from there
+			if (data->hdr.id == DID_PIMU && ((pimu_t*)data->buf)->status + 1 < numPackets)
+			{
+				uint32_t status = ((pimu_t*)data->buf)->status;
+				while ((data = reader.ReadNextData(devIndex)) != NULL && data->hdr.id != DID_PIMU) {}
+				ASSERT_NE(data, nullptr);
+				EXPECT_EQ(((pimu_t*)data->buf)->status, status + 1);
+			}
+		}
+
+		// Past the end
+		cISLogger reader;
+		ASSERT_TRUE(reader.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT, {}, (cISLogger::eReadMode)mode));
+		EXPECT_FALSE(reader.Seek(1000.0));
+		size_t devIndex = 0;
+		EXPECT_EQ(reader.ReadNextData(devIndex), nullptr);
+
+		// DID filtered read
+		ASSERT_TRUE(reader.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT, {}, (cISLogger::eReadMode)mode));
+		reader.SetReadFilter({ DID_SYS_PARAMS });
+		devIndex = 0;
+		int count = 0;
+		p_data_buf_t* data;
+		while ((data = reader.ReadNextData(devIndex)) != NULL)
+		{
+			ASSERT_EQ(data->hdr.id, (uint32_t)DID_SYS_PARAMS);
+			EXPECT_EQ(((sys_params_t*)data->buf)->timeOfWeekMs, (uint32_t)(count * 1000));
+			count++;
+		}
+		EXPECT_EQ(count, numPackets / 1000);
+
+		// Filter and seek together
+		ASSERT_TRUE(reader.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT, {}, (cISLogger::eReadMode)mode));
+		reader.SetReadFilter({ DID_INS_1 });
+		EXPECT_TRUE(reader.Seek(130.0));
+		devIndex = 0;
+		data = reader.ReadNextData(devIndex);
+		ASSERT_NE(data, nullptr);
+		EXPECT_EQ(data->hdr.id, (uint32_t)DID_INS_1);
+		EXPECT_NEAR(((ins_1_t*)data->buf)->timeOfWeek, 130.0, 0.0015);
+		reader.CloseAllFiles();
+	}
+
+	DELETE_DIRECTORY(logPath);
+}
+
+static vector<uint8_t> ReadFileBytes(const string& path)
+{
+	vector<uint8_t> bytes;
+	FILE* f = fopen(path.c_str(), "rb");
+	if (f)
+	{
+		uint8_t buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		{
+			bytes.insert(bytes.end(), buf, buf + n);
+		}
+		fclose(f);
+	}
+	return bytes;
+}
+
+// Devices converted on several threads produce the same files as a serial conversion
+TEST(ISLogger, copy_log_parallel)
+{
+	string logPath = "test_log_copy_parallel";
+	string timestamp = "20240102_030405";
+	GenerateDataLogFiles(4, logPath, cISLogger::eLogType::LOGTYPE_DAT, 4);
+
+	cISLogger::eLogType types[] = { cISLogger::eLogType::LOGTYPE_DAT, cISLogger::eLogType::LOGTYPE_CSV, cISLogger::eLogType::LOGTYPE_RAW };
+	for (cISLogger::eLogType logType : types)
+	{
+		string outPath[2] = { logPath + "_serial", logPath + "_parallel" };
+		uint64_t count[2] = {};
+		double elapsedMs[2] = {};
+		for (int i = 0; i < 2; i++)
+		{
+			ISFileManager::DeleteDirectory(outPath[i]);
+			cISLogger src;
+			cISLogger dst;
+			ASSERT_TRUE(src.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT));
+			dst.SetCopyThreads(i == 0 ? 1 : 4);
+			uint64_t startUs = current_timeUs();
+			EXPECT_TRUE(dst.CopyLog(src, timestamp, outPath[i], logType, s_maxDiskSpacePercent, 1024 * 1024, s_useTimestampSubFolder, true));
+			elapsedMs[i] = (current_timeUs() - startUs) * 0.001;
+			count[i] = dst.GetStats().count;
+			src.CloseAllFiles();
+		}
+		printf("CopyLog type %d  serial: %.1f ms  parallel: %.1f ms\n", logType, elapsedMs[0], elapsedMs[1]);
+		EXPECT_GT(count[0], 0u);
+		EXPECT_EQ(count[0], count[1]);
+
+		vector<ISFileManager::file_info_t> files[2];
+		for (int i = 0; i < 2; i++)
+		{
+			ISFileManager::GetDirectorySpaceUsed(outPath[i], files[i], false, false);
+			sort(files[i].begin(), files[i].end(), [](const ISFileManager::file_info_t& a, const ISFileManager::file_info_t& b) { return a.name < b.name; });
+		}
+		ASSERT_GT(files[0].size(), 4u);
+		ASSERT_EQ(files[0].size(), files[1].size());
+		for (size_t n = 0; n < files[0].size(); n++)
+		{
+			EXPECT_EQ(ISFileManager::GetFileName(files[0][n].name), ISFileManager::GetFileName(files[1][n].name));
+			EXPECT_TRUE(ReadFileBytes(files[0][n].name) == ReadFileBytes(files[1][n].name)) << files[1][n].name;
+		}
+
+		DELETE_DIRECTORY(outPath[0]);
+		DELETE_DIRECTORY(outPath[1]);
+	}
+
+	DELETE_DIRECTORY(logPath);
+}
+
+static void LogCompressionTestData(const string& logPath, uint32_t serial, int compressionLevel, uint32_t asyncWriteChunks, int numPackets)
+{
+	ISFileManager::DeleteDirectory(logPath);
+	std::vector<ISDevice> devices(1);
+	devices[0].devInfo.serialNumber = serial;
+
+	cISLogger logger;
+	logger.SetCompressionLevel(compressionLevel);
+	logger.SetAsyncWriteChunks(asyncWriteChunks);
+	EXPECT_TRUE(logger.InitSave(cISLogger::eLogType::LOGTYPE_DAT, logPath, s_maxDiskSpacePercent, 512 * 1024, s_useTimestampSubFolder));
+	logger.registerDevice(devices[0]);
+	logger.EnableLogging(true);
+
+	pimu_t pimu = {};
+	ins_1_t ins = {};
+	for (int n = 0; n < numPackets; n++)
+	{
+		pimu.time = 100.0 + n * 0.001;
+		pimu.status = n;
+		pimu.vel[2] = -9.8f + 0.01f * (float)sin(n * 0.01);
+		pimu.theta[0] = 0.001f * (float)cos(n * 0.003);
+		EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_PIMU, 0, sizeof(pimu_t), &pimu));
+		if (n % 10 == 0)
+		{
+			ins.timeOfWeek = pimu.time;
+			ins.lla[0] = 40.0 + n * 1.0e-7;
+			EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_INS_1, 0, sizeof(ins_1_t), &ins));
+		}
+	}
+	logger.CloseAllFiles();
+
+	const cLogStats& stats = logger.GetStats();
+	if (compressionLevel > 0)
+	{
+		EXPECT_GT(stats.compressStats.chunkCount, 0u);
+		EXPECT_LT(stats.compressStats.compressedBytes, stats.compressStats.rawBytes);
+		printf("Compression level %d  ratio: %.2f  %.1f MB/s\n", compressionLevel, (double)stats.compressStats.rawBytes / stats.compressStats.compressedBytes,
+			(double)stats.compressStats.rawBytes / _MAX(stats.compressStats.timeUs, 1));
+	}
+	else
+	{
+		EXPECT_EQ(stats.compressStats.chunkCount, 0u);
+	}
+	devices[0].devLogger = nullptr;
+}
+
+// Compressed chunks are smaller and read back the same as uncompressed chunks
+TEST(ISLogger, dat_compression)
+{
+	string plainPath = "test_log_plain";
+	string compressedPath = "test_log_compressed";
+	string asyncPath = "test_log_compressed_async";
+	const int numPackets = 60000;
+	LogCompressionTestData(plainPath, 45678, 0, 0, numPackets);
+	LogCompressionTestData(compressedPath, 45678, LOG_CHUNK_COMPRESSION_DEFAULT_LEVEL, 0, numPackets);
+	LogCompressionTestData(asyncPath, 45678, 6, 2, numPackets);
+
+	vector<ISFileManager::file_info_t> plainFiles, compressedFiles;
+	uint64_t plainSize = ISFileManager::GetDirectorySpaceUsed(plainPath, "\\.dat$", plainFiles, false, false);
+	uint64_t compressedSize = ISFileManager::GetDirectorySpaceUsed(compressedPath, "\\.dat$", compressedFiles, false, false);
+	EXPECT_LT(compressedSize, plainSize / 2);
+	EXPECT_LT(compressedFiles.size(), plainFiles.size());
+
+	for (const string& path : { compressedPath, asyncPath })
+	{
+		for (int mode = cISLogger::READMODE_STREAM; mode <= cISLogger::READMODE_MAPPED; mode++)
+		{
+			cISLogger plain;
+			cISLogger compressed;
+			ASSERT_TRUE(plain.LoadFromDirectory(plainPath, cISLogger::eLogType::LOGTYPE_DAT));
+			ASSERT_TRUE(compressed.LoadFromDirectory(path, cISLogger::eLogType::LOGTYPE_DAT, {}, (cISLogger::eReadMode)mode));
+			size_t devIndex1 = 0;
+			size_t devIndex2 = 0;
+			int count = 0;
+			while (1)
+			{
+				p_data_buf_t* data1 = plain.ReadNextData(devIndex1);
+				p_data_buf_t* data2 = compressed.ReadNextData(devIndex2);
+				if (data1 == NULL || data2 == NULL)
+				{
+					EXPECT_TRUE(data1 == data2);
+					break;
+				}
+				ASSERT_EQ(data1->hdr.id, data2->hdr.id);
+				ASSERT_EQ(data1->hdr.size, data2->hdr.size);
+				ASSERT_EQ(memcmp(data1->buf, data2->buf, data1->hdr.size), 0) << "packet " << count;
+				count++;
+			}
+			EXPECT_EQ(count, numPackets + numPackets / 10);
+
+			// Chunk index offsets point at the compressed chunks
+			EXPECT_TRUE(compressed.Seek(130.0));
+			devIndex2 = 0;
+			p_data_buf_t* data = compressed.ReadNextData(devIndex2);
+			ASSERT_NE(data, nullptr);
+			EXPECT_NEAR(cISDataMappings::GetTimestamp(&data->hdr, data->buf), 130.0, 0.0015);
+
+			compressed.CloseAllFiles();
+			EXPECT_GT(compressed.GetStats().decompressStats.chunkCount, 0u);
+			plain.CloseAllFiles();
+		}
+	}
+
+	DELETE_DIRECTORY(plainPath);
+	DELETE_DIRECTORY(compressedPath);
+	DELETE_DIRECTORY(asyncPath);
+}
+
+// Packet index of a row in the columnar_mmap test log, every other full packet is followed by a partial packet
+static int ColumnarTestRowIndex(int row)
+{
+	return 2 * (row / 3) + (row % 3 == 2 ? 1 : 0);
+}
+
+// Columnar log columns are used in place from a memory mapped file.  A csv log of the same data must read back the
+// same rows, the read times of both are printed.
+TEST(ISLogger, columnar_mmap)
+{
+	const int numPackets = 100000;
+	const cISLogger::eLogType logTypes[] = { cISLogger::eLogType::LOGTYPE_COLUMNAR, cISLogger::eLogType::LOGTYPE_CSV };
+	vector<imu_t> columnarRows;
+	for (cISLogger::eLogType logType : logTypes)
+	{
+		string logPath = (logType == cISLogger::eLogType::LOGTYPE_CSV ? "test_log_col_csv" : "test_log_col");
+		ISFileManager::DeleteDirectory(logPath);
+		std::vector<ISDevice> devices(1);
+		devices[0].devInfo.serialNumber = 56789;
+
+		cISLogger logger;
+		EXPECT_TRUE(logger.InitSave(logType, logPath, s_maxDiskSpacePercent, s_maxFileSize, s_useTimestampSubFolder));
+		logger.registerDevice(devices[0]);
+		logger.EnableLogging(true);
+		imu_t imu = {};
+		for (int n = 0; n < numPackets; n++)
+		{
+			imu.time = 100.0 + n * 0.001;
+			imu.status = n;
+			imu.I.acc[2] = -9.8f + 0.01f * (float)sin(n * 0.01);
+			EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_IMU, 0, sizeof(imu_t), &imu));
+			if (n % 2 == 0)
+			{	// Partial packet
+				EXPECT_TRUE(LogData(logger, devices[0].devLogger, DID_IMU, offsetof(imu_t, status), sizeof(uint32_t), &imu.status));
+			}
+		}
+		logger.CloseAllFiles();
+		devices[0].devLogger = nullptr;
+
+		// Read back
+		uint64_t startUs = current_timeUs();
+		cISLogger reader;
+		ASSERT_TRUE(reader.LoadFromDirectory(logPath, logType));
+		size_t devIndex = 0;
+		int count = 0;
+		p_data_buf_t* data;
+		while ((data = reader.ReadNextData(devIndex)) != NULL)
+		{
+			ASSERT_EQ(data->hdr.id, (uint32_t)DID_IMU);
+			ASSERT_EQ(data->hdr.size, sizeof(imu_t));
+			imu_t* value = (imu_t*)data->buf;
+			if (logType == cISLogger::eLogType::LOGTYPE_COLUMNAR)
+			{	// Partial packet rows hold the last value of the other fields
+				int n = ColumnarTestRowIndex(count);
+				ASSERT_NEAR(value->time, 100.0 + n * 0.001, 1.0e-6) << "row " << count;
+				ASSERT_EQ(value->status, (uint32_t)n) << "row " << count;
+				columnarRows.push_back(*value);
+			}
+			else
+			{	// Same rows as the columnar log, within csv float precision.  Partial packet rows hold no other fields
+				// and csv hex fields (status) are not read back, so time and acc of full packet rows are compared.
+				ASSERT_LT((size_t)count, columnarRows.size());
+				if (count % 3 != 1)
+				{
+					const imu_t& ref = columnarRows[count];
+					ASSERT_NEAR(value->time, ref.time, 1.0e-6) << "row " << count;
+					ASSERT_NEAR(value->I.acc[2], ref.I.acc[2], 1.0e-4f) << "row " << count;
+				}
+			}
+			count++;
+		}
+		EXPECT_EQ(count, numPackets + numPackets / 2);
+		printf("Read %d %s rows: %.1f ms\n", count, (logType == cISLogger::eLogType::LOGTYPE_CSV ? "csv" : "columnar"), (current_timeUs() - startUs) * 0.001);
+		reader.CloseAllFiles();
+
+		if (logType == cISLogger::eLogType::LOGTYPE_COLUMNAR)
+		{	// Load the time column directly
+			vector<ISFileManager::file_info_t> files;
+			ISFileManager::GetDirectorySpaceUsed(logPath, "_imu\\.col$", files, false, false);
+			ASSERT_GT(files.size(), 1u);
+			std::sort(files.begin(), files.end(), [](const ISFileManager::file_info_t& a, const ISFileManager::file_info_t& b) { return a.name < b.name; });
+
+			startUs = current_timeUs();
+			uint64_t rows = 0;
+			uint64_t lastId = 0;
+			for (size_t i = 0; i < files.size(); i++)
+			{
+				cISLogFileMapped file;
+				ASSERT_TRUE(file.open(files[i].name));
+				const col_file_header_t* hdr = cDeviceLogColumnar::ValidateFile(file.data(), file.size());
+				ASSERT_NE(hdr, nullptr);
+				EXPECT_EQ(hdr->dataId, (uint32_t)DID_IMU);
+				EXPECT_EQ(hdr->dataSize, sizeof(imu_t));
+
+				const col_field_t* field;
+				const double* time = (const double*)cDeviceLogColumnar::FindColumn(hdr, "time", &field);
+				const uint64_t* id = (const uint64_t*)cDeviceLogColumnar::FindColumn(hdr, "_ID_");
+				ASSERT_NE(time, nullptr);
+				ASSERT_NE(id, nullptr);
+				EXPECT_EQ(field->dataType, (uint32_t)DataTypeDouble);
+				EXPECT_EQ(field->dataOffset, offsetof(imu_t, time));
+				EXPECT_EQ((uintptr_t)time % COL_FILE_ALIGN, 0u);
+				for (uint64_t r = 0; r < hdr->rowCount; r++, rows++)
+				{
+					int n = ColumnarTestRowIndex((int)rows);
+					ASSERT_NEAR(time[r], 100.0 + n * 0.001, 1.0e-6);
+					ASSERT_TRUE(rows == 0 || id[r] > lastId);
+					lastId = id[r];
+				}
+			}
+			EXPECT_EQ(rows, (uint64_t)count);
+			printf("Mapped %d columnar time values: %.1f ms\n", (int)rows, (current_timeUs() - startUs) * 0.001);
+		}
+
+		DELETE_DIRECTORY(logPath);
+	}
+}
+
+// Data of several devices is read back as one time ordered sequence, keeping the order of each device
+TEST(ISLogger, read_by_time)
+{
+	string logPath = "test_log_by_time";
+	ISFileManager::DeleteDirectory(logPath);
+	const int numDevices = 3;
+	const int numPackets = 20000;
+
+	// Devices log at different rates and start times, with untimed data in between
+	std::vector<ISDevice> devices(numDevices);
+	{
+		cISLogger logger;
+		EXPECT_TRUE(logger.InitSave(cISLogger::eLogType::LOGTYPE_DAT, logPath, s_maxDiskSpacePercent, 512 * 1024, s_useTimestampSubFolder));
+		for (int d = 0; d < numDevices; d++)
+		{
+			devices[d].devInfo.serialNumber = 30000 + d;
+			logger.registerDevice(devices[d]);
+		}
+		logger.EnableLogging(true);
+		for (int d = 0; d < numDevices; d++)
+		{
+			pimu_t pimu = {};
+			for (int n = 0; n < numPackets / (d + 1); n++)
+			{
+				pimu.time = 100.0 + d * 0.0005 + n * 0.001 * (d + 1);
+				pimu.status = n;
+				EXPECT_TRUE(LogData(logger, devices[d].devLogger, DID_PIMU, 0, sizeof(pimu_t), &pimu));
+				if (n % 100 == 0)
+				{
+					EXPECT_TRUE(LogData(logger, devices[d].devLogger, DID_DEV_INFO, 0, sizeof(dev_info_t), &devices[d].devInfo));
+				}
+			}
+		}
+		logger.CloseAllFiles();
+		for (int d = 0; d < numDevices; d++)
+		{
+			devices[d].devLogger = nullptr;
+		}
+	}
+
+	cISLogger logger;
+	ASSERT_TRUE(logger.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_DAT));
+	ASSERT_EQ(logger.DeviceCount(), (uint32_t)numDevices);
+
+	std::map<uint32_t, uint32_t> nextStatus;
+	std::map<uint32_t, int> counts;
+	double lastTime = 0.0;
+	int count = 0;
+	p_data_buf_t* data;
+	std::shared_ptr<cDeviceLog> devLog;
+	while ((data = logger.ReadNextDataByTime(&devLog)) != NULL)
+	{
+		ASSERT_NE(devLog, nullptr);
+		uint32_t serial = devLog->SerialNumber();
+		counts[serial]++;
+		count++;
+		if (data->hdr.id == DID_DEV_INFO)
+		{
+			EXPECT_EQ(((dev_info_t*)data->buf)->serialNumber, serial);
+			continue;
+		}
+		ASSERT_EQ(data->hdr.id, (uint32_t)DID_PIMU);
+		pimu_t* pimu = (pimu_t*)data->buf;
+		ASSERT_GE(pimu->time, lastTime) << "packet " << count;
+		ASSERT_EQ(pimu->status, nextStatus[serial]++);
+		lastTime = pimu->time;
+	}
+
+	ASSERT_EQ((int)counts.size(), numDevices);
+	for (int d = 0; d < numDevices; d++)
+	{
+		int n = numPackets / (d + 1);
+		EXPECT_EQ(counts[30000 + d], n + (n + 99) / 100);
+	}
+
+	// Seek restarts the sequence
+	EXPECT_TRUE(logger.Seek(110.0));
+	data = logger.ReadNextDataByTime();
+	ASSERT_NE(data, nullptr);
+	EXPECT_NEAR(cISDataMappings::GetTimestamp(&data->hdr, data->buf), 110.0, 0.0015);
+	logger.CloseAllFiles();
+
+	DELETE_DIRECTORY(logPath);
+}
+
+// Synthetic multi-DID packet for the sorted log benchmark, DIDs at different rates and sizes
+static void SortedTestPacket(int n, p_data_buf_t& d)
+{
+	static const struct { uint32_t id; uint32_t size; int period; } dids[] =
+	{
+		{ DID_PIMU,         sizeof(pimu_t),         1 },
+		{ DID_IMU,          sizeof(imu_t),          1 },
+		{ DID_INS_1,        sizeof(ins_1_t),        2 },
+		{ DID_INS_2,        sizeof(ins_2_t),        4 },
+		{ DID_MAGNETOMETER, sizeof(magnetometer_t), 5 },
+		{ DID_BAROMETER,    sizeof(barometer_t),    10 },
+		{ DID_GPS1_POS,     sizeof(gps_pos_t),      20 },
+		{ DID_GPS1_VEL,     sizeof(gps_vel_t),      20 },
+		{ DID_SYS_PARAMS,   sizeof(sys_params_t),   100 },
+		{ DID_STROBE_IN_TIME, sizeof(strobe_in_time_t), 997 },
+	};
+	const int numDids = (int)(sizeof(dids) / sizeof(dids[0]));
+
+	// Packet n is the n-th due DID, taking DIDs due at each step in order
+	static std::vector<uint8_t> schedule;
+	while ((int)schedule.size() <= n)
+	{
+		int step = (int)schedule.size();
+		for (int i = 0; i < numDids; i++)
+		{
+			if (step % dids[i].period == 0)
+			{
+				schedule.push_back((uint8_t)i);
+			}
+		}
+	}
+
+	int i = schedule[n];
+	d.hdr.id = dids[i].id;
+	d.hdr.offset = 0;
+	d.hdr.size = dids[i].size;
+	if (dids[i].id == DID_INS_2 && (n / 1000) % 3 == 0)
+	{	// Partial packets change the chunk data header
+		d.hdr.offset = 8;
+		d.hdr.size -= 8;
+	}
+	for (uint32_t b = 0; b < d.hdr.size; b++)
+	{
+		d.buf[b] = (uint8_t)(n * 7 + b);
+	}
+	memcpy(d.buf, &n, sizeof(n));
+}
+
+// Sorted log reads back the original packet order from chunks of many DIDs spread across files
+TEST(ISLogger, sdat_read_benchmark)
+{
+	string logPath = "test_log_sdat_bench";
+	ISFileManager::DeleteDirectory(logPath);
+	const int numPackets = 300000;
+
+	{
+		std::vector<ISDevice> devices(1);
+		devices[0].devInfo.serialNumber = 40000;
+		cISLogger logger;
+		EXPECT_TRUE(logger.InitSave(cISLogger::eLogType::LOGTYPE_SDAT, logPath, s_maxDiskSpacePercent, 2 * 1024 * 1024, s_useTimestampSubFolder));
+		logger.registerDevice(devices[0]);
+		logger.EnableLogging(true);
+		p_data_buf_t d;
+		for (int n = 0; n < numPackets; n++)
+		{
+			SortedTestPacket(n, d);
+			EXPECT_TRUE(logger.LogData(devices[0].devLogger, &d.hdr, d.buf));
+		}
+		logger.CloseAllFiles();
+		devices[0].devLogger = nullptr;
+	}
+
+	vector<ISFileManager::file_info_t> files;
+	uint64_t logSize = ISFileManager::GetDirectorySpaceUsed(logPath, "\\.sdat$", files, false, false);
+	EXPECT_GT(files.size(), 1u);
+
+	uint64_t startUs = current_timeUs();
+	cISLogger logger;
+	ASSERT_TRUE(logger.LoadFromDirectory(logPath, cISLogger::eLogType::LOGTYPE_SDAT));
+	size_t devIndex = 0;
+	int count = 0;
+	p_data_buf_t expected;
+	p_data_buf_t* data;
+	while ((data = logger.ReadNextData(devIndex)) != NULL)
+	{
+		ASSERT_LT(count, numPackets);
+		SortedTestPacket(count, expected);
+		ASSERT_EQ(data->hdr.id, expected.hdr.id) << "packet " << count;
+		ASSERT_EQ(data->hdr.size, expected.hdr.size) << "packet " << count;
+		ASSERT_EQ(data->hdr.offset, expected.hdr.offset) << "packet " << count;
+		ASSERT_EQ(memcmp(data->buf, expected.buf, expected.hdr.size), 0) << "packet " << count;
+		count++;
+	}
+	EXPECT_EQ(count, numPackets);
+	printf("Read %d sorted packets from %d files (%.1f MB): %.1f ms\n", count, (int)files.size(), logSize / (1024.0 * 1024.0), (current_timeUs() - startUs) * 0.001);
+
+	// Each chunk is read once, with a seek per chunk at most
+	ASSERT_EQ(logger.DeviceCount(), 1u);
+	cDeviceLogSorted* sortedLog = dynamic_cast<cDeviceLogSorted*>(logger.DeviceLogs()[0].get());
+	ASSERT_NE(sortedLog, nullptr);
+	log_chunk_read_stats_t stats = sortedLog->ReadStats();
+	EXPECT_GT(stats.chunkCount, 0u);
+	EXPECT_LE(stats.bytesRead, logSize + logSize / 10);
+	EXPECT_LE(stats.seekCount, 2 * stats.chunkCount + files.size());
+	printf("  chunks: %llu  seeks: %llu (%.4f per packet)  bytes read: %llu (%.1f per packet)  waits: %llu (%.1f ms)\n",
+		(unsigned long long)stats.chunkCount, (unsigned long long)stats.seekCount, (double)stats.seekCount / count,
+		(unsigned long long)stats.bytesRead, (double)stats.bytesRead / count, (unsigned long long)stats.waitCount, stats.waitUs * 0.001);
+	logger.CloseAllFiles();
+
+	DELETE_DIRECTORY(logPath);
+}
+
 // TEST(ISLogger, dat_conversion_with_multiple_files_issue_Aug_2017)
 // {
 // 	TestConvertLog(DATA_DIR"logger_dat3", cISLogger::eLogType::LOGTYPE_DAT, cISLogger::eLogType::LOGTYPE_DAT);
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "ISPortRxThread.h"
+#include "ISUtilities.h"
+
+typedef struct
+{
+	std::vector<uint8_t> data;
+	std::atomic<size_t> pos;
+	uint32_t seed;
+} fake_port_t;
+
+typedef struct
+{
+	protocol_type_t ptype;
+	uint16_t did;
+	std::vector<uint8_t> data;
+} rx_packet_t;
+
+// Returns the data in random sized chunks
+static int fakePortRead(serial_port_t* serialPort, unsigned char* buf, int len, int timeoutMs)
+{
+	fake_port_t* port = (fake_port_t*)serialPort->handle;
+	size_t pos = port->pos;
+	if (pos >= port->data.size())
+	{
+		if (timeoutMs > 0)
+		{
+			SLEEP_MS(1);
+		}
+		return 0;
+	}
+
+	port->seed = port->seed * 1103515245 + 12345;
+	int n = (int)_MIN((size_t)len, _MIN(port->data.size() - pos, (size_t)(1 + (port->seed >> 16) % 300)));
+	memcpy(buf, &port->data[pos], n);
+	port->pos = pos + n;
+	return n;
+}
+
+static int fakePortIsOpen(serial_port_t* serialPort)
+{
+	(void)serialPort;
+	return 1;
+}
+
+static void initFakePort(serial_port_t* serialPort, fake_port_t* port)
+{
+	memset(serialPort, 0, sizeof(serial_port_t));
+	serialPort->handle = port;
+	serialPort->pfnRead = fakePortRead;
+	serialPort->pfnIsOpen = fakePortIsOpen;
+	port->pos = 0;
+	port->seed = 1;
+}
+
+// ISB data packets of varying size interleaved with NMEA sentences
+static void generateStream(std::vector<uint8_t>& stream, int count)
+{
+	is_comm_instance_t comm;
+	uint8_t commBuf[PKT_BUF_SIZE];
+	is_comm_init(&comm, commBuf, sizeof(commBuf));
+
+	uint8_t data[MAX_DATASET_SIZE];
+	uint8_t buf[PKT_BUF_SIZE];
+	for (int i = 0; i < count; i++)
+	{
+		if (i % 5 == 4)
+		{
+			char nmea[64];
+			int n = snprintf(nmea, sizeof(nmea), "$GPGGA,%d,,,,,0,00,,,M,,M,,", i);
+			uint8_t checksum = 0;
+			for (int j = 1; j < n; j++)
+			{
+				checksum ^= (uint8_t)nmea[j];
+			}
+			n += snprintf(nmea + n, sizeof(nmea) - n, "*%02X\r\n", checksum);
+			stream.insert(stream.end(), nmea, nmea + n);
+			continue;
+		}
+
+		uint16_t size = (uint16_t)(4 + (i * 37) % 400);
+		for (int j = 0; j < size; j++)
+		{
+			data[j] = (uint8_t)(i + j);
+		}
+		int n = is_comm_write_to_buf(buf, sizeof(buf), &comm, PKT_TYPE_DATA, (uint16_t)(1 + i % 50), size, 0, data);
+		stream.insert(stream.end(), buf, buf + n);
+	}
+}
+
+static rx_packet_t toPacket(protocol_type_t ptype, is_comm_instance_t* comm)
+{
+	rx_packet_t pkt;
+	pkt.ptype = ptype;
+	pkt.did = (ptype == _PTYPE_INERTIAL_SENSE_DATA ? comm->rxPkt.dataHdr.id : 0);
+	if (ptype != _PTYPE_PARSE_ERROR)
+	{
+		pkt.data.assign(comm->rxPkt.data.ptr, comm->rxPkt.data.ptr + comm->rxPkt.data.size);
+	}
+	return pkt;
+}
+
+static std::vector<rx_packet_t> parseReference(std::vector<uint8_t>& stream)
+{
+	is_comm_instance_t comm;
+	uint8_t commBuf[PKT_BUF_SIZE];
+	is_comm_init(&comm, commBuf, sizeof(commBuf));
+
+	std::vector<rx_packet_t> packets;
+	for (size_t i = 0; i < stream.size(); )
+	{
+		int n = _MIN(is_comm_free(&comm), (int)(stream.size() - i));
+		memcpy(comm.rxBuf.tail, &stream[i], n);
+		comm.rxBuf.tail += n;
+		i += n;
+
+		protocol_type_t ptype;
+		while ((ptype = is_comm_parse(&comm)) != _PTYPE_NONE)
+		{
+			packets.push_back(toPacket(ptype, &comm));
+		}
+	}
+	return packets;
+}
+
+static void expectPacketsEqual(const std::vector<rx_packet_t>& a, const std::vector<rx_packet_t>& b)
+{
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		ASSERT_EQ(a[i].ptype, b[i].ptype) << "packet " << i;
+		ASSERT_EQ(a[i].did, b[i].did) << "packet " << i;
+		ASSERT_EQ(a[i].data, b[i].data) << "packet " << i;
+	}
+}
+
+TEST(ISPortRxThread, DeliversPacketsInOrder)
+{
+	fake_port_t port;
+	serial_port_t serialPort;
+	initFakePort(&serialPort, &port);
+	generateStream(port.data, 5000);
+	std::vector<rx_packet_t> reference = parseReference(port.data);
+	ASSERT_EQ(reference.size(), 5000u);
+
+	// Queue holds the whole stream, as the fake port is not rate limited like a real one
+	cLogQueueEvent wake;
+	cISPortRxThread rx(0, &serialPort, 4 * 1024 * 1024);
+	rx.Start(&wake);
+
+	is_comm_instance_t comm;
+	uint8_t commBuf[PKT_BUF_SIZE];
+	is_comm_init(&comm, commBuf, sizeof(commBuf));
+
+	std::vector<rx_packet_t> packets;
+	auto start = std::chrono::steady_clock::now();
+	while (packets.size() < reference.size() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+	{
+		wake.Wait(10);
+
+		protocol_type_t ptype;
+		while ((ptype = rx.Front(&comm)) != _PTYPE_NONE)
+		{
+			packets.push_back(toPacket(ptype, &comm));
+			rx.Pop();
+		}
+	}
+	rx.Stop();
+
+	expectPacketsEqual(packets, reference);
+
+	port_rx_stats_t stats = rx.Stats();
+	EXPECT_EQ(stats.rxBytes, port.data.size());
+	EXPECT_EQ(stats.rxPacketCount, reference.size());
+	EXPECT_EQ(stats.dispatchCount, reference.size());
+	EXPECT_EQ(stats.dropCount, 0u);
+	EXPECT_GE(stats.latencyMaxUs, stats.latencyAvgUs);
+	EXPECT_GT(stats.queueHighWaterBytes, 0u);
+}
+
+TEST(ISPortRxThread, DropsWhenApplicationFallsBehind)
+{
+	fake_port_t port;
+	serial_port_t serialPort;
+	initFakePort(&serialPort, &port);
+	generateStream(port.data, 2000);
+	std::vector<rx_packet_t> reference = parseReference(port.data);
+
+	// No thread, step the receive side until the port is drained without dispatching
+	cISPortRxThread rx(0, &serialPort, 16 * 1024);
+	while (rx.Step(0) > 0) {}
+
+	port_rx_stats_t stats = rx.Stats();
+	EXPECT_EQ(stats.rxPacketCount, reference.size());
+	EXPECT_GT(stats.dropCount, 0u);
+
+	// Queued packets are intact and in order.  Once full, only packets small enough for the remaining space are queued.
+	is_comm_instance_t comm;
+	uint8_t commBuf[PKT_BUF_SIZE];
+	is_comm_init(&comm, commBuf, sizeof(commBuf));
+
+	std::vector<rx_packet_t> packets;
+	protocol_type_t ptype;
+	while ((ptype = rx.Front(&comm)) != _PTYPE_NONE)
+	{
+		packets.push_back(toPacket(ptype, &comm));
+		rx.Pop();
+	}
+	ASSERT_GT(packets.size(), 0u);
+	size_t j = 0;
+	for (size_t i = 0; i < reference.size() && j < packets.size(); i++)
+	{
+		if (reference[i].ptype == packets[j].ptype && reference[i].did == packets[j].did && reference[i].data == packets[j].data)
+		{
+			j++;
+		}
+	}
+	EXPECT_EQ(j, packets.size());
+
+	stats = rx.Stats();
+	EXPECT_EQ(stats.dispatchCount + stats.dropCount, reference.size());
+}
+
+TEST(ISPortRxThread, RawData)
+{
+	fake_port_t port;
+	serial_port_t serialPort;
+	initFakePort(&serialPort, &port);
+	generateStream(port.data, 100);
+
+	cISPortRxThread rx(0, &serialPort);
+	rx.SetRawEnabled(true);
+
+	std::vector<uint8_t> raw;
+	while (rx.Step(0) > 0)
+	{
+		int size;
+		const uint8_t* data;
+		while ((data = rx.FrontRaw(&size)) != NULL)
+		{
+			raw.insert(raw.end(), data, data + size);
+			rx.PopRaw();
+		}
+	}
+	EXPECT_EQ(raw, port.data);
+}
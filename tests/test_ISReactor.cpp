@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <chrono>
+#include "ISReactor.h"
+
+#if PLATFORM_IS_LINUX
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+class cPipe
+{
+public:
+	cPipe() { EXPECT_EQ(pipe(fds), 0); }
+	~cPipe() { close(fds[0]); close(fds[1]); }
+	int ReadFd() { return fds[0]; }
+	void Write(uint8_t b) { EXPECT_EQ(write(fds[1], &b, 1), 1); }
+	void Drain() { uint8_t buf[64]; EXPECT_GT(read(fds[0], buf, sizeof(buf)), 0); }
+	int fds[2];
+};
+
+TEST(ISReactor, ReadableSlots)
+{
+	cISReactor reactor;
+	ASSERT_TRUE(reactor.Open());
+
+	cPipe pipes[4];
+	std::vector<int> fds = { pipes[0].ReadFd(), pipes[1].ReadFd(), -1, pipes[2].ReadFd(), pipes[3].ReadFd() };
+	reactor.Watch(fds);
+
+	std::vector<uint8_t> ready;
+	EXPECT_EQ(reactor.Wait(0, ready), 0);
+	EXPECT_EQ(ready.size(), fds.size());
+
+	pipes[1].Write(1);
+	pipes[3].Write(2);
+	EXPECT_EQ(reactor.Wait(100, ready), 2);
+	EXPECT_EQ(ready, std::vector<uint8_t>({ 0, 1, 0, 0, 1 }));
+
+	// Level triggered, still readable until the data is read
+	EXPECT_EQ(reactor.Wait(0, ready), 2);
+	pipes[1].Drain();
+	pipes[3].Drain();
+	EXPECT_EQ(reactor.Wait(0, ready), 0);
+
+	// Slots follow the descriptors when the set changes
+	fds = { pipes[3].ReadFd(), pipes[0].ReadFd() };
+	reactor.Watch(fds);
+	pipes[3].Write(3);
+	pipes[2].Write(4);
+	EXPECT_EQ(reactor.Wait(100, ready), 1);
+	EXPECT_EQ(ready, std::vector<uint8_t>({ 1, 0 }));
+}
+
+TEST(ISReactor, WaitTimeout)
+{
+	cISReactor reactor;
+	ASSERT_TRUE(reactor.Open());
+
+	cPipe p;
+	reactor.Watch({ p.ReadFd() });
+
+	std::vector<uint8_t> ready;
+	auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(reactor.Wait(50, ready), 0);
+	EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(40));
+}
+
+TEST(ISReactor, ReopenedDescriptor)
+{
+	cISReactor reactor;
+	ASSERT_TRUE(reactor.Open());
+
+	cPipe a, b;
+	int fd = a.ReadFd();
+	reactor.Watch({ fd });
+
+	// Reuse the descriptor number for another file, which the kernel removes from the epoll set
+	ASSERT_EQ(dup2(b.ReadFd(), fd), fd);
+	b.Write(1);
+
+	std::vector<uint8_t> ready;
+	reactor.Watch({ fd });
+	EXPECT_EQ(reactor.Wait(0, ready), 0);
+
+	reactor.Invalidate();
+	reactor.Watch({ fd });
+	EXPECT_EQ(reactor.Wait(100, ready), 1);
+	EXPECT_EQ(ready[0], 1);
+}
+
+TEST(ISReactor, WritableSlots)
+{
+	cISReactor reactor;
+	ASSERT_TRUE(reactor.Open());
+
+	int sv[2];
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+	cPipe p;
+
+	// Only slots with queued output are watched for writability
+	std::vector<uint8_t> ready;
+	reactor.Watch({ p.ReadFd(), sv[0] });
+	EXPECT_EQ(reactor.Wait(0, ready), 0);
+
+	reactor.Watch({ p.ReadFd(), sv[0] }, { 0, 1 });
+	EXPECT_EQ(reactor.Wait(100, ready), 1);
+	EXPECT_EQ(ready, std::vector<uint8_t>({ 0, IS_REACTOR_WRITABLE }));
+
+	p.Write(1);
+	ASSERT_EQ(write(sv[1], "x", 1), 1);
+	EXPECT_EQ(reactor.Wait(100, ready), 2);
+	EXPECT_EQ(ready, std::vector<uint8_t>({ IS_REACTOR_READABLE, IS_REACTOR_READABLE | IS_REACTOR_WRITABLE }));
+
+	reactor.Watch({ p.ReadFd(), sv[0] }, { 0, 0 });
+	EXPECT_EQ(reactor.Wait(0, ready), 2);
+	EXPECT_EQ(ready, std::vector<uint8_t>({ IS_REACTOR_READABLE, IS_REACTOR_READABLE }));
+
+	close(sv[0]);
+	close(sv[1]);
+}
+
+#endif
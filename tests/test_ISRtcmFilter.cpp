@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "ISRtcmFilter.h"
+
+// Number of messages passed when a message arrives every intervalMs, with alternating jitter
+static int passCount(cISRtcmFilter& filter, int id, uint32_t intervalMs, uint32_t durationMs, uint32_t jitterMs = 0)
+{
+	int count = 0;
+	uint32_t startMs = 0xFFFFF000;	// includes a time wrap
+	for (uint32_t t = 0, n = 0; t < durationMs; t += intervalMs, n++)
+	{
+		count += filter.Pass(id, startMs + t + (n & 1) * jitterMs);
+	}
+	return count;
+}
+
+TEST(ISRtcmFilter, Select)
+{
+	cISRtcmFilter filter;
+	EXPECT_FALSE(filter.Enabled());
+	EXPECT_TRUE(filter.Pass(1077, 0));
+	EXPECT_TRUE(filter.Pass(9999, 0));
+
+	// Unlisted types are blocked
+	ASSERT_TRUE(filter.SetRules("MSM4,1005,1230"));
+	EXPECT_TRUE(filter.Enabled());
+	for (int id : { 1074, 1084, 1094, 1104, 1114, 1124, 1134, 1005, 1230 })
+	{
+		EXPECT_TRUE(filter.Pass(id, 0)) << id;
+	}
+	for (int id : { 1077, 1087, 1097, 1127, 1006, 1033, 1075, 4095, 4096, -1 })
+	{
+		EXPECT_FALSE(filter.Pass(id, 0)) << id;
+	}
+	EXPECT_EQ(filter.MessagesDropped(), 10u);
+
+	// Later items override earlier ones
+	ASSERT_TRUE(filter.SetRules("*,-MSM7,1087"));
+	EXPECT_TRUE(filter.Pass(1005, 0));
+	EXPECT_TRUE(filter.Pass(1074, 0));
+	EXPECT_TRUE(filter.Pass(1087, 0));
+	EXPECT_FALSE(filter.Pass(1077, 0));
+	EXPECT_FALSE(filter.Pass(1127, 0));
+
+	// Invalid rules leave the filter unchanged
+	for (const char* rules : { "1077x", "MSM8", "MSM", "4096", "1005/", "1005/10s", "-1005/1000", "1005/-1" })
+	{
+		EXPECT_FALSE(filter.SetRules(rules)) << rules;
+	}
+	EXPECT_EQ(filter.Rules(), "*,-MSM7,1087");
+	EXPECT_FALSE(filter.Pass(1077, 0));
+
+	ASSERT_TRUE(filter.SetRules(""));
+	EXPECT_FALSE(filter.Enabled());
+	EXPECT_TRUE(filter.Pass(1077, 0));
+}
+
+TEST(ISRtcmFilter, Decimate)
+{
+	cISRtcmFilter filter;
+	ASSERT_TRUE(filter.SetRules("MSM4/1000,MSM7/200,1005/10000,1230"));
+
+	// 5 Hz and 10 Hz observations to 1 Hz, 10 s of data
+	EXPECT_EQ(passCount(filter, 1074, 200, 10000), 10);
+	EXPECT_EQ(passCount(filter, 1084, 100, 10000), 10);
+
+	// Jitter doesn't skip a period or add one
+	EXPECT_EQ(passCount(filter, 1094, 200, 10000, 30), 10);
+	EXPECT_EQ(passCount(filter, 1124, 100, 10000, 40), 10);
+
+	// Already at or below the period
+	EXPECT_EQ(passCount(filter, 1077, 200, 10000), 50);
+	EXPECT_EQ(passCount(filter, 1087, 1000, 10000), 10);
+
+	// Station position every 10 s, 1230 not decimated
+	EXPECT_EQ(passCount(filter, 1005, 1000, 60000), 6);
+	EXPECT_EQ(passCount(filter, 1230, 1000, 10000), 10);
+
+	// A message that stops and restarts passes immediately
+	cISRtcmFilter restart;
+	ASSERT_TRUE(restart.SetRules("1005/10000"));
+	EXPECT_TRUE(restart.Pass(1005, 1000));
+	EXPECT_FALSE(restart.Pass(1005, 2000));
+	EXPECT_TRUE(restart.Pass(1005, 60000));
+	EXPECT_FALSE(restart.Pass(1005, 61000));
+	EXPECT_TRUE(restart.Pass(1005, 70000));
+}
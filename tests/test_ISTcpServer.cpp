@@ -0,0 +1,549 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "ISTcpServer.h"
+#include "ISUtilities.h"
+
+#if PLATFORM_IS_LINUX
+#include <poll.h>
+#endif
+
+#define TEST_FRAME_SIZE         1000
+#define TEST_FRAME_COUNT        20000
+#define TEST_QUEUE_LIMIT        (1024 * 1024)
+
+static void acceptClients(cISTcpServer& server, size_t count)
+{
+	for (int i = 0; i < 1000 && server.Clients().size() < count; i++)
+	{
+		server.Update();
+	}
+	ASSERT_EQ(server.Clients().size(), count);
+}
+
+// byte i of frame n is n + i
+static void makeFrame(uint32_t n, uint8_t* frame)
+{
+	for (int i = 0; i < TEST_FRAME_SIZE; i++)
+	{
+		frame[i] = (uint8_t)(n + i);
+	}
+}
+
+// Reads until all frames are received, checking that bytes arrive in order
+static void readFrames(cISTcpClient& client, std::atomic<uint64_t>& received, std::atomic<bool>& failed)
+{
+	uint8_t buf[8192];
+	uint64_t total = (uint64_t)TEST_FRAME_SIZE * TEST_FRAME_COUNT;
+	uint64_t start = current_timeMs();
+	while (received < total && current_timeMs() - start < 20000)
+	{
+		int count = client.Read(buf, sizeof(buf));
+		if (count <= 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		for (int i = 0; i < count; i++)
+		{
+			uint64_t pos = received + i;
+			if (buf[i] != (uint8_t)(pos / TEST_FRAME_SIZE + pos % TEST_FRAME_SIZE))
+			{
+				failed = true;
+				return;
+			}
+		}
+		received += count;
+	}
+}
+
+static void writeFrames(cISTcpServer& server, std::atomic<uint64_t>& received)
+{
+	uint8_t frame[TEST_FRAME_SIZE];
+	uint64_t total = (uint64_t)TEST_FRAME_SIZE * TEST_FRAME_COUNT;
+	for (uint32_t n = 0; n < TEST_FRAME_COUNT; n++)
+	{
+		makeFrame(n, frame);
+		EXPECT_EQ(server.Write(frame, TEST_FRAME_SIZE), TEST_FRAME_SIZE);
+		if (n % 64 == 0)
+		{	// Let the fast reader keep up, like a base station sending at a real data rate
+			SLEEP_MS(1);
+		}
+	}
+
+	// Drain the fast client
+	uint64_t start = current_timeMs();
+	while (received < total && current_timeMs() - start < 20000)
+	{
+		server.Flush();
+		SLEEP_MS(1);
+	}
+}
+
+TEST(ISTcpServer, SlowClientDropped)
+{
+	cISTcpServer server;
+	ASSERT_EQ(server.Open("127.0.0.1", 0), 0);
+	server.SetClientQueueLimit(TEST_QUEUE_LIMIT, cISTcpServer::SLOW_CLIENT_DROP);
+
+	cISTcpClient fast, slow;
+	ASSERT_EQ(fast.Open("127.0.0.1", server.Port()), 0);
+	ASSERT_EQ(slow.Open("127.0.0.1", server.Port()), 0);
+	fast.SetBlocking(false);
+	slow.SetBlocking(false);
+	acceptClients(server, 2);
+
+	// The slow client never reads, which must not hold up the fast client or the writer
+	std::atomic<uint64_t> received(0);
+	std::atomic<bool> failed(false);
+	std::thread reader(readFrames, std::ref(fast), std::ref(received), std::ref(failed));
+	uint64_t startUs = current_timeUs();
+	writeFrames(server, received);
+	double elapsedS = (current_timeUs() - startUs) * 0.000001;
+	reader.join();
+
+	EXPECT_FALSE(failed);
+	EXPECT_EQ(received, (uint64_t)TEST_FRAME_SIZE * TEST_FRAME_COUNT);
+	ASSERT_EQ(server.Clients().size(), 2u);
+
+	std::vector<tcp_server_client_stats_t> stats = server.ClientStats();
+	ASSERT_EQ(stats.size(), 2u);
+	EXPECT_EQ(stats[0].bytesSent, (uint64_t)TEST_FRAME_SIZE * TEST_FRAME_COUNT);
+	EXPECT_EQ(stats[0].bytesDropped, 0u);
+	EXPECT_GT(stats[1].bytesDropped, 0u);
+	EXPECT_GT(stats[1].writesDropped, 0u);
+	EXPECT_LE(stats[1].lagMaxBytes, (uint32_t)TEST_QUEUE_LIMIT);
+	EXPECT_EQ(stats[1].bytesQueued, stats[1].bytesSent + stats[1].lagBytes);
+	EXPECT_EQ(stats[1].bytesQueued + stats[1].bytesDropped, (uint64_t)TEST_FRAME_SIZE * TEST_FRAME_COUNT);
+	printf("%.1f MB to 2 clients in %.2f s\n%s", TEST_FRAME_SIZE * TEST_FRAME_COUNT * 0.000001, elapsedS, server.ClientStatsSummary().c_str());
+
+	// Queued data is written once the slow client starts reading, and not one partial frame more
+	uint8_t buf[8192];
+	uint64_t slowReceived = 0;
+	uint64_t start = current_timeMs();
+	while (slowReceived < stats[1].bytesQueued && current_timeMs() - start < 5000)
+	{
+		server.Flush();
+		int count = slow.Read(buf, sizeof(buf));
+		ASSERT_GE(count, 0);
+		slowReceived += count;
+	}
+	EXPECT_EQ(slowReceived, stats[1].bytesQueued);
+	EXPECT_EQ(slowReceived % TEST_FRAME_SIZE, 0u);
+	EXPECT_FALSE(server.ClientHasQueuedData(1));
+}
+
+TEST(ISTcpServer, SlowClientDisconnected)
+{
+	cISTcpServer server;
+	ASSERT_EQ(server.Open("127.0.0.1", 0), 0);
+	server.SetClientQueueLimit(TEST_QUEUE_LIMIT, cISTcpServer::SLOW_CLIENT_DISCONNECT);
+
+	cISTcpClient slow, fast;
+	ASSERT_EQ(slow.Open("127.0.0.1", server.Port()), 0);
+	ASSERT_EQ(fast.Open("127.0.0.1", server.Port()), 0);
+	fast.SetBlocking(false);
+	acceptClients(server, 2);
+
+	std::atomic<uint64_t> received(0);
+	std::atomic<bool> failed(false);
+	std::thread reader(readFrames, std::ref(fast), std::ref(received), std::ref(failed));
+	writeFrames(server, received);
+	reader.join();
+
+	EXPECT_FALSE(failed);
+	EXPECT_EQ(received, (uint64_t)TEST_FRAME_SIZE * TEST_FRAME_COUNT);
+	EXPECT_EQ(server.Clients().size(), 1u);
+	EXPECT_EQ(server.SlowClientDisconnects(), 1u);
+	EXPECT_EQ(server.ClientStats()[0].bytesDropped, 0u);
+}
+
+#define TEST_CASTER_CLIENTS         200     // 500+ work with a high enough open file limit (ulimit -n)
+#define TEST_CASTER_FRAMES          500
+#define TEST_CASTER_FRAME_SIZE      200     // about the size of an MSM7 message
+
+typedef struct
+{
+	uint32_t seq;
+	uint64_t timeUs;
+} caster_frame_hdr_t;
+
+/**
+* Load test harness, loopback clients that read from a caster on one thread and record the latency of each frame
+*/
+class cCasterLoadTest
+{
+public:
+	bool Connect(int port, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			clients.emplace_back(new cISTcpClient());
+			if (clients.back()->Open("127.0.0.1", port) != 0)
+			{
+				return false;
+			}
+			clients.back()->SetBlocking(false);
+			fds.push_back((int)clients.back()->Socket());
+		}
+		pending.resize(count);
+		nextSeq.assign(count, 0);
+		return reactor.Open();
+	}
+
+	void Start()
+	{
+		reactor.Watch(fds);
+		reader = std::thread([this]() { Read(); });
+	}
+
+	void Stop()
+	{
+		done = true;
+		reader.join();
+	}
+
+	uint64_t FramesReceived() { return received; }
+
+	std::vector<std::unique_ptr<cISTcpClient>> clients;
+	std::vector<uint32_t> latencyUs;
+	std::atomic<bool> failed{ false };
+
+private:
+	void Read()
+	{
+		std::vector<uint8_t> ready;
+		uint8_t buf[8192];
+		while (!done)
+		{
+			if (reactor.Wait(10, ready) <= 0)
+			{
+				continue;
+			}
+			for (size_t i = 0; i < ready.size(); i++)
+			{
+				int count;
+				while (ready[i] && (count = clients[i]->Read(buf, sizeof(buf))) > 0)
+				{
+					Parse(i, buf, count);
+				}
+			}
+		}
+	}
+
+	void Parse(size_t client, const uint8_t* data, int count)
+	{
+		uint64_t nowUs = current_timeUs();
+		std::vector<uint8_t>& frame = pending[client];
+		frame.insert(frame.end(), data, data + count);
+		size_t pos = 0;
+		for (; frame.size() - pos >= TEST_CASTER_FRAME_SIZE; pos += TEST_CASTER_FRAME_SIZE)
+		{
+			caster_frame_hdr_t hdr;
+			memcpy(&hdr, &frame[pos], sizeof(hdr));
+			if (hdr.seq != nextSeq[client]++)
+			{
+				failed = true;
+			}
+			latencyUs.push_back((uint32_t)(nowUs - hdr.timeUs));
+			received++;
+		}
+		frame.erase(frame.begin(), frame.begin() + pos);
+	}
+
+	cISReactor reactor;
+	std::vector<int> fds;
+	std::vector<std::vector<uint8_t>> pending;
+	std::vector<uint32_t> nextSeq;
+	std::thread reader;
+	std::atomic<bool> done{ false };
+	std::atomic<uint64_t> received{ 0 };
+};
+
+static uint32_t percentile(const std::vector<uint32_t>& sorted, double p)
+{
+	return sorted.empty() ? 0 : sorted[_MIN((size_t)(p * sorted.size()), sorted.size() - 1)];
+}
+
+#if PLATFORM_IS_LINUX
+
+TEST(ISTcpServer, CasterLoadTest)
+{
+	cISTcpServer server;
+	ASSERT_TRUE(server.SetCasterMode(true));
+	ASSERT_EQ(server.Open("127.0.0.1", 0), 0);
+
+	cCasterLoadTest test;
+	ASSERT_TRUE(test.Connect(server.Port(), TEST_CASTER_CLIENTS));
+	uint64_t start = current_timeMs();
+	while (server.Clients().size() < TEST_CASTER_CLIENTS && current_timeMs() - start < 5000)
+	{
+		server.Update();
+	}
+	ASSERT_EQ(server.Clients().size(), (size_t)TEST_CASTER_CLIENTS);
+
+	// An idle update only costs one epoll_wait() no matter how many clients are connected
+	uint64_t startUs = current_timeUs();
+	for (int i = 0; i < 100; i++)
+	{
+		server.Update();
+	}
+	double updateUs = (current_timeUs() - startUs) * 0.01;
+
+	// Fan out frames at 1 kHz, each frame is copied once for all clients
+	test.Start();
+	uint8_t frame[TEST_CASTER_FRAME_SIZE] = {};
+	uint64_t writeUs = 0;
+	for (uint32_t n = 0; n < TEST_CASTER_FRAMES; n++)
+	{
+		caster_frame_hdr_t hdr = { n, current_timeUs() };
+		memcpy(frame, &hdr, sizeof(hdr));
+		ASSERT_EQ(server.Write(frame, sizeof(frame)), (int)sizeof(frame));
+		server.Update();
+		writeUs += current_timeUs() - hdr.timeUs;
+		SLEEP_MS(1);
+	}
+	uint64_t total = (uint64_t)TEST_CASTER_CLIENTS * TEST_CASTER_FRAMES;
+	start = current_timeMs();
+	while (test.FramesReceived() < total && current_timeMs() - start < 10000)
+	{
+		server.Update();
+		SLEEP_MS(1);
+	}
+	test.Stop();
+
+	EXPECT_FALSE(test.failed);
+	EXPECT_EQ(test.FramesReceived(), total);
+	EXPECT_EQ(server.Clients().size(), (size_t)TEST_CASTER_CLIENTS);
+	for (const tcp_server_client_stats_t& stats : server.ClientStats())
+	{
+		EXPECT_EQ(stats.bytesDropped, 0u);
+	}
+
+	std::sort(test.latencyUs.begin(), test.latencyUs.end());
+	printf("Caster %d clients, %d frames of %d bytes: idle update %.1f us, write+update %.1f us per frame\n",
+		TEST_CASTER_CLIENTS, TEST_CASTER_FRAMES, TEST_CASTER_FRAME_SIZE, updateUs, (double)writeUs / TEST_CASTER_FRAMES);
+	printf("  fan-out latency us: p50 %u  p90 %u  p99 %u  p99.9 %u  max %u\n",
+		percentile(test.latencyUs, 0.5), percentile(test.latencyUs, 0.9), percentile(test.latencyUs, 0.99),
+		percentile(test.latencyUs, 0.999), test.latencyUs.empty() ? 0 : test.latencyUs.back());
+
+	// Clients that disconnect are removed and the rest keep receiving
+	for (int i = 0; i < TEST_CASTER_CLIENTS; i += 2)
+	{
+		test.clients[i]->Close();
+	}
+	start = current_timeMs();
+	while (server.Clients().size() > TEST_CASTER_CLIENTS / 2 && current_timeMs() - start < 5000)
+	{
+		server.Update();
+	}
+	EXPECT_EQ(server.Clients().size(), (size_t)TEST_CASTER_CLIENTS / 2);
+	cISTcpClient late;
+	ASSERT_EQ(late.Open("127.0.0.1", server.Port()), 0);
+	start = current_timeMs();
+	while (server.Clients().size() < TEST_CASTER_CLIENTS / 2 + 1 && current_timeMs() - start < 5000)
+	{
+		server.Update();
+	}
+	EXPECT_EQ(server.Clients().size(), (size_t)TEST_CASTER_CLIENTS / 2 + 1);
+}
+
+static bool eventFdReady(cISTcpServer& server, int timeoutMs)
+{
+	pollfd pfd = { server.EventFd(), POLLIN, 0 };
+	return poll(&pfd, 1, timeoutMs) > 0;
+}
+
+// EventFd() wakes a waiting caller when a slow client can take more of its queue, not only on the next Update()
+TEST(ISTcpServer, CasterWakesForQueuedData)
+{
+	cISTcpServer server;
+	ASSERT_TRUE(server.SetCasterMode(true));
+	ASSERT_EQ(server.Open("127.0.0.1", 0), 0);
+	cISTcpClient client;
+	ASSERT_EQ(client.Open("127.0.0.1", server.Port()), 0);
+	client.SetBlocking(false);
+	acceptClients(server, 1);
+	server.Update();
+	EXPECT_FALSE(eventFdReady(server, 0));
+
+	// Fill the socket buffers so data stays queued after Write()
+	uint8_t frame[TEST_FRAME_SIZE];
+	for (uint32_t n = 0; !server.ClientHasQueuedData(0) && n < TEST_FRAME_COUNT; n++)
+	{
+		makeFrame(n, frame);
+		ASSERT_EQ(server.Write(frame, TEST_FRAME_SIZE), TEST_FRAME_SIZE);
+	}
+	ASSERT_TRUE(server.ClientHasQueuedData(0));
+
+	// Once the client reads, the server socket is writable and EventFd() is ready without calling Update()
+	uint8_t buf[8192];
+	uint64_t received = 0;
+	uint64_t start = current_timeMs();
+	bool woke = false;
+	while (!woke && current_timeMs() - start < 2000)
+	{
+		int count = client.Read(buf, sizeof(buf));
+		received += (count > 0 ? count : 0);
+		woke = eventFdReady(server, 1);
+	}
+	EXPECT_TRUE(woke);
+	EXPECT_GT(received, 0u);
+
+	// Once the queue is sent, EventFd() is idle again
+	start = current_timeMs();
+	while ((server.ClientHasQueuedData(0) || eventFdReady(server, 0)) && current_timeMs() - start < 2000)
+	{
+		client.Read(buf, sizeof(buf));
+		server.Update();
+	}
+	EXPECT_FALSE(server.ClientHasQueuedData(0));
+	EXPECT_FALSE(eventFdReady(server, 10));
+}
+
+#endif
+
+// Reads until the expected number of bytes arrive or the client is disconnected
+static std::string readString(cISTcpServer& server, cISTcpClient& client, size_t size)
+{
+	std::string str;
+	char buf[1024];
+	uint64_t start = current_timeMs();
+	while (str.size() < size && current_timeMs() - start < 2000)
+	{
+		server.Update();
+		int count = client.Read(buf, sizeof(buf));
+		if (count < 0)
+		{
+			break;
+		}
+		str.append(buf, count);
+	}
+	return str;
+}
+
+TEST(ISTcpServer, NtripMountpoints)
+{
+	cISTcpServer server;
+	server.SetCasterMode(true);
+	ASSERT_EQ(server.Open("127.0.0.1", 0), 0);
+	EXPECT_EQ(server.AddMountpoint("BASE_A"), 0);
+	EXPECT_EQ(server.AddMountpoint("BASE_B"), 1);
+	EXPECT_EQ(server.AddMountpoint("BASE_A"), -1);
+
+	cISTcpClient roverA, roverB, raw, unknown;
+	ASSERT_EQ(roverA.Open("127.0.0.1", server.Port()), 0);
+	ASSERT_EQ(roverB.Open("127.0.0.1", server.Port()), 0);
+	ASSERT_EQ(raw.Open("127.0.0.1", server.Port()), 0);
+	ASSERT_EQ(unknown.Open("127.0.0.1", server.Port()), 0);
+	acceptClients(server, 4);
+	EXPECT_EQ(server.MountpointClients(0), 0u);
+
+	// Clients that send something other than a request receive the first mountpoint
+	raw.Write("$GPGGA,,,,,,0,00,,,M,,M,,*66\r\n", 30);
+
+	// The request may arrive in pieces
+	roverA.HttpGet("BASE_A", "NTRIP Inertial Sense", "user", "pass");
+	std::string request = "GET /BASE_B HTTP/1.1\r\nUser-Agent: NTRIP Inertial Sense\r\n";
+	roverB.Write(request.data(), 10);
+	server.Update();
+	roverB.Write(request.data() + 10, (int)request.size() - 10);
+	roverB.Write("\r\n", 2);
+	unknown.HttpGet("NONE", "NTRIP Inertial Sense", "", "");
+	std::string icy = "ICY 200 OK\r\n\r\n";
+	EXPECT_EQ(readString(server, roverA, icy.size()), icy);
+	EXPECT_EQ(readString(server, roverB, icy.size()), icy);
+
+	// Unknown mountpoints get the source table and are disconnected
+	std::string table = readString(server, unknown, server.SourceTable().size());
+	EXPECT_EQ(table, server.SourceTable());
+	EXPECT_EQ(table.find("SOURCETABLE 200 OK\r\n"), 0u);
+	EXPECT_NE(table.find("STR;BASE_A;"), std::string::npos);
+	EXPECT_NE(table.find("STR;BASE_B;"), std::string::npos);
+	EXPECT_NE(table.find("ENDSOURCETABLE\r\n"), std::string::npos);
+	EXPECT_EQ(server.Clients().size(), 3u);
+	EXPECT_EQ(server.MountpointClients(0), 2u);
+	EXPECT_EQ(server.MountpointClients(1), 1u);
+
+	// Each stream only goes to its subscribers, the raw client is on the first mountpoint
+	EXPECT_EQ(server.Write("aaaa", 4, 0), 4);
+	EXPECT_EQ(server.Write("bbbb", 4, 1), 4);
+	EXPECT_EQ(server.Write("AAAA", 4, 0), 4);
+	EXPECT_EQ(readString(server, roverA, 8), "aaaaAAAA");
+	EXPECT_EQ(readString(server, roverB, 4), "bbbb");
+	EXPECT_EQ(readString(server, raw, 8), "aaaaAAAA");
+
+	std::vector<tcp_server_client_stats_t> stats = server.ClientStats();
+	for (const tcp_server_client_stats_t& s : stats)
+	{
+		EXPECT_EQ(s.bytesQueued, s.bytesSent + s.lagBytes);
+	}
+	printf("%s", server.ClientStatsSummary().c_str());
+
+	// Without subscribers nothing is queued
+	roverB.Close();
+	uint64_t start = current_timeMs();
+	while (server.MountpointClients(1) > 0 && current_timeMs() - start < 2000)
+	{
+		server.Update();
+	}
+	EXPECT_EQ(server.MountpointClients(1), 0u);
+	EXPECT_EQ(server.Write("bbbb", 4, 1), 4);
+	EXPECT_EQ(server.Flush(), 0);
+}
+
+// A rover requesting a mountpoint while data is already flowing receives the response first, then only its mountpoint
+TEST(ISTcpServer, NtripRequestWhileStreaming)
+{
+	cISTcpServer server;
+	server.SetCasterMode(true);
+	ASSERT_EQ(server.Open("127.0.0.1", 0), 0);
+	EXPECT_EQ(server.AddMountpoint("BASE_A"), 0);
+	EXPECT_EQ(server.AddMountpoint("BASE_B"), 1);
+
+	cISTcpClient roverB, idle;
+	ASSERT_EQ(roverB.Open("127.0.0.1", server.Port()), 0);
+	ASSERT_EQ(idle.Open("127.0.0.1", server.Port()), 0);
+	acceptClients(server, 2);
+
+	// Both mountpoints stream before and while the request arrives
+	std::string icy = "ICY 200 OK\r\n\r\n";
+	std::string received;
+	char buf[1024];
+	for (int n = 0; n < 50; n++)
+	{
+		server.Write("aaaa", 4, 0);
+		server.Write("bbbb", 4, 1);
+		server.Update();
+		if (n == 10)
+		{
+			roverB.HttpGet("BASE_B", "NTRIP Inertial Sense", "", "");
+		}
+		int count = roverB.Read(buf, sizeof(buf));
+		received.append(buf, (count > 0 ? count : 0));
+	}
+	if (received.size() < icy.size() + 4)
+	{
+		received += readString(server, roverB, icy.size() + 4 - received.size());
+	}
+	ASSERT_GE(received.size(), icy.size() + 4);
+	EXPECT_EQ(received.substr(0, icy.size()), icy);
+	EXPECT_EQ(received.find('a'), std::string::npos);
+	EXPECT_EQ(received.substr(icy.size(), 4), "bbbb");
+	EXPECT_EQ(server.MountpointClients(1), 1u);
+
+	// A client that never sends a request receives the first mountpoint after the timeout
+	EXPECT_EQ(server.MountpointClients(0), 0u);
+	uint64_t start = current_timeMs();
+	while (server.MountpointClients(0) == 0 && current_timeMs() - start < TCP_SERVER_REQUEST_TIMEOUT_MS + 1000)
+	{
+		server.Update();
+		SLEEP_MS(1);
+	}
+	EXPECT_EQ(server.MountpointClients(0), 1u);
+	server.Write("AAAA", 4, 0);
+	EXPECT_EQ(readString(server, idle, 4), "AAAA");
+}
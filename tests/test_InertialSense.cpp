@@ -2,6 +2,11 @@
 #include <deque>
 #include "InertialSense.h"
 
+#if PLATFORM_IS_LINUX
+#include <pty.h>
+#include <unistd.h>
+#endif
+
 
 TEST(InertialSense, General)
 {
@@ -10,3 +15,60 @@ TEST(InertialSense, General)
 	EXPECT_TRUE(true);
 }
 
+
+#if PLATFORM_IS_LINUX
+
+#define BCAST_CAPACITY_TEST_STREAMS     20
+
+// Number of streams scheduled after requesting BCAST_CAPACITY_TEST_STREAMS, opened on a pseudo terminal
+static int requestBroadcastStreams(uint32_t capacity)
+{
+	int master, slave;
+	char name[64];
+	if (openpty(&master, &slave, name, NULL, NULL) != 0)
+	{
+		return -1;
+	}
+
+	int count = -1;
+	{
+		InertialSense is;
+		is.EnableDeviceValidation(false);
+		is.SetBroadcastCapacity(capacity);
+		if (is.Open(name))
+		{
+			static uint8_t data[BCAST_CAPACITY_TEST_STREAMS][64];
+			com_manager_t* cm = (com_manager_t*)comManagerGetGlobal();
+			EXPECT_EQ(cm->numBroadcastMsgs, (int32_t)is.BroadcastCapacity());
+			for (int i = 0; i < BCAST_CAPACITY_TEST_STREAMS; i++)
+			{
+				comManagerRegisterInstance(cm, (uint16_t)(DID_INS_1 + i), 0, 0, data[i], 0, sizeof(data[i]), 0);
+				p_data_get_t req = {};
+				req.id = DID_INS_1 + i;
+				req.size = sizeof(data[i]);
+				req.period = 100;		// ms
+				EXPECT_EQ(comManagerGetDataRequestInstance(cm, 0, &req), 0);
+			}
+			count = cm->bcastHeapCount;
+			is.Close();
+		}
+	}
+	close(slave);
+	close(master);
+	return count;
+}
+
+TEST(InertialSense, BroadcastCapacity)
+{
+	// The default holds MAX_NUM_BCAST_MSGS streams, later requests replace the last stream
+	EXPECT_EQ(requestBroadcastStreams(0), MAX_NUM_BCAST_MSGS);
+
+	// A larger capacity passed through Open() holds them all
+	EXPECT_EQ(requestBroadcastStreams(2 * BCAST_CAPACITY_TEST_STREAMS), BCAST_CAPACITY_TEST_STREAMS);
+
+	InertialSense is;
+	is.SetBroadcastCapacity(MAX_NUM_BCAST_MSGS_LIMIT + 1);
+	EXPECT_EQ(is.BroadcastCapacity(), (uint32_t)MAX_NUM_BCAST_MSGS_LIMIT);
+}
+
+#endif
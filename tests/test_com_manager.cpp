@@ -1029,3 +1029,139 @@ TEST(ComManager, Evb2DataForwardTest)
 }
 #endif
 
+
+
+#if 1
+#define BCAST_TEST_NUM_PORTS	4
+#define BCAST_TEST_NUM_DIDS		20
+#define BCAST_TEST_NUM_SIZES	3
+#define BCAST_TEST_NUM_STREAMS	(BCAST_TEST_NUM_PORTS * BCAST_TEST_NUM_DIDS * BCAST_TEST_NUM_SIZES)
+
+static is_comm_instance_t	s_bcastComm[BCAST_TEST_NUM_PORTS];
+static uint8_t				s_bcastCommBuf[BCAST_TEST_NUM_PORTS][PKT_BUF_SIZE];
+static uint32_t				s_bcastCount[BCAST_TEST_NUM_PORTS][DID_COUNT];
+
+extern "C" void disableDidBroadcast(com_manager_t* cmInstance, int pHandle, uint16_t did);
+
+// Count the broadcast packets written to each port
+static int bcastPortWrite(unsigned int port, const unsigned char* buf, int len)
+{
+	is_comm_instance_t *comm = &s_bcastComm[port];
+	for (int i = 0; i < len; )
+	{
+		int n = _MIN(is_comm_free(comm), len - i);
+		memcpy(comm->rxBuf.tail, buf + i, n);
+		comm->rxBuf.tail += n;
+		i += n;
+
+		protocol_type_t ptype;
+		while ((ptype = is_comm_parse(comm)) != _PTYPE_NONE)
+		{
+			EXPECT_EQ(ptype, _PTYPE_INERTIAL_SENSE_DATA);
+			s_bcastCount[port][comm->rxPkt.dataHdr.id]++;
+		}
+	}
+	return len;
+}
+
+static int bcastPortRead(unsigned int port, unsigned char* buf, int len)
+{
+	return 0;
+}
+
+// Number of broadcasts, including the immediate send on request, after enabling and stepping steps times
+static uint32_t expectedBroadcasts(int period, int steps)
+{
+	return 1 + (steps - 1) / period;
+}
+
+TEST(ComManager, BroadcastSchedule)
+{
+	static com_manager_t cm;
+	static broadcast_msg_t bcastMsgs[BCAST_TEST_NUM_STREAMS + 8];
+	static com_manager_port_t ports[BCAST_TEST_NUM_PORTS];
+	static uint8_t data[BCAST_TEST_NUM_DIDS][64];
+
+	// More broadcast streams than the default MAX_NUM_BCAST_MSGS
+	com_manager_init_t cmInit = {};
+	cmInit.broadcastMsg = bcastMsgs;
+	cmInit.broadcastMsgSize = sizeof(bcastMsgs);
+	ASSERT_EQ(comManagerInitInstance(&cm, BCAST_TEST_NUM_PORTS, TASK_PERIOD_MS, bcastPortRead, bcastPortWrite, 0, 0, 0, 0, &cmInit, ports, NULL), 0);
+	EXPECT_EQ(cm.numBroadcastMsgs, BCAST_TEST_NUM_STREAMS + 8);
+
+	memset(s_bcastCount, 0, sizeof(s_bcastCount));
+	for (int port = 0; port < BCAST_TEST_NUM_PORTS; port++)
+	{
+		is_comm_init(&s_bcastComm[port], s_bcastCommBuf[port], PKT_BUF_SIZE);
+	}
+
+	// Several size/offset streams per DID and port, each with its own period
+	int period[BCAST_TEST_NUM_PORTS][BCAST_TEST_NUM_DIDS];
+	for (int d = 0; d < BCAST_TEST_NUM_DIDS; d++)
+	{
+		comManagerRegisterInstance(&cm, (uint16_t)(DID_INS_1 + d), 0, 0, data[d], 0, sizeof(data[d]), 0);
+	}
+	for (int port = 0; port < BCAST_TEST_NUM_PORTS; port++)
+	{
+		for (int d = 0; d < BCAST_TEST_NUM_DIDS; d++)
+		{
+			period[port][d] = 1 + (port * 7 + d * 3) % 25;
+			for (int s = 0; s < BCAST_TEST_NUM_SIZES; s++)
+			{
+				p_data_get_t req = {};
+				req.id = DID_INS_1 + d;
+				req.offset = (uint16_t)(s * 8);
+				req.size = (uint16_t)(8 + s * 4);
+				req.period = period[port][d];
+				EXPECT_EQ(comManagerGetDataRequestInstance(&cm, port, &req), 0);
+			}
+		}
+	}
+	EXPECT_EQ(cm.bcastHeapCount, BCAST_TEST_NUM_STREAMS);
+
+	// Repeating a request updates the existing stream instead of adding one
+	p_data_get_t req = {};
+	req.id = DID_INS_1;
+	req.offset = 0;
+	req.size = 8;
+	req.period = period[0][0];
+	EXPECT_EQ(comManagerGetDataRequestInstance(&cm, 0, &req), 0);
+	EXPECT_EQ(cm.bcastHeapCount, BCAST_TEST_NUM_STREAMS);
+	s_bcastCount[0][DID_INS_1]--;
+
+	int steps = 1000;
+	for (int i = 0; i < steps; i++)
+	{
+		comManagerStepTxInstance(&cm);
+	}
+
+	for (int port = 0; port < BCAST_TEST_NUM_PORTS; port++)
+	{
+		for (int d = 0; d < BCAST_TEST_NUM_DIDS; d++)
+		{
+			EXPECT_EQ(s_bcastCount[port][DID_INS_1 + d], BCAST_TEST_NUM_SIZES * expectedBroadcasts(period[port][d], steps)) << "port " << port << " did " << d;
+		}
+	}
+
+	// Stop one DID on one port, then all broadcasts on another port
+	disableDidBroadcast(&cm, 2, DID_INS_1 + 5);
+	comManagerDisableBroadcastsInstance(&cm, 3);
+	EXPECT_EQ(cm.bcastHeapCount, BCAST_TEST_NUM_STREAMS - BCAST_TEST_NUM_SIZES - BCAST_TEST_NUM_DIDS * BCAST_TEST_NUM_SIZES);
+
+	memset(s_bcastCount, 0, sizeof(s_bcastCount));
+	for (int i = 0; i < 100; i++)
+	{
+		comManagerStepTxInstance(&cm);
+	}
+	EXPECT_EQ(s_bcastCount[2][DID_INS_1 + 5], 0u);
+	EXPECT_GT(s_bcastCount[2][DID_INS_1 + 6], 0u);
+	for (int d = 0; d < BCAST_TEST_NUM_DIDS; d++)
+	{
+		EXPECT_EQ(s_bcastCount[3][DID_INS_1 + d], 0u);
+		EXPECT_GT(s_bcastCount[0][DID_INS_1 + d], 0u);
+	}
+
+	comManagerDisableBroadcastsInstance(&cm, -1);
+	EXPECT_EQ(cm.bcastHeapCount, 0);
+}
+#endif
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "ISComm.h"
+#include "message_stats.h"
+
+TEST(MessageStats, Summary)
+{
+	mul_msg_stats_t stats = {};
+	for (int t = 0; t < 10; t++)
+	{
+		messageStatsAppend(stats, _PTYPE_INERTIAL_SENSE_DATA, DID_INS_1, 1000 + t * 10);
+		messageStatsAppend(stats, _PTYPE_RTCM3, 1077, 1000 + t * 200);
+		messageStatsAppend(stats, _PTYPE_RTCM3, 1005, 1000 + t * 1000);
+		messageStatsAppend(stats, _PTYPE_UBLOX, 0x1502, 1000 + t * 100);
+		messageStatsAppend(stats, _PTYPE_NMEA, *(const int*)"PGGA", 1000 + t * 100);
+	}
+	EXPECT_EQ(stats.isb[DID_INS_1].count, 10);
+
+	// RTCM3 1029 text is copied from the packet, not allocated per message
+	uint8_t rtcm1029[32] = { 0xD3, 0x00, 0x0F, 0x40, 0x50 };
+	memcpy(rtcm1029 + 12, "base 1", 6);
+	messageStatsAppend(stats, _PTYPE_RTCM3, 1029, 3000, rtcm1029, 12 + 6);
+
+	std::string summary = messageStatsSummary(stats);
+	EXPECT_NE(summary.find("   4      10    10  DID_INS_1\n"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("PGGA      10   100"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("(0x02 0x15)      10   100  UBX-RXM-RAWX\n"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("1077      10   200  GPS MSM7\n"), std::string::npos) << summary;
+	EXPECT_NE(summary.find("1029       1     0  Text String: base 1\n"), std::string::npos) << summary;
+
+	// Sorted by id
+	EXPECT_LT(summary.find("1005 "), summary.find("1029 "));
+	EXPECT_LT(summary.find("1029 "), summary.find("1077 "));
+}
+
+TEST(MessageStats, TableFull)
+{
+	mul_msg_stats_t stats = {};
+	int ids = MSG_STATS_TABLE_SIZE * 2;
+	for (int id = 0; id < ids; id++)
+	{
+		messageStatsAppend(stats, _PTYPE_RTCM3, 1000 + id, 0);
+		messageStatsAppend(stats, _PTYPE_RTCM3, 1000 + id, 0);
+	}
+
+	// Every message is counted, ids that don't fit are counted together
+	int count = stats.rtcm3.other.count;
+	for (int i = 0; i < MSG_STATS_TABLE_SIZE; i++)
+	{
+		count += stats.rtcm3.entries[i].stats.count;
+	}
+	EXPECT_EQ(count, ids * 2);
+	EXPECT_EQ(stats.rtcm3.size, MSG_STATS_TABLE_SIZE * 3 / 4);
+	EXPECT_EQ(stats.rtcm3.other.count, (ids - stats.rtcm3.size) * 2);
+	EXPECT_NE(messageStatsSummary(stats).find("Other message ids: "), std::string::npos);
+}